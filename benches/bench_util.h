@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include "cppship/util/fs.h"
+#include "cppship/util/io.h"
+#include "cppship/util/repo.h"
+
+namespace cppship::bench {
+
+inline constexpr std::int64_t kFilesPerDir = 100;
+
+// a dir under the temp dir, cleared when created and removed when done
+class ScratchDir {
+public:
+    explicit ScratchDir(std::string_view name)
+        : mPath(fs::temp_directory_path() / fmt::format("cppship-bench-{}", name))
+    {
+        fs::remove_all(mPath);
+        fs::create_directories(mPath);
+    }
+
+    ~ScratchDir()
+    {
+        std::error_code ec;
+        fs::remove_all(mPath, ec);
+    }
+
+    ScratchDir(const ScratchDir&) = delete;
+    ScratchDir(ScratchDir&&) = delete;
+
+    ScratchDir& operator=(const ScratchDir&) = delete;
+    ScratchDir& operator=(ScratchDir&&) = delete;
+
+    const fs::path& path() const { return mPath; }
+
+private:
+    fs::path mPath;
+};
+
+// benchmark runs a bench several times per argument to settle iterations, so projects are generated once per
+// size. only the latest size of a kind is kept to bound the disk usage
+template <class Generate> const fs::path& cached_project(std::string_view kind, std::int64_t size, Generate&& generate)
+{
+    static std::map<std::string, std::pair<std::int64_t, std::unique_ptr<ScratchDir>>, std::less<>> S_PROJECTS;
+
+    auto& [cached_size, dir] = S_PROJECTS[std::string { kind }];
+    if (dir == nullptr || cached_size != size) {
+        dir.reset();
+        dir = std::make_unique<ScratchDir>(kind);
+        cached_size = size;
+        std::forward<Generate>(generate)(dir->path());
+    }
+
+    return dir->path();
+}
+
+inline std::string package_manifest(std::string_view name, std::string_view dependencies = "")
+{
+    return fmt::format(R"([package]
+name = "{}"
+version = "0.1.0"
+std = 20
+
+[dependencies]
+fmt = "10.0.0"
+boost = {{ version = "1.81.0", components = ["headers"], options = {{ header_only = true }} }}
+{}
+[profile]
+cxxflags = ["-Wall"]
+
+[target.'cfg(not(compiler = "msvc"))'.profile]
+cxxflags = ["-Wextra"]
+
+[profile.release]
+definitions = ["NDEBUG"]
+)",
+        name,
+        dependencies);
+}
+
+// a package with a header, a binary, a test and lib sources spread over dirs of kFilesPerDir files
+inline void write_package(const fs::path& dir, std::string_view name, std::int64_t sources)
+{
+    fs::create_directories(dir / kIncludePath / name);
+    fs::create_directories(dir / kSrcPath);
+    fs::create_directories(dir / kTestsPath);
+    fs::create_directories(dir / kLibPath);
+
+    write(dir / kRepoConfigFile, package_manifest(name));
+    write(dir / kIncludePath / name / "api.h", "#pragma once\n");
+    write(dir / kSrcPath / "main.cpp", "int main() {}\n");
+    write(dir / kTestsPath / "api_test.cpp", "");
+
+    for (std::int64_t i = 0; i < sources; ++i) {
+        const auto sub_dir = dir / kLibPath / fmt::format("m{}", i / kFilesPerDir);
+        if (i % kFilesPerDir == 0) {
+            create_if_not_exist(sub_dir);
+        }
+
+        write(sub_dir / fmt::format("f{}.cpp", i), "");
+    }
+}
+
+inline std::string member_name(std::int64_t index) { return fmt::format("p{}", index); }
+
+// a workspace of members with some lib sources each
+inline void write_workspace(const fs::path& dir, std::int64_t packages, std::int64_t sources_per_package)
+{
+    std::string members;
+    for (std::int64_t i = 0; i < packages; ++i) {
+        const auto name = member_name(i);
+        write_package(dir / name, name, sources_per_package);
+        members += fmt::format("{}\"{}\"", i == 0 ? "" : ", ", name);
+    }
+
+    write(dir / kRepoConfigFile, fmt::format("[workspace]\nmembers = [{}]\n", members));
+}
+
+// run benches with status logs silenced
+inline int run(int argc, char** argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
+
+}
@@ -0,0 +1,47 @@
+#include "cppship/core/cfg.h"
+
+#include <array>
+
+#include "bench_util.h"
+
+using namespace cppship;
+using namespace cppship::bench;
+
+namespace {
+
+// cfg(any(...)) of n options of all kinds
+std::string any_cfg(std::int64_t options)
+{
+    constexpr std::array kOptions = {
+        R"(os = "linux")",
+        R"(not(compiler = "msvc"))",
+        R"(all(target_arch = "x86_64", target_feature = "avx2"))",
+        R"(any(compiler = "clang", compiler = "apple_clang"))",
+    };
+
+    std::string cfg = "cfg(any(";
+    for (std::int64_t i = 0; i < options; ++i) {
+        cfg += i == 0 ? "" : ", ";
+        cfg += kOptions[static_cast<std::size_t>(i) % kOptions.size()];
+    }
+
+    return cfg + "))";
+}
+
+void parse_cfg(benchmark::State& state)
+{
+    const auto cfg = any_cfg(state.range(0));
+
+    for (auto _ : state) {
+        auto predicate = core::parse_cfg(cfg);
+        benchmark::DoNotOptimize(predicate);
+    }
+
+    state.SetComplexityN(state.range(0));
+}
+
+}
+
+BENCHMARK(parse_cfg)->RangeMultiplier(10)->Range(1, 10'000)->Complexity();
+
+int main(int argc, char** argv) { return run(argc, argv); }
@@ -0,0 +1,58 @@
+#include "cppship/core/dependency.h"
+
+#include "bench_util.h"
+
+using namespace cppship;
+using namespace cppship::bench;
+
+namespace {
+
+// files of a package generated by conan CMakeDeps, only the target file is parsed
+void write_conan_package(const fs::path& dir, std::string_view package)
+{
+    write(dir / fmt::format("{}-Target-release.cmake", package),
+        fmt::format(R"(# Avoid multiple calls to find_package to append duplicated properties to the targets
+include_guard()
+
+########## AGGREGATED GLOBAL TARGET WITH THE COMPONENTS #####################
+set_property(TARGET {0}::{0} APPEND PROPERTY INTERFACE_LINK_LIBRARIES {0}::core)
+set_property(TARGET {0}::{0} APPEND PROPERTY INTERFACE_LINK_LIBRARIES {0}::extra)
+
+########## For the modules (FindXXX)
+set({0}_LIBRARIES_RELEASE {0}::{0})
+)",
+            package));
+    write(dir / fmt::format("{}-release-x86_64-data.cmake", package),
+        fmt::format(R"(set({0}_PACKAGE_FOLDER_RELEASE "/conan/p/{0}/p")
+set({0}_INCLUDE_DIRS_RELEASE "${{{0}_PACKAGE_FOLDER_RELEASE}}/include")
+)",
+            package));
+    write(dir / fmt::format("{}-config.cmake", package), "");
+}
+
+void collect_conan_dependencies(benchmark::State& state)
+{
+    const auto packages = state.range(0);
+    const auto& dir = cached_project("conan-deps", packages, [&](const fs::path& conan_dir) {
+        for (std::int64_t i = 0; i < packages; ++i) {
+            write_conan_package(conan_dir, fmt::format("c{}", i));
+        }
+    });
+
+    for (auto _ : state) {
+        auto deps = collect_conan_deps(dir, "Release");
+        benchmark::DoNotOptimize(deps);
+    }
+
+    state.SetComplexityN(packages);
+}
+
+}
+
+BENCHMARK(collect_conan_dependencies)
+    ->RangeMultiplier(10)
+    ->Range(10, 10'000)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) { return run(argc, argv); }
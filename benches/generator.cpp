@@ -0,0 +1,76 @@
+#include "cppship/cmake/generator.h"
+
+#include "cppship/core/workspace.h"
+
+#include "bench_util.h"
+
+using namespace cppship;
+using namespace cppship::bench;
+
+namespace {
+
+// conan deps of synthetic packages
+const ResolvedDependencies& resolved_dependencies()
+{
+    static const ResolvedDependencies S_DEPS {
+        Dependency { .package = "fmt", .cmake_package = "fmt", .cmake_target = "fmt::fmt", .components = {} },
+        Dependency { .package = "boost", .cmake_package = "Boost", .cmake_target = "boost::boost", .components = {} },
+    };
+
+    return S_DEPS;
+}
+
+void generate_package_cmake(benchmark::State& state)
+{
+    const auto files = state.range(0);
+    const auto& root
+        = cached_project("package-cmake", files, [&](const fs::path& dir) { write_package(dir, "abc", files); });
+    const Manifest manifest { root / kRepoConfigFile };
+    const Layout layout(root, "abc");
+
+    for (auto _ : state) {
+        auto content = CmakeGenerator(&layout, manifest.get_if_package()).build();
+        benchmark::DoNotOptimize(content);
+    }
+
+    state.SetComplexityN(files);
+}
+
+void generate_workspace_cmake(benchmark::State& state)
+{
+    const auto packages = state.range(0);
+    const auto& root = cached_project(
+        "workspace-cmake", packages, [&](const fs::path& dir) { write_workspace(dir, packages, kFilesPerDir); });
+    const Manifest manifest { root / kRepoConfigFile };
+    const Workspace workspace { root, manifest };
+
+    for (auto _ : state) {
+        // one graph per invocation
+        DependencyGraph graph(root / kBuildPath / kBuildDepsPath);
+        WorkspaceGenerator gen(
+            &graph, [](std::string_view package, std::string_view) { return fmt::format("{}.cmake", package); });
+        for (const auto& [path, layout] : workspace) {
+            gen.add(layout, *manifest.get_by_path(path), resolved_dependencies());
+        }
+
+        auto content = std::move(gen).build();
+        benchmark::DoNotOptimize(content);
+    }
+
+    state.SetComplexityN(packages);
+}
+
+}
+
+BENCHMARK(generate_package_cmake)
+    ->RangeMultiplier(10)
+    ->Range(100, 1'000'000)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(generate_workspace_cmake)
+    ->RangeMultiplier(10)
+    ->Range(10, 10'000)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) { return run(argc, argv); }
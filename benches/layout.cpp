@@ -0,0 +1,57 @@
+#include "cppship/core/layout.h"
+
+#include <range/v3/iterator/operations.hpp>
+
+#include "cppship/core/manifest.h"
+#include "cppship/core/workspace.h"
+
+#include "bench_util.h"
+
+using namespace cppship;
+using namespace cppship::bench;
+
+namespace {
+
+void construct_layout(benchmark::State& state)
+{
+    const auto files = state.range(0);
+    const auto& root = cached_project("layout", files, [&](const fs::path& dir) { write_package(dir, "abc", files); });
+
+    for (auto _ : state) {
+        Layout layout(root, "abc");
+        benchmark::DoNotOptimize(layout);
+    }
+
+    state.SetComplexityN(files);
+}
+
+void list_workspace_files(benchmark::State& state)
+{
+    const auto packages = state.range(0);
+    const auto& root = cached_project(
+        "workspace-files", packages, [&](const fs::path& dir) { write_workspace(dir, packages, kFilesPerDir); });
+    const Manifest manifest { root / kRepoConfigFile };
+    const Workspace workspace { root, manifest };
+
+    for (auto _ : state) {
+        auto files = ranges::distance(workspace.list_files());
+        benchmark::DoNotOptimize(files);
+    }
+
+    state.SetComplexityN(packages);
+}
+
+}
+
+BENCHMARK(construct_layout)
+    ->RangeMultiplier(10)
+    ->Range(100, 1'000'000)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(list_workspace_files)
+    ->RangeMultiplier(10)
+    ->Range(10, 10'000)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) { return run(argc, argv); }
@@ -0,0 +1,69 @@
+#include "cppship/core/manifest.h"
+
+#include "cppship/util/toml.h"
+
+#include "bench_util.h"
+
+using namespace cppship;
+using namespace cppship::bench;
+
+namespace {
+
+void parse_workspace_manifest(benchmark::State& state)
+{
+    const auto packages = state.range(0);
+    const auto& root = cached_project(
+        "workspace-manifest", packages, [&](const fs::path& dir) { write_workspace(dir, packages, 0); });
+
+    // parsed values are cached per process, drop them so each iteration parses
+    for (auto _ : state) {
+        clear_toml_cache();
+        Manifest manifest { root / kRepoConfigFile };
+        benchmark::DoNotOptimize(manifest);
+    }
+
+    state.SetComplexityN(packages);
+}
+
+// manifests loaded again in the same process, eg. by repo root detection and the resolver
+void load_cached_workspace_manifest(benchmark::State& state)
+{
+    const auto packages = state.range(0);
+    const auto& root = cached_project(
+        "workspace-manifest", packages, [&](const fs::path& dir) { write_workspace(dir, packages, 0); });
+
+    for (auto _ : state) {
+        Manifest manifest { root / kRepoConfigFile };
+        benchmark::DoNotOptimize(manifest);
+    }
+
+    state.SetComplexityN(packages);
+}
+
+void parse_package_manifest(benchmark::State& state)
+{
+    ScratchDir dir("package-manifest");
+    write(dir.path() / kRepoConfigFile, package_manifest("abc"));
+
+    for (auto _ : state) {
+        clear_toml_cache();
+        Manifest manifest { dir.path() / kRepoConfigFile };
+        benchmark::DoNotOptimize(manifest);
+    }
+}
+
+}
+
+BENCHMARK(parse_workspace_manifest)
+    ->RangeMultiplier(10)
+    ->Range(10, 10'000)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(load_cached_workspace_manifest)
+    ->RangeMultiplier(10)
+    ->Range(10, 10'000)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(parse_package_manifest);
+
+int main(int argc, char** argv) { return run(argc, argv); }
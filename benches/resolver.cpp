@@ -0,0 +1,61 @@
+#include "cppship/core/resolver.h"
+
+#include "bench_util.h"
+
+using namespace cppship;
+using namespace cppship::bench;
+
+namespace {
+
+std::string git_dependency(std::int64_t index)
+{
+    return fmt::format("d{0} = {{ git = \"https://example.com/d{0}.git\", commit = \"c{0}\" }}\n", index);
+}
+
+// git deps form a binary tree rooted at d0, all of them fetched already
+void write_dependency_tree(const fs::path& dir, std::int64_t packages)
+{
+    write(dir / kRepoConfigFile, package_manifest("root", git_dependency(0)));
+
+    const auto deps_dir = dir / kBuildPath / kBuildDepsPath;
+    for (std::int64_t i = 0; i < packages; ++i) {
+        std::string deps;
+        for (const auto child : { 2 * i + 1, 2 * i + 2 }) {
+            if (child < packages) {
+                deps += git_dependency(child);
+            }
+        }
+
+        const auto package_dir = deps_dir / fmt::format("d{}", i);
+        fs::create_directories(package_dir / kIncludePath);
+        write(package_dir / kRepoConfigFile, package_manifest(fmt::format("d{}", i), deps));
+        touch(package_dir / fmt::format("cppship.c{}", i));
+    }
+}
+
+void resolve_git_dependencies(benchmark::State& state)
+{
+    const auto packages = state.range(0);
+    const auto& root
+        = cached_project("resolver", packages, [&](const fs::path& dir) { write_dependency_tree(dir, packages); });
+    const Manifest manifest { root / kRepoConfigFile };
+    const auto deps_dir = root / kBuildPath / kBuildDepsPath;
+
+    for (auto _ : state) {
+        // deps are fetched already, the fetcher is never called
+        auto result = Resolver(deps_dir, manifest, nullptr).resolve();
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetComplexityN(packages);
+}
+
+}
+
+BENCHMARK(resolve_git_dependencies)
+    ->RangeMultiplier(10)
+    ->Range(10, 10'000)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) { return run(argc, argv); }
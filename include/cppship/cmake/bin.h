@@ -2,16 +2,16 @@
 
 #include <optional>
 #include <ostream>
-#include <set>
 
 #include "cppship/cmake/dep.h"
+#include "cppship/core/path_table.h"
 
 namespace cppship::cmake {
 
 struct BinDesc {
     std::string name;
     std::optional<std::string> name_alias;
-    std::set<fs::path> sources;
+    PathSet sources;
     std::optional<std::string> include_dir;
     std::optional<std::string> lib;
     std::vector<Dep> deps;
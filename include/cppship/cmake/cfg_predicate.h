@@ -1,11 +1,17 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 #include "cppship/core/cfg.h"
 
 namespace cppship::cmake {
 
+inline constexpr std::string_view kTargetFeaturesVar = "CPPSHIP_TARGET_FEATURES";
+
 std::string generate_predicate(const core::CfgPredicate& cfg);
 
+// sets kTargetFeaturesVar, required by predicates using target features
+std::string generate_feature_detection();
+
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+#include "cppship/core/cfg.h"
+#include "cppship/core/manifest.h"
+#include "cppship/core/profile.h"
+#include "cppship/core/workspace.h"
+#include "cppship/util/fs.h"
+
+namespace cppship::cmake {
+
+struct CompileDbOptions {
+    std::string compiler;
+    Profile profile = Profile::debug;
+    // conditional profile configs are evaluated against it instead of by cmake
+    core::cfg::Platform platform;
+    // working dir of compile commands
+    fs::path build_dir;
+    // include dirs of dependencies, system includes like those of imported cmake targets
+    std::set<fs::path> dependency_includes;
+};
+
+// compile_commands.json of all sources in the workspace, with the flags the generated cmake files give them.
+// flags of the compiler toolchain itself and usage requirements of dependencies other than includes are left out
+std::string generate_compile_db(const Workspace& workspace, const Manifest& manifest, const CompileDbOptions& options);
+
+}
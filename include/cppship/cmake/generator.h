@@ -4,17 +4,26 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 #include <gsl/pointers>
 
 #include "cppship/cmake/dep.h"
 #include "cppship/cmake/dependency_injector.h"
 #include "cppship/core/dependency.h"
+#include "cppship/core/dependency_graph.h"
 #include "cppship/core/layout.h"
 #include "cppship/core/manifest.h"
 
 namespace cppship {
 
+namespace cmake {
+
+    // the profile being built, set when configuring cmake
+    inline constexpr std::string_view kCppshipProfileVar = "CPPSHIP_PROFILE";
+
+}
+
 struct GeneratorOptions {
     std::vector<cmake::Dep> deps;
     std::vector<cmake::Dep> dev_deps;
@@ -49,9 +58,12 @@ private:
 
     void emit_footer_();
 
+    // targets of the package link the profile target privately besides deps
+    std::vector<cmake::Dep> with_profile_(std::vector<cmake::Dep> deps) const;
+
 private:
     void fill_default_profile_();
-    void fill_profile_(Profile profile);
+    void fill_profile_(const Profile& profile);
 
 private:
     std::ostringstream mOut;
@@ -94,15 +106,16 @@ private:
 
 class WorkspaceGenerator {
 public:
-    WorkspaceGenerator(
-        const fs::path& deps_dir, std::function<std::string(std::string_view, std::string_view)> package_handler);
+    // packages are resolved through the graph, which may be shared with other consumers
+    WorkspaceGenerator(gsl::not_null<DependencyGraph*> graph,
+        std::function<std::string(std::string_view, std::string_view)> package_handler);
 
     void add(const Layout& layout, const PackageManifest& manifest, const ResolvedDependencies& resolved_deps);
 
     std::string build() &&;
 
 private:
-    fs::path mDepsDir;
+    gsl::not_null<DependencyGraph*> mGraph;
     std::function<std::string(std::string_view, std::string)> mPackageHandler;
 
     std::ostringstream mOut;
@@ -1,34 +1,66 @@
 #pragma once
 
+#include <array>
 #include <optional>
 #include <ostream>
 #include <set>
+#include <string>
+#include <string_view>
 
 #include <fmt/core.h>
 
 #include "cppship/cmake/dep.h"
+#include "cppship/core/path_table.h"
 
 namespace cppship::cmake {
 
 struct LibDesc {
     std::string name;
     std::optional<std::string> name_alias;
-    std::set<fs::path> include_dirs;
-    std::set<fs::path> sources;
+    PathSet include_dirs;
+    PathSet sources;
     std::vector<Dep> deps;
     std::vector<std::string> definitions;
+    // interface target of profile flags, linked privately so that they do not leak into dependents
+    std::optional<std::string> profile_target;
+    // import a prebuilt static lib instead of compiling sources
+    std::optional<fs::path> imported_archive;
+    // compiled once per x86-64 level into namespace CPPSHIP_ISA_NS, a generated <name>_isa.h dispatches among them
+    PathSet multiversion_sources;
 };
 
+// x86-64 micro-architecture levels of multiversion sources, from the baseline up
+struct IsaLevel {
+    std::string_view suffix;
+    std::string_view march;
+    std::string_view msvc_arch;
+};
+
+inline constexpr std::array<IsaLevel, 4> kIsaLevels { {
+    { "x86_64", "x86-64", "" },
+    { "x86_64_v2", "x86-64-v2", "" },
+    { "x86_64_v3", "x86-64-v3", "/arch:AVX2" },
+    { "x86_64_v4", "x86-64-v4", "/arch:AVX512" },
+} };
+
+// the c identifier of a lib, prefix of generated isa namespaces and macros
+std::string isa_prefix(std::string_view lib_name);
+
 class CmakeLib {
 public:
     explicit CmakeLib(LibDesc desc);
 
-    bool is_interface() const { return mSources.empty(); }
+    bool is_interface() const { return mSources.empty() && !is_imported(); }
+
+    bool is_imported() const { return mImportedArchive.has_value(); }
 
     void build(std::ostream& out) const;
 
     std::string target() const { return fmt::format("{}_lib", mName); }
 
+private:
+    void build_isa_variants_(std::ostream& out) const;
+
 private:
     std::string mName;
     std::optional<std::string> mNameAlias;
@@ -36,6 +68,9 @@ private:
     std::set<std::string> mSources;
     std::vector<Dep> mDeps;
     std::vector<std::string> mDefinitions;
+    std::optional<std::string> mProfileTarget;
+    std::optional<std::string> mImportedArchive;
+    std::set<std::string> mMultiversionSources;
 };
 
 }
\ No newline at end of file
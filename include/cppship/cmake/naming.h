@@ -5,6 +5,9 @@
 
 namespace cppship::cmake {
 
+// interface target of profile definitions and sanitizers of all packages, linked by git deps built from source
+inline constexpr std::string_view kCppshipDepsProfile = "cppship_deps_profile";
+
 class NameTargetMapper {
 public:
     explicit NameTargetMapper(std::string_view package)
@@ -16,6 +19,8 @@ public:
     std::string test(std::string_view name);
     std::string example(std::string_view name);
     std::string bench(std::string_view name);
+    // interface target carrying profile flags of the package
+    std::string profile();
 
 private:
     std::string mPackage;
@@ -1,20 +1,51 @@
 #pragma once
 
 #include "cppship/core/dependency.h"
+#include "cppship/core/remote_cache.h"
 
+#include <cstddef>
 #include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace cppship::cmake {
 
+// static libs of cppship deps are shared across projects, keyed by the dep, its deps and the toolchain
+struct PrebuiltOptions {
+    fs::path cache_dir;
+    // fingerprint of compiler and profile flags of the consuming build
+    std::string toolchain;
+    // package to its locked commit or conan version
+    std::map<std::string, std::string, std::less<>> locked;
+    // consulted on local misses
+    RemoteCache* remote = nullptr;
+};
+
 struct ConfigOptions {
     fs::path deps_dir;
     fs::path out_dir = deps_dir;
     std::string cmake_deps_dir = "${CMAKE_SOURCE_DIR}/deps";
     std::function<void(std::string&)> post_process;
+    std::optional<PrebuiltOptions> prebuilt;
+};
+
+struct ConfigResult {
+    // prebuilt archives missed in cache, they are exported to the local cache by the build
+    std::vector<fs::path> missed_archives;
+    std::size_t prebuilt_hits = 0;
 };
 
-// for cppship deps, generate cmake packages for them
-void config_packages(
+// for cppship deps, generate cmake packages for them.
+ConfigResult config_packages(
     const ResolvedDependencies& cppship_deps, const ResolvedDependencies& all_deps, const ConfigOptions& options);
 
+namespace package_internals {
+
+    // file name of the prebuilt static lib in cache
+    std::string prebuilt_archive_name(std::string_view lib_target);
+
+}
+
 }
\ No newline at end of file
@@ -8,7 +8,7 @@
 namespace cppship::cmd {
 
 struct BenchOptions {
-    Profile profile = Profile::release;
+    Profile profile { kProfileBench };
     std::optional<std::string> name;
     std::optional<std::string> package;
 };
@@ -2,16 +2,26 @@
 
 #include <cstdint>
 #include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <boost/algorithm/string/case_conv.hpp>
 #include <gsl/narrow>
 
+#include "cppship/core/build_history.h"
 #include "cppship/core/dependency.h"
+#include "cppship/core/dependency_graph.h"
+#include "cppship/core/lockfile.h"
 #include "cppship/core/manifest.h"
 #include "cppship/core/profile.h"
+#include "cppship/core/resolver.h"
+#include "cppship/core/source_index.h"
 #include "cppship/core/workspace.h"
 #include "cppship/util/cmd_runner.h"
 #include "cppship/util/fs.h"
@@ -28,6 +38,20 @@ struct BuildOptions {
     std::optional<std::string> package;
     std::optional<std::string> cmake_target;
     std::set<BuildGroup> groups;
+    // build several profiles together sharing dependency resolution, overrides profile
+    std::vector<Profile> profiles;
+    // only build packages affected by changes since the git revision
+    std::optional<std::string> changed_since;
+};
+
+// state of the project rather than of a profile, shared by the contexts of all profiles built in one invocation.
+// profiles are set up concurrently, so it is guarded, recursively since resolving asks for the graph
+struct BuildSession {
+    std::recursive_mutex mutex;
+    std::optional<ResolveResult> resolved;
+    std::unique_ptr<DependencyGraph> dependency_graph;
+    std::optional<ResolvedDependencies> git_dependencies;
+    std::map<std::string, std::set<std::string>, std::less<>> affected_packages;
 };
 
 struct BuildContext {
@@ -41,17 +65,32 @@ struct BuildContext {
     fs::path deps_dir = build_dir / kBuildDepsPath;
     fs::path profile_dir = build_dir / boost::to_lower_copy(profile);
     fs::path metafile = root / "cppship.toml";
+    fs::path lock_file = root / kLockFile;
+    fs::path conan_lock_file = root / kConanLockFile;
 
     fs::path conan_file = build_dir / "conanfile.txt";
     fs::path git_dep_file = build_dir / "git_dep.toml";
     fs::path conan_profile_path = profile_dir / "conan_profile";
     fs::path inventory_file = profile_dir / "inventory.toml";
+    fs::path source_index_file = profile_dir / "source.index";
+    // target lists of the workspace, valid as long as the source index lists the same files
+    fs::path workspace_snapshot_file = profile_dir / "workspace.snapshot";
     fs::path dependency_file = profile_dir / "dependency.toml";
+    // cmake configs of cppship deps, they import profile specific prebuilt libs
+    fs::path deps_config_dir = profile_dir / kBuildDepsPath;
+    // prebuilt archives to upload to the remote cache once built
+    fs::path prebuilt_upload_file = profile_dir / "prebuilt_uploads.toml";
+    // telemetry of builds of all profiles
+    fs::path history_file = build_dir / kBuildHistoryFile;
 
     Manifest manifest { metafile };
-    Workspace workspace { root, manifest };
+    SourceIndex source_index { source_index_file };
+    Workspace workspace { root, manifest, source_index, workspace_snapshot_file };
+
+    // cmake and conan build type, Debug or Release, which the profile inherits
+    std::string build_type { to_string(manifest.build_type(parse_profile(profile))) };
 
-    explicit BuildContext(Profile profile_)
+    explicit BuildContext(const Profile& profile_)
         : profile(to_string(profile_))
     {
         if (!fs::exists(build_dir)) {
@@ -59,13 +98,56 @@ struct BuildContext {
         }
     }
 
+    // another profile of the same project, reuse the loaded manifest and share resolution with base
+    BuildContext(const Profile& profile_, const BuildContext& base)
+        : profile(to_string(profile_))
+        , manifest(base.manifest)
+        , mSession(base.mSession)
+    {
+    }
+
     [[nodiscard]] bool is_expired(const fs::path& path) const;
 
     [[nodiscard]] std::optional<std::string> get_active_package() const;
+
+    // results below are computed on first use and kept for the whole invocation, subcommands share one context
+    // instead of loading the manifest and scanning the workspace again. resolution, the graph, git deps and affected
+    // packages are of the session, computed once for all profiles
+
+    // resolved from manifests or loaded from the lockfile
+    [[nodiscard]] const ResolveResult& resolved() const;
+
+    // deps of each package, resolved once whoever asks
+    [[nodiscard]] DependencyGraph& dependency_graph() const;
+
+    // cppship deps, the content of git_dep_file
+    [[nodiscard]] const ResolvedDependencies& git_dependencies() const;
+
+    // conan and cppship deps, the content of dependency_file
+    [[nodiscard]] const ResolvedDependencies& dependencies() const;
+    void save_dependencies(ResolvedDependencies deps) const;
+
+    // the content of inventory_file, an empty table if absent
+    [[nodiscard]] const toml::value& inventory() const;
+    void save_inventory(toml::value inventory) const;
+
+    [[nodiscard]] const std::set<std::string>& affected_packages(std::string_view rev) const;
+
+    // telemetry of the build run with this context, stages fill it as they go
+    [[nodiscard]] BuildRecord& build_record() const { return mBuildRecord; }
+
+private:
+    std::shared_ptr<BuildSession> mSession = std::make_shared<BuildSession>();
+    mutable std::optional<ResolvedDependencies> mDependencies;
+    mutable std::optional<toml::value> mInventory;
+    mutable BuildRecord mBuildRecord;
 };
 
 int run_build(const BuildOptions& options);
 
+// build with a context loaded by the caller, profiles of options are ignored in favor of the one of ctx
+int run_build(const BuildContext& ctx, const BuildOptions& options);
+
 void conan_detect_profile(const BuildContext& ctx);
 
 void conan_setup(const BuildContext& ctx);
@@ -79,10 +161,20 @@ namespace cmd_internals {
 
 std::string cmake_gen_config(const BuildContext& ctx, bool for_standalone_cmake = false);
 
+// cmake setup and build of profiles concurrently, sharing the job budget. results are in the order of contexts
+std::vector<int> build_profiles(const std::vector<std::unique_ptr<BuildContext>>& contexts,
+    const BuildOptions& options, const util::CmdRunner& runner = {});
+
 }
 
-void cmake_setup(const BuildContext& ctx);
+void cmake_setup(const BuildContext& ctx, const util::CmdRunner& runner = {});
+
+// write compile_commands.json from the layout without configuring cmake, deps are installed for their include dirs
+void compile_db_setup(const BuildContext& ctx);
 
 int cmake_build(const BuildContext& ctx, const BuildOptions& options, const util::CmdRunner& runner = {});
 
+// packages affected by changes between the git revision and the work tree
+std::set<std::string> list_affected_packages(const BuildContext& ctx, std::string_view rev);
+
 }
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "cppship/core/remote_cache.h"
+#include "cppship/util/fs.h"
+
+namespace cppship::cmd {
+
+struct CacheServerOptions {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 8080;
+    // default to server/ under the user cache dir
+    std::optional<fs::path> root;
+    // limit of blobs in MiB
+    std::uint64_t max_size = kRemoteCacheMaxBlobSize >> 20;
+};
+
+int run_cache_server(const CacheServerOptions& options);
+
+}
@@ -8,6 +8,8 @@ struct FmtOptions {
     bool all = false;
     bool cached_only = false;
     bool fix = false;
+    // only format changed lines rather than whole files
+    bool changed_lines = false;
     std::string commit;
 };
 
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace cppship::cmd {
+
+struct StatsOptions {
+    // YYYY-MM-DD or a git revision, regressions are reported against builds before it
+    std::optional<std::string> since;
+    // all profiles if not specified
+    std::optional<std::string> profile;
+    std::size_t top = 10;
+};
+
+int run_stats(const StatsOptions& options);
+
+}
@@ -13,6 +13,8 @@ struct TestOptions {
     std::optional<std::string> package;
     std::optional<std::string> name_regex;
     bool rerun_failed = false;
+    // only test packages affected by changes since the git revision
+    std::optional<std::string> changed_since;
 };
 
 int run_test(const TestOptions& options);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include "cppship/core/profile.h"
+#include "cppship/util/fs.h"
+
+namespace cppship::cmd {
+
+struct VendorOptions {
+    Profile profile = Profile::debug;
+    // directory to put the archive, default to build/
+    std::optional<fs::path> output_dir;
+    // archive to restore, export if not specified
+    std::optional<fs::path> restore;
+};
+
+int run_vendor(const VendorOptions& options);
+
+namespace vendor_internals {
+
+    // copy a git checkout without .git, which may borrow objects from a local mirror
+    void copy_tree(const fs::path& from, const fs::path& to);
+
+    // named by the dependency fingerprint, the same deps always give the same name
+    fs::path archive_path(const fs::path& output_dir, std::string_view fingerprint);
+
+    // write vendor.toml into staging and archive it
+    void pack(const fs::path& staging, std::string_view fingerprint, const fs::path& archive);
+
+    // extract into a fresh staging, throw if the archive is not created from deps of the fingerprint
+    void unpack(const fs::path& archive, std::string_view fingerprint, const fs::path& staging);
+
+}
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cppship::cmd {
+
+struct WorkerOptions {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 3633;
+    // default to the number of cores
+    std::optional<unsigned> slots;
+    // default to the detected c++ compiler
+    std::optional<std::string> compiler;
+    // default to dist::get_token()
+    std::optional<std::string> token;
+};
+
+int run_worker(const WorkerOptions& options);
+
+// entry of the compiler launcher, cmd is the compiler and its args
+int run_dist_compile(const std::vector<std::string>& cmd);
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cppship/util/fs.h"
+
+namespace cppship {
+
+inline constexpr std::string_view kBuildHistoryFile = "history.toml";
+inline constexpr std::string_view kNinjaLogFile = ".ninja_log";
+
+struct StageTime {
+    std::string name;
+    std::int64_t ms = 0;
+};
+
+// a translation unit compiled by the build
+struct UnitTime {
+    std::string target;
+    std::string source;
+    std::int64_t ms = 0;
+};
+
+// any other output of the build, mostly libs and executables linked
+struct LinkTime {
+    std::string output;
+    std::int64_t ms = 0;
+};
+
+// telemetry of one build
+struct BuildRecord {
+    // unix seconds when the build started
+    std::int64_t time = 0;
+    // HEAD of the project, empty if not in a git repo
+    std::string commit;
+    std::string profile;
+    int result = 0;
+    std::vector<StageTime> stages;
+    std::size_t prebuilt_hits = 0;
+    std::size_t prebuilt_misses = 0;
+    // empty unless cmake generates ninja files
+    std::vector<UnitTime> units;
+    std::vector<LinkTime> links;
+
+    std::int64_t total_ms() const;
+};
+
+struct Regression {
+    std::string name;
+    double before_ms = 0;
+    double after_ms = 0;
+};
+
+struct Regressions {
+    std::vector<Regression> units;
+    // the sum of units of the target, compared over units measured on both sides only
+    std::vector<Regression> targets;
+};
+
+// compare the mean compile time of each unit before and since, the worst regressions first
+Regressions find_regressions(
+    const std::vector<BuildRecord>& history, const std::function<bool(const BuildRecord&)>& is_since);
+
+// builds started at or after the cutoff are since it
+Regressions find_regressions(const std::vector<BuildRecord>& history, std::int64_t cutoff);
+
+// each build appends a [[builds]] table, records already written are never touched
+void append_build_record(const fs::path& file, const BuildRecord& record);
+
+// in the order of builds, empty if the file is absent
+std::vector<BuildRecord> load_build_history(const fs::path& file);
+
+namespace history_internals {
+
+    // fill units and links from lines of a ninja log, objects under CMakeFiles/<target>.dir are compiled units
+    void parse_ninja_log(std::string_view log, BuildRecord& record);
+
+}
+
+}
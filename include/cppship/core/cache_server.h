@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "cppship/core/remote_cache.h"
+#include "cppship/util/fs.h"
+#include "cppship/util/http.h"
+
+namespace cppship {
+
+// reference server of the remote cache protocol, blobs are stored as files under root and streamed from and to them
+class CacheServer {
+public:
+    // port 0 picks a free port, larger blobs are rejected
+    CacheServer(fs::path root, std::string_view host, std::uint16_t port,
+        std::uint64_t max_blob_size = kRemoteCacheMaxBlobSize);
+
+    std::uint16_t port() const { return mServer.port(); }
+
+    // serve until stop is called
+    void run() { mServer.run(); }
+
+    // thread safe
+    void stop() { mServer.stop(); }
+
+private:
+    util::HttpResponse handle_(const util::HttpRequest& req) const;
+
+private:
+    fs::path mRoot;
+    util::HttpServer mServer;
+};
+
+}
@@ -2,6 +2,8 @@
 
 #include "cppship/exception.h"
 
+#include <optional>
+#include <set>
 #include <string_view>
 #include <variant>
 #include <vector>
@@ -42,13 +44,48 @@ namespace cfg {
         clang,
         apple_clang,
     };
+
+    enum class Arch {
+        x86_64,
+        aarch64,
+    };
+
+    enum class Feature {
+        sse4_2,
+        avx2,
+        avx512f,
+        neon,
+    };
+
+    // the name used in cfg, eg. sse4.2
+    std::string_view to_string(Arch arch);
+    std::string_view to_string(Feature feature);
+
+    std::optional<Feature> parse_feature(std::string_view feature);
+
+    // where cfg predicates are evaluated without cmake, an unknown compiler matches no compiler option
+    struct Platform {
+        Os os;
+        std::optional<Compiler> compiler;
+        std::optional<Arch> arch;
+        std::set<Feature> features;
+    };
+
+    Os current_os();
+
+    std::optional<Arch> current_arch();
+
+    // features of the target cpu, from $CPPSHIP_TARGET_FEATURES if set, otherwise detected on the host
+    std::set<Feature> target_features();
+
+    inline constexpr std::string_view kTargetFeaturesEnv = "CPPSHIP_TARGET_FEATURES";
 }
 
 struct CfgNot;
 struct CfgAll;
 struct CfgAny;
 
-using CfgOption = std::variant<cfg::Os, cfg::Compiler>;
+using CfgOption = std::variant<cfg::Os, cfg::Compiler, cfg::Arch, cfg::Feature>;
 
 using CfgPredicate = std::variant<CfgOption, boost::recursive_wrapper<CfgAll>, boost::recursive_wrapper<CfgAny>,
     boost::recursive_wrapper<CfgNot>>;
@@ -69,4 +106,9 @@ bool operator==(const CfgPredicate& a, const CfgPredicate& b);
 
 CfgPredicate parse_cfg(std::string_view cfg);
 
+bool eval_cfg(const CfgPredicate& cfg, const cfg::Platform& platform);
+
+// whether the predicate tests target features, which need detection before evaluation
+bool uses_target_features(const CfgPredicate& cfg);
+
 }
\ No newline at end of file
@@ -10,8 +10,11 @@ std::string_view to_string(CompilerId compiler_id);
 
 class CompilerInfo {
 public:
+    // detect from $CXX, or g++/clang++ in PATH
     CompilerInfo();
 
+    explicit CompilerInfo(std::string command);
+
     CompilerId id() const { return mId; }
 
     std::string_view command() const { return mCommand; }
@@ -20,8 +23,13 @@ public:
 
     int version() const { return mVersion; }
 
+    // identifies the exact toolchain: full version and target. compilers with the same fingerprint produce the same
+    // object files from the same preprocessed sources
+    std::string fingerprint() const;
+
 private:
     std::string mCommand;
+    std::string mVersionLine;
     CompilerId mId = CompilerId::unknown;
     int mVersion = 0;
     std::string mLibCxx;
@@ -2,6 +2,7 @@
 
 #include <initializer_list>
 #include <map>
+#include <set>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -24,6 +25,8 @@ struct ConanDep {
 struct GitDep {
     std::string git;
     std::string commit;
+    // only checkout include/, lib/ and top level files
+    bool sparse = false;
 };
 
 using DependencyDesc = std::variant<ConanDep, GitDep>;
@@ -89,10 +92,16 @@ namespace dep_internals {
 
     Dependency parse_conan_cmake_target_file(std::string_view cmake_package, const fs::path& target_file);
 
+    // include dirs set in a data file generated by conan CMakeDeps, package folders are expanded
+    std::vector<fs::path> parse_conan_data_file(const fs::path& data_file, std::string_view profile);
+
 }
 
 ResolvedDependencies collect_conan_deps(const fs::path& conan_dep_dir, std::string_view profile);
 
+// include dirs of all conan packages installed in the dir, empty if conan install is not run yet
+std::set<fs::path> collect_conan_include_dirs(const fs::path& conan_dep_dir, std::string_view profile);
+
 }
 
 TOML11_DEFINE_CONVERSION_NON_INTRUSIVE(cppship::Dependency, package, cmake_package, cmake_target, components);
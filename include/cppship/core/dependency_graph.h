@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "cppship/core/dependency.h"
+#include "cppship/core/manifest.h"
+#include "cppship/core/resolver.h"
+#include "cppship/util/fs.h"
+
+namespace cppship {
+
+// git deps of all packages of an invocation as one graph, a node per package@commit with edges to the deps its
+// manifest declares. nodes are loaded once, when the resolver or a query first reaches them, and each package is
+// resolved by a walk over the edges instead of reading manifests again.
+// closures are not memoized per node: a package reached by several paths resolves to the first one in bfs order from
+// the member, so what a node brings in depends on the member.
+// deps are expected to be fetched already. thread safe, profiles of an invocation are set up concurrently
+class DependencyGraph {
+public:
+    explicit DependencyGraph(const fs::path& deps_dir)
+        : mDepsDir(deps_dir)
+    {
+    }
+
+    const fs::path& deps_dir() const { return mDepsDir; }
+
+    // manifest of a cppship git dep, nullptr for header only ones
+    const Manifest* manifest(const DeclaredDependency& dep);
+
+    // the same as Resolver without fetching, memoized by package
+    const ResolveResult& resolve(const PackageManifest& manifest);
+
+private:
+    using NodeId = std::size_t;
+
+    // a dep declared by the manifest of a node, git deps point to their node
+    struct Edge {
+        const DeclaredDependency* dep = nullptr;
+        std::optional<NodeId> node;
+    };
+
+    struct Node {
+        std::unique_ptr<const Manifest> manifest;
+        // in the order of the manifest, built on the first walk through the node
+        std::optional<std::vector<Edge>> edges;
+    };
+
+    NodeId node_(const DeclaredDependency& dep);
+
+    const std::vector<Edge>& edges_(NodeId id);
+
+private:
+    fs::path mDepsDir;
+    // recursive, resolving loads manifests
+    std::recursive_mutex mMutex;
+    // stable, nodes are referenced while others are added
+    std::deque<Node> mNodes;
+    // keyed by package@commit
+    std::map<std::string, NodeId, std::less<>> mNodeIds;
+    std::map<std::string, ResolveResult, std::less<>> mResults;
+};
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cppship/util/fs.h"
+#include "cppship/util/http.h"
+
+// distributed compilation: sources are preprocessed locally and compiled by workers, like distcc
+namespace cppship::dist {
+
+// hidden subcommand used as CMAKE_CXX_COMPILER_LAUNCHER
+inline constexpr std::string_view kLauncherCommand = "dist-compile";
+
+struct Worker {
+    std::string host;
+    std::string port;
+};
+
+// parse workers in form of host:port[,host:port...]
+std::vector<Worker> parse_workers(std::string_view spec);
+
+// workers of $CPPSHIP_DIST_WORKERS, or dist.workers of the user config
+std::vector<Worker> get_workers();
+
+// token shared by workers and their clients, $CPPSHIP_DIST_TOKEN or dist.token of the user config. empty if not set
+std::string get_token();
+
+// a compile command split into local preprocessing and remote compilation
+struct CompileJob {
+    fs::path source;
+    fs::path output;
+    // preprocessor flags and flags for both, -E and output are left to the launcher
+    std::vector<std::string> preprocess_args;
+    // flags not about preprocessing, input and output are left to the worker
+    std::vector<std::string> compile_args;
+};
+
+namespace dist_internals {
+
+    // nullopt if the command cannot be distributed, eg. linking, multiple sources or response files
+    std::optional<CompileJob> parse_compile_args(const std::vector<std::string>& args);
+
+    // whether a worker can run compile args from others, only optimization, debug info, language, warning and machine
+    // flags are allowed, flags loading code or writing files are rejected
+    bool is_safe_compile_args(const std::vector<std::string>& args);
+
+    // length prefixed parts, the wire format of compile requests and responses
+    std::string pack(const std::vector<std::string>& parts);
+
+    std::vector<std::string> unpack(std::string_view data);
+
+}
+
+// compiler launcher, cmd is the compiler and its args. fall back to local compilation if no worker is usable
+int compile(const std::vector<std::string>& cmd);
+
+// compile daemon serving GET /status and POST /compile to clients of the same token
+class WorkerServer {
+public:
+    // port 0 picks a free port. token may be empty only on a loopback address, a worker compiles whatever it is sent
+    WorkerServer(std::string compiler, std::string_view host, std::uint16_t port, unsigned slots, std::string token);
+
+    std::uint16_t port() const { return mServer.port(); }
+
+    const std::string& fingerprint() const { return mFingerprint; }
+
+    // serve until stop is called
+    void run() { mServer.run(); }
+
+    // thread safe
+    void stop() { mServer.stop(); }
+
+private:
+    util::HttpResponse handle_(const util::HttpRequest& req);
+
+    util::HttpResponse compile_(std::string_view body);
+
+private:
+    std::string mCompiler;
+    std::string mFingerprint;
+    unsigned mSlots;
+    std::string mToken;
+    std::atomic<unsigned> mRunning = 0;
+    std::atomic<std::uint64_t> mJobId = 0;
+
+    // declared last, requests may be in flight until it is destroyed
+    util::HttpServer mServer;
+};
+
+}
@@ -1,56 +1,83 @@
 #pragma once
 
+#include <istream>
 #include <map>
+#include <memory>
 #include <optional>
-#include <set>
+#include <ostream>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include <range/v3/view/map.hpp>
+
+#include "cppship/core/path_table.h"
+#include "cppship/core/source_index.h"
 #include "cppship/util/fs.h"
 
 namespace cppship {
 
+// paths of a target are interned into the table of its layout
 struct Target {
     std::string name;
-    std::set<fs::path> includes;
-    std::set<fs::path> sources;
+    PathSet includes;
+    PathSet sources;
 };
 
 class Layout {
 public:
-    Layout(const fs::path& root, std::string_view name);
+    // list directories from index if given, the index must be refreshed beforehand
+    Layout(const fs::path& root, std::string_view name, const SourceIndex* index = nullptr);
+
+    // target lists in binary, valid as long as the listed directories stay the same
+    void save(std::ostream& os) const;
+
+    // nullopt if the data is corrupted or the include dir appears or disappears since saved
+    static std::optional<Layout> load(std::istream& is);
 
     std::string_view package() const { return mName; }
 
-    std::set<fs::path> all_files() const;
+    const fs::path& root() const { return mRoot; }
 
-    std::optional<Target> lib() const;
+    // sources of all targets
+    const PathSet& all_files() const { return mSources; }
 
-    std::optional<Target> binary(std::string_view name) const;
-    std::optional<Target> example(std::string_view name) const;
-    std::optional<Target> bench(std::string_view name) const;
-    std::optional<Target> test(std::string_view name) const;
+    const std::optional<Target>& lib() const { return mLib; }
 
-    std::vector<Target> binaries() const;
-    std::vector<Target> examples() const;
-    std::vector<Target> benches() const;
-    std::vector<Target> tests() const;
+    // nullptr if absent
+    const Target* binary(std::string_view name) const;
+    const Target* example(std::string_view name) const;
+    const Target* bench(std::string_view name) const;
+    const Target* test(std::string_view name) const;
+
+    // views ordered by name, valid as long as the layout
+    auto binaries() const { return ranges::views::values(mBinaries); }
+    auto examples() const { return ranges::views::values(mExamples); }
+    auto benches() const { return ranges::views::values(mBenches); }
+    auto tests() const { return ranges::views::values(mTests); }
 
 private:
-    void scan_binaries_();
+    Layout() = default;
+
+    void scan_binaries_(const SourceIndex* index, std::vector<PathId>& sources);
+
+    void scan_benches_(const SourceIndex* index, std::vector<PathId>& sources);
 
-    void scan_benches_();
+    void scan_tests_(const SourceIndex* index, std::vector<PathId>& sources);
 
-    void scan_tests_();
+    void scan_examples_(const SourceIndex* index, std::vector<PathId>& sources);
 
-    void scan_examples_();
+    void scan_lib_(const SourceIndex* index, std::vector<PathId>& sources);
 
-    void scan_lib_();
+    PathSet make_set_(std::vector<PathId> ids) const { return { mPaths, std::move(ids) }; }
 
 private:
     fs::path mRoot;
     std::string mName;
 
-    std::set<fs::path> mSources;
+    // shared by copies of the layout and its targets, interned only while scanning
+    std::shared_ptr<PathTable> mPaths = std::make_shared<PathTable>();
+    PathSet mSources;
 
     std::optional<Target> mLib;
     std::map<std::string, Target, std::less<>> mBinaries;
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "cppship/core/manifest.h"
+#include "cppship/core/resolver.h"
+#include "cppship/util/fs.h"
+
+namespace cppship {
+
+inline constexpr std::string_view kLockFile = "cppship.lock";
+inline constexpr std::string_view kConanLockFile = "conan.lock";
+
+// hash of the dependency tables of all manifests. git deps are pinned by commit,
+// so the resolved graph only changes if this changes
+std::string dependency_fingerprint(const Manifest& manifest);
+
+// the lockfile records the full resolved graph, it is meant to be checked in
+void save_lockfile(const fs::path& file, std::string_view fingerprint, const ResolveResult& result);
+
+// nullopt if the lockfile is missing, of another version or locks other dependencies
+std::optional<ResolveResult> load_lockfile(const fs::path& file, std::string_view fingerprint);
+
+// conan packages declared differently by result than by the lockfile whatever its fingerprint: added, removed or with
+// other versions, options or components. nullopt if there is no valid lockfile to compare with
+std::optional<std::set<std::string>> changed_conan_packages(const fs::path& file, const ResolveResult& result);
+
+}
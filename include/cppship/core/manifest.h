@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -44,7 +45,21 @@ public:
     const std::vector<DeclaredDependency>& dev_dependencies() const { return mDevDependencies; }
 
     const ProfileOptions& default_profile() const { return mProfileDefault; }
-    const ProfileOptions& profile(Profile prof) const;
+    // options declared by the profile itself, empty for profiles unknown to the package
+    const ProfileOptions& profile(const Profile& prof) const;
+
+    bool has_profile(const Profile& prof) const { return mProfiles.contains(prof); }
+
+    // debug, release and profiles declared by [profile.<name>]
+    std::vector<Profile> list_profiles() const;
+
+    // the profile and those it inherits, from its build type down to itself
+    std::vector<Profile> profile_chain(const Profile& prof) const;
+
+    // lib sources built once per x86-64 level, files or dirs relative to the package root
+    const std::vector<fs::path>& multiversion_sources() const { return mMultiversionSources; }
+
+    bool is_multiversion_source(const fs::path& package_root, const fs::path& source) const;
 
 private:
     std::string mName;
@@ -55,8 +70,11 @@ private:
     std::vector<DeclaredDependency> mDevDependencies;
 
     ProfileOptions mProfileDefault;
-    ProfileOptions mProfileDebug;
-    ProfileOptions mProfileRelease;
+    std::map<Profile, ProfileOptions> mProfiles;
+    // profiles other than debug and release, to the profile they inherit
+    std::map<Profile, Profile> mInherits;
+
+    std::vector<fs::path> mMultiversionSources;
 };
 
 class Manifest {
@@ -86,6 +104,12 @@ public:
 
     const std::vector<DeclaredDependency>& dev_dependencies() const { return mDevDependencies; }
 
+    // chains of profiles are the same in all member packages declaring them
+    std::vector<Profile> profile_chain(const Profile& prof) const;
+
+    // the cmake and conan build type of the profile, debug or release
+    Profile build_type(const Profile& prof) const { return profile_chain(prof).front(); }
+
 private:
     std::variant<std::monostate, std::map<fs::path, PackageManifest>, PackageManifest> packages_;
 
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cppship/util/fs.h"
+
+namespace cppship {
+
+using PathId = std::uint32_t;
+
+// interned paths, each stored once and addressed by an id that stays valid as the table grows
+class PathTable {
+public:
+    using string_view_type = std::basic_string_view<fs::path::value_type>;
+
+    PathId intern(const fs::path& path);
+
+    // nullopt if the path is never interned
+    std::optional<PathId> find(const fs::path& path) const;
+
+    // materialized from the buffer, use view to compare without allocating
+    fs::path operator[](PathId id) const { return fs::path { view(id) }; }
+
+    // native string of the path, invalidated by the next intern
+    string_view_type view(PathId id) const
+    {
+        return { mBuffer.data() + mOffsets[id], mOffsets[id + 1] - mOffsets[id] };
+    }
+
+    std::size_t size() const { return mOffsets.size() - 1; }
+
+private:
+    // slot of the path, or the free slot to put it
+    std::size_t probe_(string_view_type path) const;
+
+    void rehash_();
+
+private:
+    // native strings of all paths back to back, path i spans [mOffsets[i], mOffsets[i + 1])
+    fs::path::string_type mBuffer;
+    std::vector<std::size_t> mOffsets { 0 };
+    // open addressing over ids, sized a power of two and at most half full
+    std::vector<PathId> mSlots;
+};
+
+// a flat vector of ids sorted by native string, iterated as paths of the table
+class PathSet {
+public:
+    class Iterator {
+    public:
+        // paths are materialized on dereference
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = fs::path;
+        using difference_type = std::ptrdiff_t;
+        using reference = fs::path;
+
+        Iterator() = default;
+
+        Iterator(const PathTable* table, std::vector<PathId>::const_iterator it)
+            : mTable(table)
+            , mIt(it)
+        {
+        }
+
+        reference operator*() const { return (*mTable)[*mIt]; }
+
+        Iterator& operator++()
+        {
+            ++mIt;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto old = *this;
+            ++mIt;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const { return mIt == other.mIt; }
+
+    private:
+        const PathTable* mTable = nullptr;
+        std::vector<PathId>::const_iterator mIt;
+    };
+
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+    using value_type = fs::path;
+
+    PathSet() = default;
+
+    // ids are sorted and deduplicated, the set keeps the table alive
+    PathSet(std::shared_ptr<const PathTable> table, std::vector<PathId> ids);
+
+    // paths interned into a table of its own
+    PathSet(std::initializer_list<fs::path> paths);
+
+    Iterator begin() const { return { mTable.get(), mIds.begin() }; }
+    Iterator end() const { return { mTable.get(), mIds.end() }; }
+
+    std::size_t size() const { return mIds.size(); }
+    bool empty() const { return mIds.empty(); }
+
+    bool contains(const fs::path& path) const;
+
+    std::span<const PathId> ids() const { return mIds; }
+
+    // paths satisfying pred, sharing the table
+    template <class Pred> PathSet filter(Pred pred) const
+    {
+        std::vector<PathId> ids;
+        for (const auto id : mIds) {
+            if (pred((*mTable)[id])) {
+                ids.push_back(id);
+            }
+        }
+
+        return { mTable, std::move(ids) };
+    }
+
+    // by paths, sets of different tables may be equal
+    bool operator==(const PathSet& other) const;
+
+private:
+    std::shared_ptr<const PathTable> mTable;
+    std::vector<PathId> mIds;
+};
+
+}
@@ -1,12 +1,15 @@
 #pragma once
 
-#include <cstdint>
+#include <algorithm>
+#include <cctype>
+#include <compare>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <fmt/core.h>
 
 #include "cppship/core/cfg.h"
 #include "cppship/exception.h"
@@ -14,8 +17,8 @@
 namespace cppship {
 
 struct InvalidProfile : public Error {
-    InvalidProfile()
-        : Error("invalid profile, only Debug/Release is supported")
+    explicit InvalidProfile(std::string_view profile)
+        : Error(fmt::format("invalid profile {}", profile))
     {
     }
 };
@@ -23,34 +26,57 @@ struct InvalidProfile : public Error {
 inline constexpr std::string_view kProfileDebug = "Debug";
 inline constexpr std::string_view kProfileRelease = "Release";
 
-enum class Profile : std::uint8_t { debug, release };
+// predefined profiles on top of debug and release, see PackageManifest
+inline constexpr std::string_view kProfileBench = "bench";
+inline constexpr std::string_view kProfileProfiling = "profiling";
+inline constexpr std::string_view kProfileInstrumented = "instrumented";
 
-inline std::string_view to_string(Profile profile)
+// debug and release are cmake build types, other profiles are declared in manifests and inherit one of them
+class Profile {
+public:
+    static const Profile debug;
+    static const Profile release;
+
+    // names are case insensitive
+    explicit Profile(std::string_view name)
+        : mName(boost::to_lower_copy(std::string { name }))
+    {
+    }
+
+    const std::string& name() const { return mName; }
+
+    bool is_build_type() const { return mName == "debug" || mName == "release"; }
+
+    auto operator<=>(const Profile&) const = default;
+
+private:
+    std::string mName;
+};
+
+inline const Profile Profile::debug { kProfileDebug };
+inline const Profile Profile::release { kProfileRelease };
+
+inline std::string_view to_string(const Profile& profile)
 {
-    switch (profile) {
-    case Profile::debug:
+    if (profile == Profile::debug) {
         return kProfileDebug;
+    }
 
-    case Profile::release:
+    if (profile == Profile::release) {
         return kProfileRelease;
     }
 
-    std::abort();
+    return profile.name();
 }
 
-inline Profile parse_profile(std::string profile)
+inline Profile parse_profile(std::string_view profile)
 {
-    boost::to_lower(profile);
-
-    if (profile == "debug") {
-        return Profile::debug;
-    }
-
-    if (profile == "release") {
-        return Profile::release;
+    const auto valid = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-'; };
+    if (profile.empty() || !std::all_of(profile.begin(), profile.end(), valid)) {
+        throw InvalidProfile { profile };
     }
 
-    throw InvalidProfile {};
+    return Profile { profile };
 }
 
 struct ProfileConfig {
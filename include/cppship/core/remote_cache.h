@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <BS_thread_pool_light.hpp>
+
+#include "cppship/util/fs.h"
+
+namespace cppship {
+
+// kinds of blobs in remote cache
+inline constexpr std::string_view kRemotePrebuilt = "prebuilt";
+
+// blobs are streamed through files, so the limit is about disk rather than memory
+inline constexpr std::uint64_t kRemoteCacheMaxBlobSize = 4ULL << 30;
+
+// client of a content addressed http cache, the same layout as bazel http remote cache: GET/PUT <url>/<kind>/<key>.
+// cache errors never fail a build, they are reported as misses
+class RemoteCache {
+public:
+    // url in form of http://host[:port][/prefix], larger blobs are treated as misses
+    explicit RemoteCache(std::string_view url, std::uint64_t max_blob_size = kRemoteCacheMaxBlobSize);
+
+    // pending uploads are waited
+    ~RemoteCache();
+
+    RemoteCache(const RemoteCache&) = delete;
+    RemoteCache(RemoteCache&&) = delete;
+    RemoteCache& operator=(const RemoteCache&) = delete;
+    RemoteCache& operator=(RemoteCache&&) = delete;
+
+    // small blobs held in memory, larger ones than kHttpMaxMemoryBody are misses
+    std::optional<std::string> get(std::string_view kind, std::string_view key) const;
+
+    // stream the blob into file atomically, return false on miss
+    bool get_file(std::string_view kind, std::string_view key, const fs::path& file) const;
+
+    bool put(std::string_view kind, std::string_view key, std::string body) const;
+
+    // stream the file as the blob
+    bool put_file(std::string_view kind, std::string_view key, const fs::path& file) const;
+
+    // upload in background, so builds and tests are not blocked by the network
+    void put_file_async(std::string kind, std::string key, fs::path file);
+
+    void wait();
+
+private:
+    std::string target_(std::string_view kind, std::string_view key) const;
+
+private:
+    std::string mHost;
+    std::string mPort;
+    std::string mPrefix;
+    std::uint64_t mMaxBlobSize;
+
+    BS::thread_pool_light mUploader { 2 };
+};
+
+// the remote cache configured by $CPPSHIP_REMOTE_CACHE and $CPPSHIP_REMOTE_CACHE_MAX_SIZE in MiB, nullptr if not
+// configured
+RemoteCache* get_remote_cache();
+
+}
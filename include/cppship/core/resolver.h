@@ -1,7 +1,6 @@
 #pragma once
 
 #include <functional>
-#include <queue>
 #include <set>
 #include <vector>
 
@@ -12,6 +11,8 @@
 
 namespace cppship {
 
+class DependencyGraph;
+
 struct ResolveResult {
     std::vector<DeclaredDependency> conan_dependencies;
     std::vector<DeclaredDependency> conan_dev_dependencies;
@@ -22,19 +23,31 @@ struct ResolveResult {
     std::vector<DeclaredDependency> dev_dependencies;
 };
 
-// void(std::string_view package, const fs::path& dep_dir, std::string_view git, std::string_view commit)
-using GitFetcher = std::function<void(std::string_view, const fs::path&, std::string_view, std::string_view)>;
+// void(std::string_view package, const fs::path& deps_dir, const GitDep& dep), may be called concurrently
+using GitFetcher = std::function<void(std::string_view, const fs::path&, const GitDep&)>;
+
+// fetch git deps which are not in deps dir yet concurrently, other deps are ignored.
+// footprints are left to the caller since the fetched deps are not resolved yet.
+void fetch_git_dependencies(
+    const fs::path& deps_dir, const std::vector<DeclaredDependency>& deps, const GitFetcher& fetcher);
+
+// the file marks a fetched and resolved git dep
+fs::path git_dependency_footprint(const fs::path& deps_dir, const DeclaredDependency& dep);
 
-// resolve git deps and git-clone it to cmake deps dir
+// resolve git deps and git-clone it to cmake deps dir.
+// deps are resolved level by level, and all deps in one level are fetched concurrently.
+// manifests of deps are read through the graph if given, so that they are loaded once per invocation
 class Resolver {
 public:
-    Resolver(const fs::path& deps_dir, const Manifest& manifest, GitFetcher fetcher)
-        : Resolver(deps_dir, manifest.dependencies(), manifest.dev_dependencies(), std::move(fetcher))
+    Resolver(
+        const fs::path& deps_dir, const Manifest& manifest, GitFetcher fetcher, DependencyGraph* graph = nullptr)
+        : Resolver(deps_dir, manifest.dependencies(), manifest.dev_dependencies(), std::move(fetcher), graph)
     {
     }
 
-    Resolver(const fs::path& deps_dir, const PackageManifest& manifest, GitFetcher fetcher)
-        : Resolver(deps_dir, manifest.dependencies(), manifest.dev_dependencies(), std::move(fetcher))
+    Resolver(const fs::path& deps_dir, const PackageManifest& manifest, GitFetcher fetcher,
+        DependencyGraph* graph = nullptr)
+        : Resolver(deps_dir, manifest.dependencies(), manifest.dev_dependencies(), std::move(fetcher), graph)
     {
     }
 
@@ -42,17 +55,18 @@ public:
 
 private:
     Resolver(const fs::path& deps_dir, const std::vector<DeclaredDependency>& deps,
-        const std::vector<DeclaredDependency>& dev_deps, GitFetcher fetcher);
+        const std::vector<DeclaredDependency>& dev_deps, GitFetcher fetcher, DependencyGraph* graph);
 
     void do_resolve_(const DeclaredDependency& dep);
 
-    void resolve_package_(std::string_view package, const fs::path& package_dir);
+    void resolve_package_(const DeclaredDependency& dep);
 
 private:
     fs::path mDepsDir;
     GitFetcher mFetcher;
+    DependencyGraph* mGraph;
     ResolveResult mResult;
-    std::queue<DeclaredDependency> mUnresolved;
+    std::vector<DeclaredDependency> mUnresolved;
     std::set<std::string> mPackageSeen;
 };
 
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "cppship/util/fs.h"
+
+namespace cppship {
+
+// persistent listing of source directories, similar to git's index.
+// a directory is listed again only if its mtime or inode changes, so an unchanged tree costs one stat per directory.
+class SourceIndex {
+public:
+    SourceIndex() = default;
+
+    // load the index if it exists, a corrupted or outdated index is ignored
+    explicit SourceIndex(fs::path index_file);
+
+    // sync with directories under roots, must be called before any list
+    void refresh(const std::vector<fs::path>& roots);
+
+    // whether the source list differs from the loaded one
+    bool changed() const { return mChanged; }
+
+    void save() const;
+
+    // of the listed directories and their entries, equal digests mean the same listing
+    std::uint64_t digest() const;
+
+    // recursive, the same as util list_sources
+    std::set<fs::path> list_sources(const fs::path& dir) const;
+
+    // non-recursive, the same as util list_cpp_files
+    std::set<fs::path> list_cpp_files(const fs::path& dir) const;
+
+    std::set<fs::path> list_files() const;
+
+private:
+    struct Directory {
+        std::int64_t mtime = 0;
+        std::uint64_t inode = 0;
+        std::vector<std::string> files;
+        std::vector<std::string> subdirs;
+    };
+
+    struct Walk {
+        std::map<fs::path, Directory> dirs;
+        bool changed = false;
+        bool dirty = false;
+    };
+
+    void load_();
+
+    // directories under root, the unchanged ones are taken from the loaded index
+    Walk walk_(const fs::path& root) const;
+
+    static Directory list_dir_(const fs::path& dir, std::int64_t mtime, std::uint64_t inode);
+
+private:
+    fs::path mIndexFile;
+    // mtime of the loaded index file, in the unit of directory mtimes
+    std::int64_t mIndexTime = 0;
+    std::map<fs::path, Directory> mDirs;
+    bool mChanged = false;
+    bool mDirty = false;
+};
+
+}
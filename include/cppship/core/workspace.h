@@ -1,9 +1,16 @@
 #pragma once
 
+#include <cstdint>
+#include <set>
+#include <string>
+
+#include <range/v3/view/join.hpp>
 #include <range/v3/view/map.hpp>
+#include <range/v3/view/transform.hpp>
 
 #include "cppship/core/layout.h"
 #include "cppship/core/manifest.h"
+#include "cppship/core/source_index.h"
 
 namespace cppship {
 
@@ -13,6 +20,11 @@ class Workspace {
 public:
     Workspace(const fs::path& project_root, const Manifest& manifest);
 
+    // refresh the index with package directories and list sources from it.
+    // target lists are saved to the snapshot file if given, and loaded instead of scanned while the listing is the same
+    Workspace(
+        const fs::path& project_root, const Manifest& manifest, SourceIndex& index, const fs::path& snapshot_file = {});
+
     const Layout* get_default() const
     {
         auto it = packages_.find({});
@@ -21,7 +33,11 @@ public:
 
     const Layout& as_package() const { return packages_.at({}); }
 
-    std::set<fs::path> list_files() const;
+    // sources of all packages, package by package
+    auto list_files() const
+    {
+        return ranges::views::values(packages_) | ranges::views::transform(&Layout::all_files) | ranges::views::join;
+    }
 
     auto begin() const { return packages_.begin(); }
 
@@ -31,6 +47,22 @@ public:
 
     const Layout* layout(std::string_view package) const;
 
+    // the innermost package containing the file, nullptr if none
+    const Layout* owner(const fs::path& file) const;
+
+    const fs::path& root() const { return root_; }
+
+private:
+    Workspace(
+        const fs::path& project_root, const Manifest& manifest, SourceIndex* index, const fs::path& snapshot_file);
+
+    void scan_(const Manifest& manifest, const SourceIndex* index);
+
+    // false if the snapshot is absent, corrupted or outdated
+    bool load_snapshot_(const fs::path& snapshot_file, std::uint64_t digest, const Manifest& manifest);
+
+    void save_snapshot_(const fs::path& snapshot_file, std::uint64_t digest) const;
+
 private:
     fs::path root_;
 
@@ -40,4 +72,9 @@ private:
 
 const Layout& enforce_default_package(const Workspace& workspace);
 
+// packages owning the changed files and packages depending on them.
+// changes of the root manifest or lockfiles affect all packages, other files out of packages affect none
+std::set<std::string> affected_packages(
+    const Workspace& workspace, const Manifest& manifest, const std::set<fs::path>& changed_files);
+
 }
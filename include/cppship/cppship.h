@@ -2,6 +2,7 @@
 
 #include "cppship/cmd/bench.h" // IWYU pragma: export
 #include "cppship/cmd/build.h" // IWYU pragma: export
+#include "cppship/cmd/cache_server.h" // IWYU pragma: export
 #include "cppship/cmd/clean.h" // IWYU pragma: export
 #include "cppship/cmd/cmake.h" // IWYU pragma: export
 #include "cppship/cmd/fmt.h" // IWYU pragma: export
@@ -9,4 +10,7 @@
 #include "cppship/cmd/install.h" // IWYU pragma: export
 #include "cppship/cmd/lint.h" // IWYU pragma: export
 #include "cppship/cmd/run.h" // IWYU pragma: export
+#include "cppship/cmd/stats.h" // IWYU pragma: export
 #include "cppship/cmd/test.h" // IWYU pragma: export
+#include "cppship/cmd/vendor.h" // IWYU pragma: export
+#include "cppship/cmd/worker.h" // IWYU pragma: export
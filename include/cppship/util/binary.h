@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace cppship {
+
+// native endian helpers of binary caches, readers check the stream state once done
+
+template <class T>
+void write_pod(std::ostream& os, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class T>
+T read_pod(std::istream& is)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value {};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    is.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+inline void write_string(std::ostream& os, std::string_view str)
+{
+    write_pod(os, static_cast<std::uint32_t>(str.size()));
+    os.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+inline std::string read_string(std::istream& is)
+{
+    // grow with the data read rather than trusting the length, which may be up to 4 GiB if corrupted
+    constexpr std::size_t kChunkSize = 64 * 1024;
+
+    const auto size = read_pod<std::uint32_t>(is);
+    std::string str;
+    while (str.size() < size && is) {
+        const auto offset = str.size();
+        str.resize(std::min<std::size_t>(size, offset + kChunkSize));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        is.read(str.data() + offset, static_cast<std::streamsize>(str.size() - offset));
+    }
+
+    return str;
+}
+
+inline void write_strings(std::ostream& os, const std::vector<std::string>& strs)
+{
+    write_pod(os, static_cast<std::uint32_t>(strs.size()));
+    for (const auto& str : strs) {
+        write_string(os, str);
+    }
+}
+
+inline std::vector<std::string> read_strings(std::istream& is)
+{
+    const auto size = read_pod<std::uint32_t>(is);
+
+    std::vector<std::string> strs;
+    for (std::uint32_t i = 0; i < size && is; ++i) {
+        strs.push_back(read_string(is));
+    }
+
+    return strs;
+}
+
+}
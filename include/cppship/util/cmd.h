@@ -11,11 +11,15 @@
 // clang-format on
 
 #include "cppship/exception.h"
+#include "cppship/util/fs.h"
 
 namespace cppship {
 
 bool has_cmd(std::string_view cmd);
 
+// full path of the command in PATH, throw CmdNotFound if absent
+fs::path find_cmd(std::string_view cmd);
+
 inline void require_cmd(std::string_view cmd)
 {
     if (!has_cmd(cmd)) {
@@ -1,14 +1,51 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <functional>
+#include <optional>
+#include <stop_token>
+#include <string>
 #include <string_view>
+#include <vector>
+
+#include "cppship/util/fs.h"
 
 namespace cppship::util {
 
+// a process run without a shell
+struct Task {
+    // the program and its args, the program is searched in PATH if it is not a path
+    std::vector<std::string> args;
+    std::optional<fs::path> cwd;
+    // stdout and stderr go to the file in the order they are written, instead of TaskResult
+    std::optional<fs::path> log_file;
+    // stderr is dropped if false
+    bool capture_stderr = true;
+    // the process and its children are killed on timeout
+    std::optional<std::chrono::milliseconds> timeout;
+};
+
+struct TaskResult {
+    int exit_code = -1;
+    // stdout
+    std::string output;
+    // stderr, or why the task cannot be started
+    std::string error_output;
+    bool timed_out = false;
+    bool cancelled = false;
+
+    bool ok() const { return exit_code == 0 && !timed_out && !cancelled; }
+};
+
+// called in the order tasks finish, with the index of the task
+using TaskCallback = std::function<void(std::size_t, const TaskResult&)>;
+
 class CmdRunner {
 public:
     CmdRunner() = default;
 
+    // the hook replaces both run and run_all, tasks are passed as space joined args
     template <class Fn>
         requires(!std::is_same_v<Fn, CmdRunner>)
     explicit CmdRunner(Fn&& fn)
@@ -18,6 +55,11 @@ public:
 
     int run(std::string_view cmd) const;
 
+    // run tasks concurrently in one event loop, at most max_concurrency children at a time, 0 for cpu cores.
+    // on stop, tasks not started are cancelled and running ones are killed
+    std::vector<TaskResult> run_all(const std::vector<Task>& tasks, unsigned max_concurrency,
+        const TaskCallback& on_done = {}, std::stop_token stop = {}) const;
+
 private:
     std::function<int(std::string_view)> mHook;
 };
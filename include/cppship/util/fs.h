@@ -35,4 +35,14 @@ inline void create_if_not_exist(const fs::path& path)
     fs::create_directory(path);
 }
 
+// path of the running cppship binary
+fs::path get_current_executable();
+
+// user level cache shared by all projects: $CPPSHIP_CACHE_DIR, or cppship/ under the platform cache dir
+fs::path get_cache_dir();
+
+// user level config: $CPPSHIP_CONFIG, or cppship/config.toml under the platform config dir. empty if there is no
+// such dir, the file may not exist
+fs::path get_config_file();
+
 }
\ No newline at end of file
@@ -1,11 +1,13 @@
 #pragma once
 
+#include "cppship/core/dependency.h"
 #include "cppship/util/fs.h"
 
 #include <string_view>
 
 namespace cppship::util {
 
-void git_clone(std::string_view package, const fs::path& deps_dir, std::string_view git, std::string_view commit);
+// shallow fetch the commit only, fallback to a full fetch if the server refuses to serve it
+void git_clone(std::string_view package, const fs::path& deps_dir, const GitDep& dep);
 
 }
\ No newline at end of file
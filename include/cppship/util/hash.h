@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace cppship::util {
+
+// 64-bit FNV-1a, stable across platforms and runs. used for cache keys, not for security
+class Hasher {
+public:
+    Hasher& update(std::string_view data)
+    {
+        for (const char c : data) {
+            mState ^= static_cast<unsigned char>(c);
+            mState *= kPrime;
+        }
+
+        return *this;
+    }
+
+    std::uint64_t digest() const { return mState; }
+
+    std::string hex() const { return fmt::format("{:016x}", mState); }
+
+private:
+    static constexpr std::uint64_t kOffsetBasis = 0xcbf29ce484222325ULL;
+    static constexpr std::uint64_t kPrime = 0x100000001b3ULL;
+
+    std::uint64_t mState = kOffsetBasis;
+};
+
+inline std::string hash_hex(std::string_view data) { return Hasher {}.update(data).hex(); }
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "cppship/util/fs.h"
+
+namespace cppship::util {
+
+inline constexpr unsigned kHttpOk = 200;
+inline constexpr unsigned kHttpBadRequest = 400;
+inline constexpr unsigned kHttpUnauthorized = 401;
+inline constexpr unsigned kHttpNotFound = 404;
+inline constexpr unsigned kHttpMethodNotAllowed = 405;
+inline constexpr unsigned kHttpConflict = 409;
+inline constexpr unsigned kHttpPayloadTooLarge = 413;
+inline constexpr unsigned kHttpInternalError = 500;
+inline constexpr unsigned kHttpServiceUnavailable = 503;
+
+struct HttpRequest {
+    std::string method = "GET";
+    std::string target = "/";
+    std::string body;
+    // bearer token of the Authorization header, not sent if empty
+    std::string token;
+    // if not empty, the body is streamed from the file rather than taken from body. servers with a body dir stream
+    // received bodies into a temp file there, which is removed once handled unless the handler moves it
+    fs::path body_file;
+};
+
+struct HttpResponse {
+    unsigned status = kHttpOk;
+    std::string body;
+    // if not empty, the body is streamed from the file rather than taken from body
+    fs::path body_file;
+
+    bool ok() const { return status >= 200 && status < 300; }
+};
+
+// for each step of a request rather than the whole of it, a large transfer only times out if it stalls
+inline constexpr auto kHttpTimeout = std::chrono::seconds(30);
+
+// limit of bodies held in memory, larger ones are streamed through files
+inline constexpr std::uint64_t kHttpMaxMemoryBody = 256ULL << 20;
+
+// plain http/1.1 without keep-alive, throw on network errors and when connecting, sending or receiving stalls longer
+// than the timeout
+HttpResponse http_request(const std::string& host, const std::string& port, const HttpRequest& req,
+    std::chrono::milliseconds timeout = kHttpTimeout);
+
+// the same as http_request, but the body of a successful response is streamed into file and is limited to limit.
+// file is removed if the transfer fails, and left untouched for other responses
+HttpResponse http_download(const std::string& host, const std::string& port, const HttpRequest& req,
+    const fs::path& file, std::uint64_t limit, std::chrono::milliseconds timeout = kHttpTimeout);
+
+// blocking http server, each connection is served synchronously by one of the workers and closed once idle for
+// kHttpTimeout
+class HttpServer {
+public:
+    using Handler = std::function<HttpResponse(const HttpRequest&)>;
+
+    // port 0 picks a free port. request bodies are limited to body_limit, and streamed into temp files under body_dir
+    // if given rather than held in memory
+    HttpServer(std::string_view host, std::uint16_t port, Handler handler, unsigned workers,
+        std::uint64_t body_limit = kHttpMaxMemoryBody, fs::path body_dir = {});
+
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer(HttpServer&&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+    HttpServer& operator=(HttpServer&&) = delete;
+
+    std::uint16_t port() const;
+
+    // serve until stop is called
+    void run();
+
+    // thread safe
+    void stop();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
+}
@@ -6,10 +6,18 @@ namespace cppship {
 
 void write(const fs::path& file, std::string_view content);
 
+// a temp file next to file and unique among threads and processes, to be renamed to file once written
+fs::path temp_file_for(const fs::path& file);
+
+// write in binary mode to a temp file and rename it, so readers never see a partial file
+void write_atomic(const fs::path& file, std::string_view content);
+
 void touch(const fs::path& file);
 
 std::string read_as_string(const fs::path& file);
 
 std::string read_as_string(std::istream& iss);
 
+std::string read_binary(const fs::path& file);
+
 }
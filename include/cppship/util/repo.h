@@ -1,7 +1,10 @@
 #pragma once
 
+#include <map>
 #include <set>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "cppship/util/fs.h"
 
@@ -23,7 +26,8 @@ inline constexpr std::string_view kInnerTestSuffix = "_test.cpp";
 // Layout of build dir
 //  debug/ or release/: cmake build directory(the profile directory)
 //    conan_profile
-//    inventory.toml: source file list
+//    inventory.toml: lib targets
+//    source.index: binary listing of source directories
 //    dependency.toml: resolved conan+git dependencies
 //  deps: cppship packages, git packages
 //  packages: package cmake config
@@ -31,6 +35,7 @@ inline constexpr std::string_view kInnerTestSuffix = "_test.cpp";
 //    <package-2>.cmake
 //  CMakeLists.txt: the generated cmake file
 //  conanfile.txt: conan dependencies
+//  history.toml: telemetry of builds, appended by each build
 //  git_dep.txt: git dependencies
 inline constexpr std::string_view kBuildPath = "build";
 inline constexpr std::string_view kBuildPackagesPath = "packages";
@@ -46,6 +51,8 @@ fs::path get_package_root();
 struct ListOptions {
     bool cached_only = true;
     std::string_view commit = kRepoHead;
+    // false to list all changed files, including deleted ones
+    bool sources_only = true;
 };
 
 std::set<fs::path> list_sources(std::string_view dir);
@@ -55,4 +62,23 @@ std::set<fs::path> list_all_files();
 
 std::set<fs::path> list_changed_files(const ListOptions& options = {});
 
+// 1-based, inclusive, the same as clang-format --lines
+struct LineRange {
+    int first = 0;
+    int last = 0;
+
+    bool operator==(const LineRange&) const = default;
+};
+
+// changed lines of each file, pure deletions are not included.
+// empty ranges mean the whole file, eg. not in a git repo
+std::map<fs::path, std::vector<LineRange>> list_changed_lines(const ListOptions& options = {});
+
+namespace repo_internals {
+
+// parse output of `git diff -U0`, paths are relative to the repo root
+std::map<std::string, std::vector<LineRange>> parse_diff_hunks(std::string_view diff);
+
+}
+
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <boost/algorithm/string/classification.hpp>
@@ -27,4 +28,20 @@ inline bool contains(std::string_view corpus, std::string_view patten)
     return corpus.find(patten) != std::string_view::npos;
 }
 
+// match str literally in an extended regex, eg. ctest -R and -L
+inline std::string escape_regex(std::string_view str)
+{
+    constexpr std::string_view kSpecial = R"(\^$.|?*+()[]{})";
+
+    std::string result;
+    for (const char c : str) {
+        if (kSpecial.find(c) != std::string_view::npos) {
+            result += '\\';
+        }
+        result += c;
+    }
+
+    return result;
+}
+
 }
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <memory>
+
+#include <toml/value.hpp>
+
+#include "cppship/util/fs.h"
+
+namespace cppship {
+
+// parse a toml file, parsed values are cached per process and reused as long as the file content is unchanged.
+// manifests are read by repo root detection, Manifest, resolver, etc., this makes each of them parsed only once.
+std::shared_ptr<const toml::value> load_toml(const fs::path& file);
+
+// drop all cached values, so the next load_toml parses again, eg. for benchmarks of parsing
+void clear_toml_cache();
+
+}
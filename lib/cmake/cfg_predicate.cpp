@@ -52,6 +52,29 @@ struct CfgOptionGen {
 
         std::abort();
     }
+
+    // processor names differ among systems
+    // see https://cmake.org/cmake/help/latest/variable/CMAKE_SYSTEM_PROCESSOR.html
+    std::string operator()(core::cfg::Arch arch)
+    {
+        using core::cfg::Arch;
+
+        switch (arch) {
+        case Arch::x86_64:
+            return R"(CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64)$")";
+
+        case Arch::aarch64:
+            return R"(CMAKE_SYSTEM_PROCESSOR MATCHES "^(aarch64|arm64|ARM64)$")";
+        }
+
+        std::abort();
+    }
+
+    // detected by the code of generate_feature_detection
+    std::string operator()(core::cfg::Feature feature)
+    {
+        return fmt::format(R"("{}" IN_LIST {})", core::cfg::to_string(feature), cmake::kTargetFeaturesVar);
+    }
 };
 
 // NOLINTBEGIN(misc-no-recursion)
@@ -93,4 +116,58 @@ struct CfgGen {
 
 std::string cmake::generate_predicate(const core::CfgPredicate& cfg) { return std::visit(CfgGen {}, cfg); }
 
+// keep in sync with core::cfg::target_features
+std::string cmake::generate_feature_detection()
+{
+    return fmt::format(R"cmake(
+# target features of cfg predicates, from env {0} or detected on the host
+if(DEFINED ENV{{{0}}})
+    string(REGEX MATCHALL "[a-z0-9.]+" {1} "$ENV{{{0}}}")
+elseif(NOT DEFINED {1})
+    set(_FEATURES_SOURCE ${{CMAKE_BINARY_DIR}}/cppship_detect_features.cpp)
+    file(WRITE ${{_FEATURES_SOURCE}} [=[
+#include <cstdio>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+int main()
+{{
+#if defined(__aarch64__) || defined(_M_ARM64)
+    std::puts("neon");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[4];
+    __cpuid(regs, 1);
+    const unsigned long long xcr0 = (regs[2] & (1 << 27)) ? _xgetbv(0) : 0;
+    if (regs[2] & (1 << 20)) std::puts("sse4.2");
+    __cpuidex(regs, 7, 0);
+    if ((xcr0 & 0x6) == 0x6 && (regs[1] & (1 << 5))) std::puts("avx2");
+    if ((xcr0 & 0xe6) == 0xe6 && (regs[1] & (1 << 16))) std::puts("avx512f");
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) std::puts("sse4.2");
+    if (__builtin_cpu_supports("avx2")) std::puts("avx2");
+    if (__builtin_cpu_supports("avx512f")) std::puts("avx512f");
+#endif
+    return 0;
+}}
+]=])
+
+    set(_FEATURES_OUTPUT "")
+    if(CMAKE_CROSSCOMPILING)
+        message(WARNING "target features are not detected when cross compiling, set them by env {0}")
+    else()
+        try_run(_FEATURES_RUN _FEATURES_COMPILE ${{CMAKE_BINARY_DIR}}/cppship_detect_features ${{_FEATURES_SOURCE}}
+            RUN_OUTPUT_VARIABLE _FEATURES_OUTPUT)
+    endif()
+
+    string(REGEX MATCHALL "[a-z0-9.]+" _FEATURES "${{_FEATURES_OUTPUT}}")
+    set({1} "${{_FEATURES}}" CACHE STRING "target features of cfg predicates")
+endif()
+message(STATUS "Target features: ${{{1}}}")
+)cmake",
+        core::cfg::kTargetFeaturesEnv,
+        kTargetFeaturesVar);
+}
+
 // NOLINTEND(misc-no-recursion)
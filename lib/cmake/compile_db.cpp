@@ -0,0 +1,273 @@
+#include "cppship/cmake/compile_db.h"
+
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/replace.hpp>
+#include <fmt/core.h>
+#include <range/v3/range/conversion.hpp>
+
+#include "cppship/cmake/lib.h"
+#include "cppship/util/assert.h"
+
+using namespace cppship;
+using namespace cppship::cmake;
+
+namespace {
+
+// flag spellings of gcc-like compilers and msvc
+struct FlagStyle {
+    bool msvc = false;
+
+    std::string cxx_std(CxxStd std) const
+    {
+        if (!msvc) {
+            return fmt::format("-std=c++{}", std);
+        }
+
+        return std == CxxStd::cxx23 ? "/std:c++latest" : fmt::format("/std:c++{}", std);
+    }
+
+    std::string define(std::string_view def) const { return fmt::format("{}D{}", msvc ? "/" : "-", def); }
+
+    std::vector<std::string> include(const fs::path& dir) const
+    {
+        return { msvc ? "/I" : "-I", dir.string() };
+    }
+
+    std::vector<std::string> system_include(const fs::path& dir) const
+    {
+        return { msvc ? "/external:I" : "-isystem", dir.string() };
+    }
+
+    // the same as CMAKE_CXX_FLAGS_<CONFIG> of cmake
+    std::vector<std::string> config_flags(const Profile& build_type) const
+    {
+        if (build_type == Profile::release) {
+            return msvc ? std::vector<std::string> { "/O2", "/Ob2", "/DNDEBUG" }
+                        : std::vector<std::string> { "-O3", "-DNDEBUG" };
+        }
+
+        return msvc ? std::vector<std::string> { "/Zi", "/Ob0", "/Od" } : std::vector<std::string> { "-g" };
+    }
+
+    std::string_view compile_only() const { return msvc ? "/c" : "-c"; }
+};
+
+// compile options and definitions emitted by ProfileOptionGen
+void append_profile_config(const ProfileConfig& config, const FlagStyle& style, std::vector<std::string>& out)
+{
+    for (const auto& def : config.definitions) {
+        out.push_back(style.define(def));
+    }
+
+    out.insert(out.end(), config.cxxflags.begin(), config.cxxflags.end());
+
+    if (config.ubsan.value_or(false)) {
+        out.emplace_back("-fsanitize=undefined");
+    }
+    if (config.tsan.value_or(false)) {
+        out.emplace_back("-fsanitize=thread");
+    }
+    if (config.asan.value_or(false)) {
+        out.emplace_back("-fsanitize=address");
+    }
+    if (config.leak.value_or(false)) {
+        out.emplace_back("-fsanitize=leak");
+    }
+}
+
+void append_profile(const ProfileOptions& options, const cmake::CompileDbOptions& db_options, const FlagStyle& style,
+    std::vector<std::string>& out)
+{
+    append_profile_config(options.config, style, out);
+
+    for (const auto& [condition, config] : options.conditional_configs) {
+        if (core::eval_cfg(condition, db_options.platform)) {
+            append_profile_config(config, style, out);
+        }
+    }
+}
+
+std::string json_escape(std::string_view str)
+{
+    std::string out;
+    out.reserve(str.size());
+
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            out += R"(\")";
+            break;
+
+        case '\\':
+            out += R"(\\)";
+            break;
+
+        case '\n':
+            out += R"(\n)";
+            break;
+
+        case '\t':
+            out += R"(\t)";
+            break;
+
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+            } else {
+                out += c;
+            }
+        }
+    }
+
+    return out;
+}
+
+class CompileDbWriter {
+public:
+    CompileDbWriter(const Workspace& workspace, const Manifest& manifest, const CompileDbOptions& options)
+        : mWorkspace(workspace)
+        , mOptions(options)
+        , mProfiles(manifest.profile_chain(options.profile))
+        , mStyle { .msvc = options.platform.compiler == core::cfg::Compiler::msvc }
+    {
+    }
+
+    void add_package(const Layout& layout, const PackageManifest& manifest)
+    {
+        auto common = mStyle.config_flags(mProfiles.front());
+        append_profile(manifest.default_profile(), mOptions, mStyle, common);
+        for (const auto& profile : mProfiles) {
+            append_profile(manifest.profile(profile), mOptions, mStyle, common);
+        }
+        common.push_back(mStyle.cxx_std(manifest.cxx_std()));
+
+        std::set<fs::path> lib_includes;
+        if (const auto& lib = layout.lib()) {
+            lib_includes = lib->includes | ranges::to<std::set>();
+            // the generated dispatch header, see CmakeLib
+            if (!manifest.multiversion_sources().empty()) {
+                lib_includes.insert(mOptions.build_dir / "isa");
+            }
+
+            // multiversion sources are indexed as their baseline variant
+            std::vector<fs::path> sources;
+            std::vector<fs::path> baseline;
+            for (const auto& source : lib->sources) {
+                (manifest.is_multiversion_source(layout.root(), source) ? baseline : sources).push_back(source);
+            }
+
+            add_sources_(lib_includes, sources, {}, common);
+            add_sources_(lib_includes,
+                baseline,
+                { mStyle.define(
+                    fmt::format("CPPSHIP_ISA_NS={}_isa_{}", isa_prefix(lib->name), kIsaLevels.front().suffix)) },
+                common);
+        }
+
+        const auto version_def = mStyle.define(fmt::format(R"({}_VERSION="{}")",
+            boost::replace_all_copy(boost::to_upper_copy(std::string { manifest.name() }), "-", "_"),
+            manifest.version()));
+        for (const auto& bin : layout.binaries()) {
+            add_target_(bin, lib_includes, { version_def }, common);
+        }
+
+        for (const auto& targets : { layout.examples(), layout.benches(), layout.tests() }) {
+            for (const auto& target : targets) {
+                add_target_(target, lib_includes, {}, common);
+            }
+        }
+    }
+
+    std::string build() &&
+    {
+        mOut << (mFirst ? "[" : "") << "\n]\n";
+        return mOut.str();
+    }
+
+private:
+    void add_target_(const Target& target, const std::set<fs::path>& lib_includes,
+        const std::vector<std::string>& definitions, const std::vector<std::string>& common)
+    {
+        // includes of the linked lib are public
+        auto includes = target.includes | ranges::to<std::set>();
+        includes.insert(lib_includes.begin(), lib_includes.end());
+        add_sources_(includes, target.sources, definitions, common);
+    }
+
+    template <class Sources>
+    void add_sources_(const std::set<fs::path>& includes, const Sources& sources,
+        const std::vector<std::string>& definitions, const std::vector<std::string>& common)
+    {
+        std::vector<std::string> args { mOptions.compiler };
+        args.insert(args.end(), definitions.begin(), definitions.end());
+
+        for (const auto& dir : includes) {
+            for (auto& arg : mStyle.include(absolute_(dir))) {
+                args.push_back(std::move(arg));
+            }
+        }
+
+        for (const auto& dir : mOptions.dependency_includes) {
+            for (auto& arg : mStyle.system_include(dir)) {
+                args.push_back(std::move(arg));
+            }
+        }
+
+        args.insert(args.end(), common.begin(), common.end());
+
+        for (const auto& source : sources) {
+            add_entry_(args, absolute_(source));
+        }
+    }
+
+    void add_entry_(std::vector<std::string> args, const fs::path& source)
+    {
+        args.emplace_back(mStyle.compile_only());
+        args.push_back(source.string());
+
+        mOut << (mFirst ? "[\n" : ",\n");
+        mFirst = false;
+
+        mOut << "  {\n"
+             << fmt::format("    \"directory\": \"{}\",\n", json_escape(mOptions.build_dir.string()))
+             << fmt::format("    \"file\": \"{}\",\n", json_escape(source.string())) << "    \"arguments\": [";
+        for (std::size_t i = 0; i < args.size(); ++i) {
+            mOut << (i == 0 ? "" : ", ") << '"' << json_escape(args[i]) << '"';
+        }
+        mOut << "]\n  }";
+    }
+
+    fs::path absolute_(const fs::path& path) const { return (mWorkspace.root() / path).lexically_normal(); }
+
+private:
+    const Workspace& mWorkspace;
+    const CompileDbOptions& mOptions;
+    // the profile and those it inherits
+    std::vector<Profile> mProfiles;
+    FlagStyle mStyle;
+
+    std::ostringstream mOut;
+    bool mFirst = true;
+};
+
+}
+
+std::string cmake::generate_compile_db(
+    const Workspace& workspace, const Manifest& manifest, const CompileDbOptions& options)
+{
+    CompileDbWriter writer(workspace, manifest, options);
+
+    for (const auto& [path, layout] : workspace) {
+        const auto* package = manifest.is_workspace() ? manifest.get_by_path(path) : manifest.get_if_package();
+        enforce(package != nullptr, "manifest and workspace inconsistent");
+
+        writer.add_package(layout, *package);
+    }
+
+    return std::move(writer).build();
+}
@@ -9,7 +9,6 @@
 #include <gsl/pointers>
 #include <range/v3/action/push_back.hpp>
 #include <range/v3/algorithm/any_of.hpp>
-#include <range/v3/range/conversion.hpp>
 #include <range/v3/view/concat.hpp>
 #include <range/v3/view/transform.hpp>
 
@@ -20,7 +19,7 @@
 #include "cppship/cmake/lib.h"
 #include "cppship/cmake/naming.h"
 #include "cppship/core/manifest.h"
-#include "cppship/core/resolver.h"
+#include "cppship/core/dependency_graph.h"
 #include "cppship/exception.h"
 
 using namespace ranges::views;
@@ -112,8 +111,9 @@ void CmakeGenerator::emit_header_()
     fill_default_profile_();
 
     mOut << "\n# profile cpp options\n";
-    fill_profile_(Profile::debug);
-    fill_profile_(Profile::release);
+    for (const auto& profile : mManifest->list_profiles()) {
+        fill_profile_(profile);
+    }
 
     mOut << fmt::format(R"(
 # cpp std
@@ -167,7 +167,7 @@ void CmakeGenerator::emit_package_finders_()
 
 void CmakeGenerator::add_lib_sources_()
 {
-    const auto target = mLayout->lib();
+    const auto& target = mLayout->lib();
     if (!target) {
         return;
     }
@@ -178,6 +178,10 @@ void CmakeGenerator::add_lib_sources_()
         .include_dirs = target->includes,
         .sources = target->sources,
         .deps = mDeps,
+        .profile_target = NameTargetMapper(mName).profile(),
+        .multiversion_sources = target->sources.filter([this](const fs::path& source) {
+            return mManifest->is_multiversion_source(mLayout->root(), source);
+        }),
     });
     lib.build(mOut);
 
@@ -198,6 +202,7 @@ void CmakeGenerator::add_app_sources_()
     };
 
     NameTargetMapper mapper(mName);
+    const auto deps = with_profile_(mDeps);
     for (const auto& bin : mLayout->binaries()) {
         const auto target = mapper.binary(bin.name);
         cmake::CmakeBin gen({
@@ -205,7 +210,7 @@ void CmakeGenerator::add_app_sources_()
             .name_alias = bin.name,
             .sources = bin.sources,
             .lib = mLib,
-            .deps = mDeps,
+            .deps = deps,
             .definitions = definitions,
             .need_install = true,
         });
@@ -254,7 +259,7 @@ find_package(benchmark REQUIRED)
 )";
 
     NameTargetMapper mapper(mName);
-    auto deps = mDevDeps;
+    auto deps = with_profile_(mDevDeps);
     deps.push_back({
         .cmake_package = "benchmark",
         .cmake_targets = { "benchmark::benchmark" },
@@ -283,6 +288,7 @@ void CmakeGenerator::add_examples_()
     }
 
     NameTargetMapper mapper(mName);
+    const auto deps = with_profile_(mDevDeps);
     for (const auto& bin : examples) {
         const auto target = mapper.example(bin.name);
 
@@ -290,7 +296,7 @@ void CmakeGenerator::add_examples_()
             .name = target,
             .sources = bin.sources,
             .lib = mLib,
-            .deps = mDevDeps,
+            .deps = deps,
             .runtime_dir = "examples",
         });
 
@@ -316,7 +322,7 @@ find_package(GTest REQUIRED)
         const auto target = mapper.test(test.name);
 
         mOut << '\n'
-             << fmt::format("add_executable({} {})\n", target, test.sources.begin()->generic_string())
+             << fmt::format("add_executable({} {})\n", target, (*test.sources.begin()).generic_string())
              << fmt::format("target_link_libraries({} PRIVATE GTest::gtest_main)\n", target)
              << fmt::format(
                     R"(set_target_properties({} PROPERTIES RUNTIME_OUTPUT_DIRECTORY "${{CMAKE_BINARY_DIR}}/tests"))",
@@ -326,7 +332,7 @@ find_package(GTest REQUIRED)
         if (mLib) {
             mOut << fmt::format("target_link_libraries({} PRIVATE {})\n", target, *mLib);
         }
-        for (const auto& dep : mDevDeps) {
+        for (const auto& dep : with_profile_(mDevDeps)) {
             mOut << fmt::format("target_link_libraries({} PRIVATE {})\n", target, boost::join(dep.cmake_targets, " "));
         }
 
@@ -337,6 +343,16 @@ find_package(GTest REQUIRED)
     }
 }
 
+std::vector<cmake::Dep> CmakeGenerator::with_profile_(std::vector<cmake::Dep> deps) const
+{
+    deps.push_back({
+        .cmake_package = "",
+        .cmake_targets = { NameTargetMapper(mName).profile() },
+    });
+
+    return deps;
+}
+
 void CmakeGenerator::emit_footer_()
 {
     mOut << "\n# Groups\n"
@@ -361,87 +377,74 @@ void CmakeGenerator::emit_footer_()
 
 namespace {
 
+bool uses_target_features(const PackageManifest& manifest)
+{
+    const auto uses = [](const ProfileOptions& options) {
+        return ranges::any_of(options.conditional_configs,
+            [](const ConditionConfig& config) { return core::uses_target_features(config.condition); });
+    };
+
+    return uses(manifest.default_profile()) || ranges::any_of(manifest.list_profiles(), [&](const Profile& profile) {
+        return uses(manifest.profile(profile));
+    });
+}
+
 class ProfileOptionGen {
     std::ostream& mOut; // NOLINT
+    std::string_view mTarget;
+    // definitions and sanitizers have to agree across the link, so deps built from source get them too
+    std::string_view mDepsTarget = cmake::kCppshipDepsProfile;
 
 public:
-    explicit ProfileOptionGen(std::ostream& out)
+    ProfileOptionGen(std::ostream& out, std::string_view target)
         : mOut(out)
+        , mTarget(target)
     {
     }
 
     void output(const std::string_view profile, const ProfileConfig& config, std::string_view indent = "")
     {
-        for (const auto& opt : config.cxxflags) {
-            mOut << fmt::format("{}add_compile_options($<$<CONFIG:{}>:{}>)\n", indent, profile, opt);
-        }
-        for (const auto& opt : config.linkflags) {
-            mOut << fmt::format("{}add_link_options($<$<CONFIG:{}>:{}>)\n", indent, profile, opt);
-        }
-        for (const auto& def : config.definitions) {
-            mOut << fmt::format("{}add_compile_definitions($<$<CONFIG:{}>:{}>)\n", indent, profile, def);
-        }
-
-        if (config.ubsan.value_or(false)) {
-            mOut << fmt::format("{}add_compile_options($<$<CONFIG:{}>:{}>)\n", indent, profile, "-fsanitize=undefined");
-            mOut << fmt::format("{}add_link_options($<$<CONFIG:{}>:{}>)\n", indent, profile, "-fsanitize=undefined");
-            mOut << fmt::format("{}message(STATUS \"Enable ubsan\")\n", indent);
-        }
-
-        if (config.tsan.value_or(false)) {
-            mOut << fmt::format("{}add_compile_options($<$<CONFIG:{}>:{}>)\n", indent, profile, "-fsanitize=thread");
-            mOut << fmt::format("{}add_link_options($<$<CONFIG:{}>:{}>)\n", indent, profile, "-fsanitize=thread");
-            mOut << fmt::format("{}message(STATUS \"Enable tsan\")\n", indent);
-        }
-
-        if (config.asan.value_or(false)) {
-            mOut << fmt::format("{}add_compile_options($<$<CONFIG:{}>:{}>)\n", indent, profile, "-fsanitize=address");
-            mOut << fmt::format("{}add_link_options($<$<CONFIG:{}>:{}>)\n", indent, profile, "-fsanitize=address");
-            mOut << fmt::format("{}message(STATUS \"Enable asan\")\n", indent);
-        }
-
-        if (config.leak.value_or(false)) {
-            mOut << fmt::format("{}add_compile_options($<$<CONFIG:{}>:{}>)\n", indent, profile, "-fsanitize=leak");
-            mOut << fmt::format("{}add_link_options($<$<CONFIG:{}>:{}>)\n", indent, profile, "-fsanitize=leak");
-            mOut << fmt::format("{}message(STATUS \"Enable leak\")\n", indent);
-        }
+        output_(config, indent, [profile](std::string_view opt) {
+            return fmt::format("$<$<CONFIG:{}>:{}>", profile, opt);
+        });
     }
 
     void output(const ProfileConfig& config, std::string_view indent = "")
+    {
+        output_(config, indent, [](std::string_view opt) { return std::string { opt }; });
+    }
+
+private:
+    template <class Wrap> void output_(const ProfileConfig& config, std::string_view indent, const Wrap& wrap)
     {
         for (const auto& opt : config.cxxflags) {
-            mOut << fmt::format("{}add_compile_options({})\n", indent, opt);
+            mOut << fmt::format("{}target_compile_options({} INTERFACE {})\n", indent, mTarget, wrap(opt));
         }
         for (const auto& opt : config.linkflags) {
-            mOut << fmt::format("{}add_link_options({}>)\n", indent, opt);
+            mOut << fmt::format("{}target_link_options({} INTERFACE {})\n", indent, mTarget, wrap(opt));
         }
         for (const auto& def : config.definitions) {
-            mOut << fmt::format("{}add_compile_definitions({})\n", indent, def);
-        }
-
-        if (config.ubsan.value_or(false)) {
-            mOut << fmt::format("{}add_compile_options({})\n", indent, "-fsanitize=undefined");
-            mOut << fmt::format("{}add_link_options({})\n", indent, "-fsanitize=undefined");
-            mOut << fmt::format("{}message(STATUS \"Enable ubsan\")\n", indent);
+            mOut << fmt::format("{}target_compile_definitions({} INTERFACE {})\n", indent, mTarget, wrap(def));
+            mOut << fmt::format("{}target_compile_definitions({} INTERFACE {})\n", indent, mDepsTarget, wrap(def));
         }
 
-        if (config.tsan.value_or(false)) {
-            mOut << fmt::format("{}add_compile_options({})\n", indent, "-fsanitize=thread");
-            mOut << fmt::format("{}add_link_options({})\n", indent, "-fsanitize=thread");
-            mOut << fmt::format("{}message(STATUS \"Enable tsan\")\n", indent);
-        }
-
-        if (config.asan.value_or(false)) {
-            mOut << fmt::format("{}add_compile_options({})\n", indent, "-fsanitize=address");
-            mOut << fmt::format("{}add_link_options({})\n", indent, "-fsanitize=address");
-            mOut << fmt::format("{}message(STATUS \"Enable asan\")\n", indent);
-        }
+        const auto sanitize = [&](const std::optional<bool>& enabled, std::string_view sanitizer,
+                                  std::string_view name) {
+            if (!enabled.value_or(false)) {
+                return;
+            }
 
-        if (config.leak.value_or(false)) {
-            mOut << fmt::format("{}add_compile_options({})\n", indent, "-fsanitize=leak");
-            mOut << fmt::format("{}add_link_options({})\n", indent, "-fsanitize=leak");
-            mOut << fmt::format("{}message(STATUS \"Enable leak\")\n", indent);
-        }
+            const auto flag = wrap(fmt::format("-fsanitize={}", sanitizer));
+            mOut << fmt::format("{}target_compile_options({} INTERFACE {})\n", indent, mTarget, flag);
+            mOut << fmt::format("{}target_link_options({} INTERFACE {})\n", indent, mTarget, flag);
+            mOut << fmt::format("{}target_compile_options({} INTERFACE {})\n", indent, mDepsTarget, flag);
+            mOut << fmt::format("{}message(STATUS \"Enable {}\")\n", indent, name);
+        };
+
+        sanitize(config.ubsan, "undefined", "ubsan");
+        sanitize(config.tsan, "thread", "tsan");
+        sanitize(config.asan, "address", "asan");
+        sanitize(config.leak, "leak", "leak");
     }
 };
 
@@ -449,9 +452,18 @@ public:
 
 void CmakeGenerator::fill_default_profile_()
 {
+    if (uses_target_features(*mManifest)) {
+        mOut << generate_feature_detection();
+    }
+
     const auto& default_profile = mManifest->default_profile();
 
-    ProfileOptionGen appender(mOut);
+    // flags are scoped to targets of the package, packages of a workspace share one cmake directory
+    const auto target = NameTargetMapper(mName).profile();
+    mOut << fmt::format("add_library({} INTERFACE)\n", target);
+    // packages of a workspace share it
+    mOut << fmt::format("if(NOT TARGET {0})\n\tadd_library({0} INTERFACE)\nendif()\n", cmake::kCppshipDepsProfile);
+    ProfileOptionGen appender(mOut, target);
     appender.output(default_profile.config);
 
     for (const auto& [condition, config] : default_profile.conditional_configs) {
@@ -461,19 +473,42 @@ void CmakeGenerator::fill_default_profile_()
     }
 }
 
-void CmakeGenerator::fill_profile_(Profile profile)
+void CmakeGenerator::fill_profile_(const Profile& profile)
 {
-    const auto& options = mManifest->profile(profile);
-    const auto& profile_str = to_string(profile);
+    ProfileOptionGen appender(mOut, NameTargetMapper(mName).profile());
 
-    ProfileOptionGen appender(mOut);
-    appender.output(profile_str, options.config);
+    if (profile.is_build_type()) {
+        const auto& options = mManifest->profile(profile);
+        const auto& profile_str = to_string(profile);
 
-    for (const auto& [condition, config] : options.conditional_configs) {
-        mOut << fmt::format("if({})\n", generate_predicate(condition));
-        appender.output(profile_str, config, "\t");
-        mOut << "endif()\n\n";
+        appender.output(profile_str, options.config);
+
+        for (const auto& [condition, config] : options.conditional_configs) {
+            mOut << fmt::format("if({})\n", generate_predicate(condition));
+            appender.output(profile_str, config, "\t");
+            mOut << "endif()\n\n";
+        }
+
+        return;
+    }
+
+    // other profiles share the cmake build type they inherit, CPPSHIP_PROFILE tells them apart
+    mOut << fmt::format("if({} STREQUAL \"{}\")\n", kCppshipProfileVar, profile.name());
+    for (const auto& inherited : mManifest->profile_chain(profile)) {
+        if (inherited.is_build_type()) {
+            continue;
+        }
+
+        const auto& options = mManifest->profile(inherited);
+        appender.output(options.config, "\t");
+
+        for (const auto& [condition, config] : options.conditional_configs) {
+            mOut << fmt::format("\tif({})\n", generate_predicate(condition));
+            appender.output(config, "\t\t");
+            mOut << "\tendif()\n";
+        }
     }
+    mOut << "endif()\n\n";
 }
 
 std::string SimpleGenerator::build() &&
@@ -502,9 +537,9 @@ std::string SimpleGenerator::build() &&
     return std::move(oss).str();
 }
 
-WorkspaceGenerator::WorkspaceGenerator(
-    const fs::path& deps_dir, std::function<std::string(std::string_view, std::string_view)> package_handler)
-    : mDepsDir(deps_dir)
+WorkspaceGenerator::WorkspaceGenerator(gsl::not_null<DependencyGraph*> graph,
+    std::function<std::string(std::string_view, std::string_view)> package_handler)
+    : mGraph(graph)
     , mPackageHandler(std::move(package_handler))
 {
     mOut << "cmake_minimum_required(VERSION 3.17)\n" << fmt::format("project(cppship_workspace VERSION 1.0)\n\n");
@@ -513,8 +548,7 @@ WorkspaceGenerator::WorkspaceGenerator(
 void WorkspaceGenerator::add(
     const Layout& layout, const PackageManifest& manifest, const ResolvedDependencies& resolved_deps)
 {
-    Resolver resolver(mDepsDir, manifest, nullptr);
-    const auto result = std::move(resolver).resolve();
+    const auto& result = mGraph->resolve(manifest);
 
     CmakeGenerator gen(&layout,
         &manifest,
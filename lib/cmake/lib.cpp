@@ -1,6 +1,8 @@
 #include "cppship/cmake/lib.h"
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/replace.hpp>
 #include <fmt/core.h>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/filter.hpp>
@@ -12,11 +14,112 @@ using namespace ranges::views;
 
 namespace {
 
-std::set<std::string> to_strings(const std::set<fs::path>& paths)
+std::set<std::string> to_strings(const PathSet& paths)
 {
     return paths | transform([](const fs::path& path) { return path.generic_string(); }) | ranges::to<std::set>();
 }
 
+constexpr std::string_view kIsaDir = "${CMAKE_BINARY_DIR}/isa";
+
+// dispatch by the best level the cpu supports, the same levels as -march=x86-64-vN
+std::string isa_header(std::string_view prefix)
+{
+    const auto macro = boost::to_upper_copy(std::string { prefix });
+    std::vector<std::string> declares;
+    std::vector<std::string> variants;
+    for (const auto& level : kIsaLevels) {
+        declares.push_back(fmt::format("namespace {}_isa_{} {{ __VA_ARGS__ }}", prefix, level.suffix));
+        variants.push_back(fmt::format("&::{}_isa_{}::fn", prefix, level.suffix));
+    }
+
+    return fmt::format(R"(#pragma once
+
+// generated by cppship, multiversion sources define their functions in namespace CPPSHIP_ISA_NS
+
+// declare functions of multiversion sources for all levels
+#define {0}_ISA_DECLARE(...) {2}
+
+// the variant of function fn for the best level the cpu supports, fn should not be overloaded
+#define {0}_ISA_DISPATCH(fn) ::{1}_isa::select({3})
+
+namespace {1}_isa {{
+
+// 0 for the x86-64 baseline and other cpus, up to 3 for x86-64-v4, detected once
+int level() noexcept;
+
+template <class Fn> Fn select(Fn v1, Fn v2, Fn v3, Fn v4) noexcept
+{{
+    switch (level()) {{
+    case 3:
+        return v4;
+    case 2:
+        return v3;
+    case 1:
+        return v2;
+    default:
+        return v1;
+    }}
+}}
+
+}}
+)",
+        macro,
+        prefix,
+        boost::join(declares, " "),
+        boost::join(variants, ", "));
+}
+
+std::string isa_source(std::string_view prefix)
+{
+    return fmt::format(R"(#include "{0}_isa.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace {{
+
+int detect() noexcept
+{{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int leaf1[4];
+    int leaf7[4];
+    __cpuid(leaf1, 1);
+    __cpuidex(leaf7, 7, 0);
+    const unsigned long long xcr0 = (leaf1[2] & (1 << 27)) ? _xgetbv(0) : 0;
+    const bool v2 = (leaf1[2] & (1 << 20)) && (leaf1[2] & (1 << 23));
+    const bool v3 = v2 && (xcr0 & 0x6) == 0x6 && (leaf1[2] & (1 << 12)) && (leaf7[1] & (1 << 3))
+        && (leaf7[1] & (1 << 5)) && (leaf7[1] & (1 << 8));
+    const bool v4 = v3 && (xcr0 & 0xe6) == 0xe6 && (leaf7[1] & (1 << 16)) && (leaf7[1] & (1 << 17))
+        && (leaf7[1] & (1 << 28)) && (leaf7[1] & (1 << 30)) && (leaf7[1] & (1 << 31));
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    const bool v2 = __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+    const bool v3 = v2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi")
+        && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("fma");
+    const bool v4 = v3 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+        && __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512dq")
+        && __builtin_cpu_supports("avx512vl");
+#else
+    const bool v2 = false;
+    const bool v3 = false;
+    const bool v4 = false;
+#endif
+
+    return v4 ? 3 : v3 ? 2 : v2 ? 1 : 0;
+}}
+
+}}
+
+int {0}_isa::level() noexcept
+{{
+    static const int detected = detect();
+    return detected;
+}}
+)",
+        prefix);
+}
+
 }
 
 CmakeLib::CmakeLib(LibDesc desc)
@@ -26,7 +129,24 @@ CmakeLib::CmakeLib(LibDesc desc)
     , mSources(to_strings(desc.sources))
     , mDeps(desc.deps)
     , mDefinitions(std::move(desc.definitions))
+    , mProfileTarget(std::move(desc.profile_target))
+    , mMultiversionSources(to_strings(desc.multiversion_sources))
 {
+    if (desc.imported_archive) {
+        mImportedArchive = desc.imported_archive->generic_string();
+    }
+
+    for (const auto& source : mMultiversionSources) {
+        mSources.erase(source);
+    }
+    if (!mMultiversionSources.empty()) {
+        mSources.insert(fmt::format("{}/{}_isa.cpp", kIsaDir, isa_prefix(mName)));
+    }
+}
+
+std::string cmake::isa_prefix(std::string_view lib_name)
+{
+    return boost::replace_all_copy(std::string { lib_name }, "-", "_");
 }
 
 void CmakeLib::build(std::ostream& out) const
@@ -36,6 +156,11 @@ void CmakeLib::build(std::ostream& out) const
     out << "\n# LIB\n";
     if (is_interface()) {
         out << fmt::format("add_library({} INTERFACE)\n", lib_name);
+    } else if (is_imported()) {
+        out << fmt::format("add_library({} STATIC IMPORTED GLOBAL)\n", lib_name);
+        out << fmt::format(
+            R"(set_target_properties({} PROPERTIES IMPORTED_LOCATION "{}"))", lib_name, *mImportedArchive)
+            << '\n';
     } else {
         out << fmt::format("add_library({} {})\n", lib_name, boost::join(mSources, "\n"));
     }
@@ -44,7 +169,8 @@ void CmakeLib::build(std::ostream& out) const
         out << fmt::format(R"(set_target_properties({} PROPERTIES OUTPUT_NAME "{}"))", lib_name, *mNameAlias) << '\n';
     }
 
-    const std::string_view lib_type = is_interface() ? "INTERFACE" : "PUBLIC";
+    // usage requirements of imported targets can only be INTERFACE
+    const std::string_view lib_type = is_interface() || is_imported() ? "INTERFACE" : "PUBLIC";
     if (!mIncludes.empty()) {
         out << "\n";
 
@@ -63,4 +189,78 @@ void CmakeLib::build(std::ostream& out) const
     if (const auto& defs = mDefinitions; !defs.empty()) {
         out << fmt::format("\ntarget_compile_definitions({} {} {})\n", lib_name, lib_type, boost::join(defs, " "));
     }
+
+    // nothing is compiled for the other kinds
+    if (mProfileTarget && !is_interface() && !is_imported()) {
+        out << fmt::format("target_link_libraries({} PRIVATE {})\n", lib_name, *mProfileTarget);
+    }
+
+    if (!mMultiversionSources.empty()) {
+        build_isa_variants_(out);
+    }
+}
+
+void CmakeLib::build_isa_variants_(std::ostream& out) const
+{
+    const auto lib_name = target();
+    const auto prefix = isa_prefix(mName);
+    const std::string_view lib_type = is_imported() ? "INTERFACE" : "PUBLIC";
+
+    // file(GENERATE) leaves unchanged files alone, so dependents are not rebuilt on each configure
+    out << "\n# ISA variants\n"
+        << fmt::format("file(GENERATE OUTPUT {}/{}_isa.h CONTENT [=[{}]=])\n", kIsaDir, prefix, isa_header(prefix))
+        << fmt::format("target_include_directories({} {} {})\n", lib_name, lib_type, kIsaDir);
+
+    // the archive has the variants already
+    if (is_imported()) {
+        return;
+    }
+
+    out << fmt::format("file(GENERATE OUTPUT {}/{}_isa.cpp CONTENT [=[{}]=])\n", kIsaDir, prefix, isa_source(prefix))
+        << fmt::format("set_source_files_properties({}/{}_isa.cpp PROPERTIES GENERATED TRUE)\n", kIsaDir, prefix);
+
+    for (const auto& level : kIsaLevels) {
+        const auto variant = fmt::format("{}_isa_{}", lib_name, level.suffix);
+
+        out << '\n'
+            << fmt::format("add_library({} OBJECT {})\n", variant, boost::join(mMultiversionSources, "\n"))
+            << fmt::format(
+                   "target_include_directories({} PRIVATE {} {})\n", variant, kIsaDir, boost::join(mIncludes, " "))
+            << fmt::format("target_compile_definitions({} PRIVATE CPPSHIP_ISA_NS={}_isa_{} {})\n",
+                   variant,
+                   prefix,
+                   level.suffix,
+                   boost::join(mDefinitions, " "))
+            << "if(BUILD_SHARED_LIBS)\n"
+            << fmt::format("    set_target_properties({} PROPERTIES POSITION_INDEPENDENT_CODE ON)\n", variant)
+            << "endif()\n";
+        for (const auto& dep : mDeps) {
+            out << fmt::format(
+                "target_link_libraries({} PRIVATE {})\n", variant, boost::join(dep.cmake_targets, " "));
+        }
+        // profile flags without its -march or /arch, they come after the variant ones and would win otherwise.
+        // objects are not linked, so compile options and definitions are all it needs
+        if (mProfileTarget) {
+            out << fmt::format("target_compile_options({} PRIVATE $<FILTER:$<TARGET_PROPERTY:{},"
+                               "INTERFACE_COMPILE_OPTIONS>,EXCLUDE,^(-march=|/arch:)>)\n",
+                       variant,
+                       *mProfileTarget)
+                << fmt::format("target_compile_definitions({} PRIVATE $<TARGET_PROPERTY:{},"
+                               "INTERFACE_COMPILE_DEFINITIONS>)\n",
+                       variant,
+                       *mProfileTarget);
+        }
+
+        // other cpus build all variants the same
+        out << R"(if(CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64)$"))" << '\n'
+            << fmt::format("    target_compile_options({} PRIVATE $<$<NOT:$<CXX_COMPILER_ID:MSVC>>:-march={}>)\n",
+                   variant,
+                   level.march);
+        if (!level.msvc_arch.empty()) {
+            out << fmt::format(
+                "    target_compile_options({} PRIVATE $<$<CXX_COMPILER_ID:MSVC>:{}>)\n", variant, level.msvc_arch);
+        }
+        out << "endif()\n"
+            << fmt::format("target_sources({} PRIVATE $<TARGET_OBJECTS:{}>)\n", lib_name, variant);
+    }
 }
\ No newline at end of file
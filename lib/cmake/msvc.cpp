@@ -9,7 +9,7 @@ fs::path msvc::fix_bin_path(const cppship::cmd::BuildContext& ctx, std::string_v
 {
     const auto profile = read_as_string(ctx.conan_profile_path);
     if (boost::contains(profile, "compiler=msvc")) {
-        return fs::path(ctx.profile) / bin;
+        return fs::path(ctx.build_type) / bin;
     }
 
     return bin;
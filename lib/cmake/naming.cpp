@@ -11,3 +11,5 @@ std::string NameTargetMapper::test(std::string_view name) { return fmt::format("
 std::string NameTargetMapper::example(std::string_view name) { return fmt::format("{}_{}_example", mPackage, name); }
 
 std::string NameTargetMapper::bench(std::string_view name) { return fmt::format("{}_{}_bench", mPackage, name); }
+
+std::string NameTargetMapper::profile() { return fmt::format("{}_profile", mPackage); }
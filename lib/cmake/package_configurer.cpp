@@ -1,20 +1,154 @@
 #include "cppship/cmake/package_configurer.h"
 
+#include <map>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
 #include <fmt/core.h>
 #include <fmt/format.h>
 
 #include "cppship/cmake/lib.h"
+#include "cppship/cmake/naming.h"
 #include "cppship/core/layout.h"
 #include "cppship/core/manifest.h"
+#include "cppship/exception.h"
+#include "cppship/util/hash.h"
 #include "cppship/util/io.h"
+#include "cppship/util/log.h"
 #include "cppship/util/repo.h"
 
 using namespace cppship;
 using namespace fmt::literals;
 
-void cmake::config_packages(
+std::string cmake::package_internals::prebuilt_archive_name(std::string_view lib_target)
+{
+#ifdef _WIN32
+    return fmt::format("{}.lib", lib_target);
+#else
+    return fmt::format("lib{}.a", lib_target);
+#endif
+}
+
+namespace {
+
+// bump it when the generated lib config changes
+constexpr std::string_view kPrebuiltVersion = "1";
+// under out_dir, archives imported from the cache
+constexpr std::string_view kPrebuiltDir = "prebuilt";
+
+class PrebuiltKeys {
+public:
+    PrebuiltKeys(const fs::path& deps_dir, const cmake::PrebuiltOptions& options)
+        : mDepsDir(deps_dir)
+        , mOptions(&options)
+    {
+    }
+
+    // a dep is rebuilt if itself, any of its transitive deps or the toolchain changes.
+    // nullopt if any of them is not locked, such a dep is always built from sources
+    const std::optional<std::string>& get(const std::string& package)
+    {
+        if (const auto it = mKeys.find(package); it != mKeys.end()) {
+            return it->second;
+        }
+
+        return mKeys.emplace(package, compute_(package)).first->second;
+    }
+
+private:
+    std::optional<std::string> compute_(const std::string& package)
+    {
+        const auto* locked = locked_(package);
+        if (locked == nullptr) {
+            return std::nullopt;
+        }
+
+        util::Hasher hasher;
+        hasher.update(kPrebuiltVersion).update("\n").update(mOptions->toolchain).update("\n");
+        hasher.update(package).update("=").update(*locked).update("\n");
+
+        const auto manifest_file = mDepsDir / package / kRepoConfigFile;
+        if (!fs::exists(manifest_file)) {
+            return hasher.hex();
+        }
+
+        const Manifest manifest(manifest_file);
+        for (const auto& dep : manifest.dependencies()) {
+            std::optional<std::string> dep_key;
+            if (dep.is_git()) {
+                dep_key = get(dep.package);
+            } else if (const auto* version = locked_(dep.package)) {
+                dep_key = *version;
+            }
+
+            if (!dep_key) {
+                return std::nullopt;
+            }
+
+            hasher.update(dep.package).update("=").update(*dep_key).update("\n");
+        }
+
+        return hasher.hex();
+    }
+
+    const std::string* locked_(std::string_view package) const
+    {
+        const auto it = mOptions->locked.find(package);
+        return it == mOptions->locked.end() ? nullptr : &it->second;
+    }
+
+private:
+    fs::path mDepsDir;
+    const cmake::PrebuiltOptions* mOptions;
+    std::map<std::string, std::optional<std::string>> mKeys;
+};
+
+// copy the lib into cache once it is built, rename makes concurrent builds of other projects safe
+void emit_prebuilt_export(std::ostream& out, std::string_view lib_target, const fs::path& archive)
+{
+    out << fmt::format(R"(
+# export the lib to cppship prebuilt cache
+get_target_property(_cppship_lib_type {lib} TYPE)
+if(_cppship_lib_type STREQUAL "STATIC_LIBRARY")
+    string(MD5 _cppship_build_id "${{CMAKE_BINARY_DIR}}")
+    add_custom_command(TARGET {lib} POST_BUILD
+        COMMAND ${{CMAKE_COMMAND}} -E make_directory "{dir}"
+        COMMAND ${{CMAKE_COMMAND}} -E copy "$<TARGET_FILE:{lib}>" "{archive}.${{_cppship_build_id}}"
+        COMMAND ${{CMAKE_COMMAND}} -E rename "{archive}.${{_cppship_build_id}}" "{archive}"
+        VERBATIM)
+endif()
+)",
+        "lib"_a = lib_target,
+        "dir"_a = archive.parent_path().generic_string(),
+        "archive"_a = archive.generic_string());
+}
+
+// the cache may be cleaned any time, the build links a hard link or a copy of the archive kept in the build dir
+bool import_prebuilt(const fs::path& archive, const fs::path& imported)
+{
+    std::error_code ec;
+    fs::create_directories(imported.parent_path(), ec);
+    fs::remove(imported, ec);
+    fs::create_hard_link(archive, imported, ec);
+    if (ec) {
+        fs::copy_file(archive, imported, fs::copy_options::overwrite_existing, ec);
+    }
+
+    return !ec;
+}
+
+}
+
+cmake::ConfigResult cmake::config_packages(
     const ResolvedDependencies& cppship_deps, const ResolvedDependencies& all_deps, const ConfigOptions& options)
 {
+    ConfigResult result;
+    std::optional<PrebuiltKeys> prebuilt_keys;
+    if (options.prebuilt) {
+        prebuilt_keys.emplace(options.deps_dir, *options.prebuilt);
+    }
+
     for (const auto& dep : cppship_deps) {
         const auto& package = dep.package;
         const auto& cmake_target = dep.cmake_target;
@@ -42,21 +176,51 @@ target_include_directories({target} INTERFACE {cmake_deps_dir}/{package}/include
         }
 
         Layout layout(package_dir, package);
-        const auto lib_target = layout.lib();
+        const auto& lib_target = layout.lib();
         if (!lib_target.has_value()) {
             throw Error { fmt::format("package {} have no lib target", package) };
         }
+
+        std::optional<fs::path> prebuilt_archive;
+        bool prebuilt_hit = false;
+        if (prebuilt_keys && !lib_target->sources.empty()) {
+            if (const auto& key = prebuilt_keys->get(package)) {
+                prebuilt_archive = options.prebuilt->cache_dir / package / *key
+                    / package_internals::prebuilt_archive_name(fmt::format("{}_lib", lib_target->name));
+
+                const auto* remote = options.prebuilt->remote;
+                prebuilt_hit = fs::exists(*prebuilt_archive)
+                    || (remote != nullptr && remote->get_file(kRemotePrebuilt, *key, *prebuilt_archive));
+            }
+        }
+
+        const auto imported_archive = prebuilt_archive
+            ? options.out_dir / kPrebuiltDir / package / prebuilt_archive->filename()
+            : fs::path {};
+        prebuilt_hit = prebuilt_hit && import_prebuilt(*prebuilt_archive, imported_archive);
+        if (prebuilt_hit) {
+            status("dependency", "use prebuilt {}", package);
+            ++result.prebuilt_hits;
+        }
+
         const auto cmake_deps = cmake::resolve_deps(manifest.dependencies(), all_deps);
         cmake::CmakeLib lib({
             .name = lib_target->name,
             .include_dirs = lib_target->includes,
-            .sources = lib_target->sources,
+            .sources = prebuilt_hit ? PathSet {} : lib_target->sources,
             .deps = cmake_deps,
+            .profile_target = std::string { kCppshipDepsProfile },
+            .imported_archive = prebuilt_hit ? std::make_optional(imported_archive) : std::nullopt,
         });
 
         std::ostringstream out;
         lib.build(out);
 
+        if (prebuilt_archive && !prebuilt_hit) {
+            emit_prebuilt_export(out, lib.target(), *prebuilt_archive);
+            result.missed_archives.push_back(*prebuilt_archive);
+        }
+
         out << fmt::format("\nadd_library({} ALIAS {})\n", cmake_target, lib.target());
 
         auto content = out.str();
@@ -66,4 +230,6 @@ target_include_directories({target} INTERFACE {cmake_deps_dir}/{package}/include
 
         write(package_cmake_config_file, content);
     }
+
+    return result;
 }
@@ -37,7 +37,7 @@ int cmd::run_bench(const BenchOptions& options)
     BuildOptions build_options { .profile = options.profile };
     if (options.name) {
         const auto layouts = ctx.workspace.layouts()
-            | filter([&](const Layout& layout) { return layout.bench(*options.name).has_value(); })
+            | filter([&](const Layout& layout) { return layout.bench(*options.name) != nullptr; })
             | ranges::to<std::vector>();
         if (layouts.empty()) {
             throw Error { fmt::format("bench `{}` not found", *options.name) };
@@ -55,7 +55,7 @@ int cmd::run_bench(const BenchOptions& options)
         build_options.groups.insert(BuildGroup::benches);
     }
 
-    int result = run_build(build_options);
+    int result = run_build(ctx, build_options);
     if (result != 0) {
         return EXIT_FAILURE;
     }
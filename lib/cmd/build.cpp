@@ -1,12 +1,24 @@
 #include "cppship/cmd/build.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
 #include <optional>
+#include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include <BS_thread_pool_light.hpp>
 #include <boost/algorithm/string/find.hpp>
+#include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <fmt/format.h>
@@ -14,6 +26,7 @@
 #include <range/v3/algorithm.hpp>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/concat.hpp>
+#include <range/v3/view/drop.hpp>
 #include <range/v3/view/filter.hpp>
 #include <range/v3/view/map.hpp>
 #include <range/v3/view/transform.hpp>
@@ -22,13 +35,18 @@
 #include <toml/get.hpp>
 #include <toml/value.hpp>
 
+#include "cppship/cmake/cfg_predicate.h"
+#include "cppship/cmake/compile_db.h"
 #include "cppship/cmake/dependency_injector.h"
 #include "cppship/cmake/generator.h"
 #include "cppship/cmake/group.h"
 #include "cppship/cmake/package_configurer.h"
+#include "cppship/core/build_history.h"
 #include "cppship/core/compiler.h"
 #include "cppship/core/dependency.h"
+#include "cppship/core/dist.h"
 #include "cppship/core/layout.h"
+#include "cppship/core/remote_cache.h"
 #include "cppship/core/resolver.h"
 #include "cppship/exception.h"
 #include "cppship/util/assert.h"
@@ -36,6 +54,7 @@
 #include "cppship/util/cmd_runner.h"
 #include "cppship/util/fs.h"
 #include "cppship/util/git.h"
+#include "cppship/util/hash.h"
 #include "cppship/util/io.h"
 #include "cppship/util/log.h"
 
@@ -76,20 +95,172 @@ std::optional<std::string> cmd::BuildContext::get_active_package() const
     return p != nullptr ? std::make_optional<std::string>(p->name()) : std::nullopt;
 }
 
+namespace {
+
+// paths in the nul separated output of git -z, relative to the root
+void insert_git_paths(std::set<fs::path>& files, const fs::path& root, std::string_view out)
+{
+    for (std::size_t pos = 0; pos < out.size();) {
+        const auto end = std::min(out.find('\0', pos), out.size());
+        if (end > pos) {
+            files.insert(root / out.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+}
+
+// run fn on each context concurrently, the first error is rethrown after all are done
+template <class Fn>
+std::vector<int> run_concurrently(const std::vector<std::unique_ptr<cmd::BuildContext>>& contexts, const Fn& fn)
+{
+    BS::thread_pool_light pool(gsl::narrow_cast<BS::concurrency_t>(contexts.size()));
+    std::vector<std::future<int>> tasks;
+    tasks.reserve(contexts.size());
+    for (std::size_t i = 0; i < contexts.size(); ++i) {
+        tasks.push_back(pool.submit([&fn, &contexts, i] { return fn(*contexts[i], i); }));
+    }
+
+    pool.wait_for_tasks();
+
+    std::vector<int> results;
+    for (auto& task : tasks) {
+        results.push_back(task.get());
+    }
+
+    return results;
+}
+
+// run a stage of the build, its duration goes to the build record
+template <class Fn> auto timed(const cmd::BuildContext& ctx, std::string_view stage, const Fn& fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto record_stage = gsl::finally([&] {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        ctx.build_record().stages.push_back({
+            .name = std::string { stage },
+            .ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(),
+        });
+    });
+
+    return fn();
+}
+
+void start_record(const cmd::BuildContext& ctx)
+{
+    using namespace std::chrono;
+
+    auto& record = ctx.build_record();
+    record.time = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+    record.profile = ctx.profile;
+    if (fs::exists(ctx.root / ".git")) {
+        try {
+            record.commit = boost::trim_copy(check_output("git rev-parse --short HEAD"));
+        } catch (const RunCmdFailed&) {
+            debug("no commit yet, build recorded without commit");
+        }
+    }
+}
+
+// called on the way out of a build, so failures are recorded too
+void finish_record(const cmd::BuildContext& ctx, int result) noexcept
+{
+    try {
+        auto& record = ctx.build_record();
+        record.result = result;
+        append_build_record(ctx.history_file, record);
+    } catch (const std::exception& e) {
+        warn("record build failed: {}", e.what());
+    }
+}
+
+int run_profiles_build(const cmd::BuildOptions& options)
+{
+    using namespace cmd;
+
+    std::vector<std::unique_ptr<BuildContext>> contexts;
+    contexts.push_back(std::make_unique<BuildContext>(options.profiles.front()));
+    for (const auto profile : options.profiles | rng::drop(1)) {
+        contexts.push_back(std::make_unique<BuildContext>(profile, *contexts.front()));
+    }
+
+    ScopedCurrentDir guard(contexts.front()->root);
+    for (const auto& ctx : contexts) {
+        start_record(*ctx);
+    }
+
+    // profiles not built count as failed, eg. conan install throws
+    std::vector<int> results(contexts.size(), EXIT_FAILURE);
+    auto record = gsl::finally([&] {
+        // appended one by one, records of profiles never interleave
+        for (std::size_t i = 0; i < contexts.size(); ++i) {
+            finish_record(*contexts[i], results[i]);
+        }
+    });
+
+    // dependencies are resolved once for all profiles
+    timed(*contexts.front(), "conan_setup", [&] { conan_setup(*contexts.front()); });
+
+    // conan does not support concurrent access to its cache, nor do lockfile updates
+    for (const auto& ctx : contexts) {
+        timed(*ctx, "conan_detect_profile", [&] { conan_detect_profile(*ctx); });
+        timed(*ctx, "conan_install", [&] { conan_install(*ctx); });
+    }
+
+    results = cmd_internals::build_profiles(contexts, options);
+    const auto failed = ranges::find_if(results, [](int res) { return res != 0; });
+    return failed == results.end() ? 0 : *failed;
+}
+
+}
+
+std::vector<int> cmd::cmd_internals::build_profiles(const std::vector<std::unique_ptr<BuildContext>>& contexts,
+    const BuildOptions& options, const util::CmdRunner& runner)
+{
+    run_concurrently(contexts, [&runner](const BuildContext& ctx, std::size_t) {
+        timed(ctx, "cmake_setup", [&] { cmake_setup(ctx, runner); });
+        return 0;
+    });
+
+    // profiles share the job budget
+    const int jobs = std::max(1, options.max_concurrency / gsl::narrow_cast<int>(contexts.size()));
+    return run_concurrently(contexts, [&options, &runner, jobs](const BuildContext& ctx, std::size_t i) {
+        auto profile_options = options;
+        profile_options.profile = options.profiles[i];
+        profile_options.max_concurrency = jobs;
+        return timed(ctx, "cmake_build", [&] { return cmake_build(ctx, profile_options, runner); });
+    });
+}
+
 int cmd::run_build(const BuildOptions& options)
 {
-    BuildContext ctx(options.profile);
-    ScopedCurrentDir guard(ctx.root);
-    conan_detect_profile(ctx);
-    conan_setup(ctx);
-    conan_install(ctx);
-    cmake_setup(ctx);
+    // compile_commands.json is one of the project, a dry run of several profiles writes it for the first one
+    if (options.profiles.size() > 1 && !options.dry_run) {
+        return run_profiles_build(options);
+    }
+
+    const BuildContext ctx(options.profiles.empty() ? options.profile : options.profiles.front());
+    return run_build(ctx, options);
+}
 
+int cmd::run_build(const BuildContext& ctx, const BuildOptions& options)
+{
+    ScopedCurrentDir guard(ctx.root);
     if (options.dry_run) {
+        compile_db_setup(ctx);
         return 0;
     }
 
-    return cmake_build(ctx, options);
+    start_record(ctx);
+    int res = EXIT_FAILURE;
+    auto record = gsl::finally([&] { finish_record(ctx, res); });
+
+    timed(ctx, "conan_detect_profile", [&] { conan_detect_profile(ctx); });
+    timed(ctx, "conan_setup", [&] { conan_setup(ctx); });
+    timed(ctx, "conan_install", [&] { conan_install(ctx); });
+    timed(ctx, "cmake_setup", [&] { cmake_setup(ctx); });
+
+    res = timed(ctx, "cmake_build", [&] { return cmake_build(ctx, options); });
+    return res;
 }
 
 void cmd::conan_detect_profile(const BuildContext& ctx)
@@ -129,7 +300,7 @@ void cmd::conan_detect_profile(const BuildContext& ctx)
     bool compiler_detected = false;
     while (std::getline(ifs, line)) {
         if (line.starts_with("build_type")) {
-            line = fmt::format("build_type={}", ctx.profile);
+            line = fmt::format("build_type={}", ctx.build_type);
         } else if (line.starts_with("compiler.cppstd")) {
             line = fmt::format("compiler.cppstd=20");
         } else if (line.starts_with("compiler=")) {
@@ -168,16 +339,163 @@ void cmd::conan_detect_profile(const BuildContext& ctx)
     }
 }
 
+namespace {
+
+// git deps of a lockfile are not resolved again, but they may be absent, eg. a fresh clone
+void fetch_locked_dependencies(const cmd::BuildContext& ctx, const ResolveResult& result)
+{
+    const auto git_deps = rng::concat(result.dependencies, result.dev_dependencies)
+        | rng::filter([](const DeclaredDependency& dep) { return dep.is_git(); }) | ranges::to<std::vector>();
+    if (git_deps.empty()) {
+        return;
+    }
+
+    create_if_not_exist(ctx.deps_dir);
+    fetch_git_dependencies(ctx.deps_dir, git_deps, &util::git_clone);
+    for (const auto& dep : git_deps) {
+        touch(git_dependency_footprint(ctx.deps_dir, dep));
+    }
+}
+
+// conan.lock is kept, so unchanged conan deps stay pinned. entries of changed ones are dropped and locked again by the
+// partial install
+void unlock_changed_conan_packages(const cmd::BuildContext& ctx, const ResolveResult& result)
+{
+    if (!fs::exists(ctx.conan_lock_file)) {
+        return;
+    }
+
+    const auto changed = changed_conan_packages(ctx.lock_file, result);
+    if (!changed) {
+        // stale entries cannot be told apart, let conan lock all of them again
+        fs::remove(ctx.conan_lock_file);
+        return;
+    }
+    if (changed->empty()) {
+        return;
+    }
+
+    std::string patterns;
+    for (const auto& package : *changed) {
+        patterns += fmt::format(R"( --requires="{0}/*" --build-requires="{0}/*")", package);
+    }
+
+    status("dependency", "unlock {}", boost::join(*changed, ", "));
+    const auto cmd = fmt::format("conan lock remove{0} --lockfile={1} --lockfile-out={1}",
+        patterns,
+        ctx.conan_lock_file.string());
+    if (run_cmd(cmd) != 0) {
+        warn("unlock changed conan dependencies failed, lock all of them again");
+        fs::remove(ctx.conan_lock_file);
+    }
+}
+
+ResolveResult resolve_or_load_lockfile(const cmd::BuildContext& ctx)
+{
+    const auto fingerprint = dependency_fingerprint(ctx.manifest);
+    if (auto locked = load_lockfile(ctx.lock_file, fingerprint)) {
+        status("dependency", "load dependencies from {}", kLockFile);
+        fetch_locked_dependencies(ctx, *locked);
+        return std::move(locked).value();
+    }
+
+    status("dependency", "start resolving");
+    Resolver resolver(ctx.deps_dir, ctx.manifest, &util::git_clone, &ctx.dependency_graph());
+    auto result = std::move(resolver).resolve();
+
+    unlock_changed_conan_packages(ctx, result);
+    save_lockfile(ctx.lock_file, fingerprint, result);
+
+    return result;
+}
+
+}
+
+const ResolveResult& cmd::BuildContext::resolved() const
+{
+    std::lock_guard lock(mSession->mutex);
+    if (!mSession->resolved) {
+        mSession->resolved = resolve_or_load_lockfile(*this);
+    }
+
+    return *mSession->resolved;
+}
+
+DependencyGraph& cmd::BuildContext::dependency_graph() const
+{
+    std::lock_guard lock(mSession->mutex);
+    if (!mSession->dependency_graph) {
+        mSession->dependency_graph = std::make_unique<DependencyGraph>(deps_dir);
+    }
+
+    return *mSession->dependency_graph;
+}
+
+const ResolvedDependencies& cmd::BuildContext::git_dependencies() const
+{
+    std::lock_guard lock(mSession->mutex);
+    if (mSession->resolved) {
+        return mSession->resolved->resolved_dependencies;
+    }
+    if (!mSession->git_dependencies) {
+        mSession->git_dependencies = toml::get<ResolvedDependencies>(toml::parse(git_dep_file));
+    }
+
+    return *mSession->git_dependencies;
+}
+
+const ResolvedDependencies& cmd::BuildContext::dependencies() const
+{
+    if (!mDependencies) {
+        mDependencies = toml::get<ResolvedDependencies>(toml::parse(dependency_file));
+    }
+
+    return *mDependencies;
+}
+
+void cmd::BuildContext::save_dependencies(ResolvedDependencies deps) const
+{
+    write(dependency_file, toml::format(deps.to_toml()));
+    mDependencies = std::move(deps);
+}
+
+const toml::value& cmd::BuildContext::inventory() const
+{
+    if (!mInventory) {
+        mInventory = fs::exists(inventory_file) ? toml::parse(inventory_file) : toml::value(toml::table {});
+    }
+
+    return *mInventory;
+}
+
+void cmd::BuildContext::save_inventory(toml::value inventory) const
+{
+    write(inventory_file, toml::format(inventory));
+    mInventory = std::move(inventory);
+}
+
+const std::set<std::string>& cmd::BuildContext::affected_packages(std::string_view rev) const
+{
+    std::lock_guard lock(mSession->mutex);
+    auto& affected = mSession->affected_packages;
+    if (const auto it = affected.find(rev); it != affected.end()) {
+        return it->second;
+    }
+
+    return affected.emplace(rev, list_affected_packages(*this, rev)).first->second;
+}
+
 void cmd::conan_setup(const BuildContext& ctx)
 {
-    if (!ctx.is_expired(ctx.conan_file)) {
+    // a pulled lockfile may lock other deps while manifests are not touched
+    const bool lock_updated = fs::exists(ctx.conan_file) && fs::exists(ctx.lock_file)
+        && fs::last_write_time(ctx.conan_file) < fs::last_write_time(ctx.lock_file);
+    if (!ctx.is_expired(ctx.conan_file) && !lock_updated) {
         debug("conanfile is up to date");
         return;
     }
 
-    status("dependency", "start resolving");
-    Resolver resolver(ctx.deps_dir, ctx.manifest, &util::git_clone);
-    const auto result = std::move(resolver).resolve();
+    const auto& result = ctx.resolved();
 
     status("dependency", "generate conanfile");
     std::ostringstream oss;
@@ -217,15 +535,22 @@ void cmd::conan_setup(const BuildContext& ctx)
 
 void cmd::conan_install(const BuildContext& ctx)
 {
-    if (!ctx.is_expired(ctx.dependency_file)) {
+    // deps config dir is absent in build dirs of older versions, conan output may be removed by hand
+    const bool installed = fs::exists(ctx.deps_config_dir) && fs::exists(ctx.profile_dir / "conan");
+    if (!ctx.is_expired(ctx.dependency_file) && installed) {
         debug("dependency is up to date");
         return;
     }
 
-    const auto cmd = fmt::format("conan install {} -of {}/conan -pr {} --build=missing",
+    // conan.lock pins conan deps the same as cppship.lock pins git deps, partial since profiles may differ in deps
+    const auto lock_args = fs::exists(ctx.conan_lock_file)
+        ? fmt::format("--lockfile={0} --lockfile-partial --lockfile-out={0}", ctx.conan_lock_file.string())
+        : fmt::format("--lockfile-out={}", ctx.conan_lock_file.string());
+    const auto cmd = fmt::format("conan install {} -of {}/conan -pr {} --build=missing {}",
         ctx.build_dir.string(),
         ctx.profile_dir.string(),
-        ctx.conan_profile_path.string());
+        ctx.conan_profile_path.string(),
+        lock_args);
 
     status("dependency", "install dependencies: {}", cmd);
     int res = run_cmd(cmd);
@@ -233,24 +558,186 @@ void cmd::conan_install(const BuildContext& ctx)
         throw Error { "conan install failed" };
     }
 
-    auto deps = collect_conan_deps(ctx.profile_dir / "conan", ctx.profile);
-    auto cppship_deps = toml::get<ResolvedDependencies>(toml::parse(ctx.git_dep_file));
+    auto deps = collect_conan_deps(ctx.profile_dir / "conan", ctx.build_type);
+    const auto& cppship_deps = ctx.git_dependencies();
 
     for (const auto& dep : cppship_deps) {
         deps.insert(dep);
     }
 
+    create_if_not_exist(ctx.deps_config_dir);
     if (!cppship_deps.empty()) {
         cppship_install(ctx, cppship_deps, deps);
     }
 
-    write(ctx.dependency_file, toml::format(deps.to_toml()));
+    ctx.save_dependencies(std::move(deps));
+}
+
+namespace {
+
+// flags of the consuming package apply to its deps too, link flags are left out since libs are not linked
+void hash_profile(util::Hasher& hasher, const ProfileConfig& config)
+{
+    for (const auto& flag : config.cxxflags) {
+        hasher.update("cxxflag=").update(flag).update("\n");
+    }
+    for (const auto& def : config.definitions) {
+        hasher.update("definition=").update(def).update("\n");
+    }
+
+    hasher.update(fmt::format("sanitizers={}{}{}{}\n",
+        config.ubsan.value_or(false),
+        config.tsan.value_or(false),
+        config.asan.value_or(false),
+        config.leak.value_or(false)));
+}
+
+void hash_profile(util::Hasher& hasher, const ProfileOptions& options)
+{
+    hash_profile(hasher, options.config);
+
+    for (const auto& [condition, config] : options.conditional_configs) {
+        hasher.update("if=").update(cmake::generate_predicate(condition)).update("\n");
+        hash_profile(hasher, config);
+    }
+}
+
+std::string toolchain_fingerprint(const cmd::BuildContext& ctx)
+{
+    util::Hasher hasher;
+    // conan profile covers os, arch, compiler, its version, libcxx and build type
+    hasher.update(read_as_string(ctx.conan_profile_path));
+    if (const char* cxx = std::getenv("CXX")) {
+        hasher.update("cxx=").update(cxx).update("\n");
+    }
+
+    const auto profiles = ctx.manifest.profile_chain(parse_profile(ctx.profile));
+    auto hash_package = [&](const PackageManifest& manifest) {
+        hasher.update(fmt::format("std={}\n", static_cast<int>(manifest.cxx_std())));
+        hash_profile(hasher, manifest.default_profile());
+        for (const auto& profile : profiles) {
+            hash_profile(hasher, manifest.profile(profile));
+        }
+    };
+
+    if (const auto* package = ctx.manifest.get_if_package()) {
+        hash_package(*package);
+    } else {
+        for (const auto& [_, package] : ctx.manifest.list_packages()) {
+            hash_package(package);
+        }
+    }
+
+    return hasher.hex();
+}
+
+std::string locked_desc(const DeclaredDependency& dep)
+{
+    if (const auto* git = std::get_if<GitDep>(&dep.desc)) {
+        return fmt::format("{}@{}", git->git, git->commit);
+    }
+
+    const auto& conan = std::get<ConanDep>(dep.desc);
+    const std::map<std::string, std::string> options(conan.options.begin(), conan.options.end());
+
+    std::string desc = conan.version;
+    for (const auto& [key, val] : options) {
+        desc += fmt::format(",{}={}", key, val);
+    }
+
+    return desc;
+}
+
+std::optional<cmake::PrebuiltOptions> prebuilt_options(const cmd::BuildContext& ctx)
+{
+    const auto locked = load_lockfile(ctx.lock_file, dependency_fingerprint(ctx.manifest));
+    if (!locked) {
+        debug("no lockfile, prebuilt cache is disabled");
+        return std::nullopt;
+    }
+
+    cmake::PrebuiltOptions options {
+        .cache_dir = get_cache_dir() / "prebuilt",
+        .toolchain = toolchain_fingerprint(ctx),
+        .remote = get_remote_cache(),
+    };
+    for (const auto& dep : rng::concat(locked->dependencies, locked->dev_dependencies)) {
+        options.locked.emplace(dep.package, locked_desc(dep));
+    }
+
+    return options;
+}
+
+std::set<std::string> load_prebuilt_uploads(const cmd::BuildContext& ctx)
+{
+    if (!fs::exists(ctx.prebuilt_upload_file)) {
+        return {};
+    }
+
+    const auto archives
+        = toml::find_or<std::vector<std::string>>(toml::parse(ctx.prebuilt_upload_file), "archives", {});
+    return { archives.begin(), archives.end() };
+}
+
+void save_prebuilt_uploads(const cmd::BuildContext& ctx, const std::set<std::string>& archives)
+{
+    const toml::value value { { "archives", std::vector<std::string>(archives.begin(), archives.end()) } };
+    write(ctx.prebuilt_upload_file, toml::format(value));
+}
+
+// archives missed in both caches are uploaded after they are built
+void upload_prebuilt(const cmd::BuildContext& ctx)
+{
+    auto* remote = get_remote_cache();
+    if (remote == nullptr) {
+        return;
+    }
+
+    auto archives = load_prebuilt_uploads(ctx);
+    if (archives.empty()) {
+        return;
+    }
+
+    for (auto it = archives.begin(); it != archives.end();) {
+        const fs::path archive = *it;
+        if (!fs::exists(archive)) {
+            ++it;
+            continue;
+        }
+
+        status("cache", "upload {}", archive.filename().string());
+        remote->put_file_async(std::string { kRemotePrebuilt }, archive.parent_path().filename().string(), archive);
+        it = archives.erase(it);
+    }
+
+    save_prebuilt_uploads(ctx, archives);
+}
+
 }
 
 void cmd::cppship_install(
     const BuildContext& ctx, const ResolvedDependencies& cppship_deps, const ResolvedDependencies& all_deps)
 {
-    cmake::config_packages(cppship_deps, all_deps, { .deps_dir = ctx.deps_dir });
+    const auto result = cmake::config_packages(cppship_deps,
+        all_deps,
+        {
+            .deps_dir = ctx.deps_dir,
+            .out_dir = ctx.deps_config_dir,
+            .prebuilt = prebuilt_options(ctx),
+        });
+
+    auto& record = ctx.build_record();
+    record.prebuilt_hits = result.prebuilt_hits;
+    record.prebuilt_misses = result.missed_archives.size();
+
+    if (get_remote_cache() != nullptr && !result.missed_archives.empty()) {
+        auto archives = load_prebuilt_uploads(ctx);
+        for (const auto& archive : result.missed_archives) {
+            archives.insert(archive.string());
+        }
+
+        save_prebuilt_uploads(ctx, archives);
+    }
 }
 
 namespace {
@@ -272,11 +759,16 @@ std::unique_ptr<cmake::DependencyInjector> create_injector(bool for_standalone_c
 
 std::string cmd::cmd_internals::cmake_gen_config(const BuildContext& ctx, bool for_standalone_cmake)
 {
-    ResolvedDependencies resolved_deps = toml::get<ResolvedDependencies>(toml::parse(ctx.dependency_file));
+    const auto& resolved_deps = ctx.dependencies();
 
     if (const auto* package = ctx.manifest.get_if_package()) {
-        Resolver resolver(ctx.deps_dir, *package, nullptr);
-        const auto result = std::move(resolver).resolve();
+        const auto result = std::invoke([&] {
+            if (auto locked = load_lockfile(ctx.lock_file, dependency_fingerprint(ctx.manifest))) {
+                return std::move(locked).value();
+            }
+
+            return ctx.dependency_graph().resolve(*package);
+        });
 
         SimpleGenerator gen(&ctx.workspace.as_package(),
             package,
@@ -291,9 +783,9 @@ std::string cmd::cmd_internals::cmake_gen_config(const BuildContext& ctx, bool f
 
     fs::create_directory(ctx.packages_dir);
 
-    WorkspaceGenerator gen(ctx.deps_dir, [&ctx](std::string_view package, std::string_view content) {
+    WorkspaceGenerator gen(&ctx.dependency_graph(), [&ctx](std::string_view package, std::string_view content) {
         auto cmake_config = ctx.packages_dir / fmt::format("{}.cmake", package);
-        write(cmake_config, content);
+        write_atomic(cmake_config, content);
         return cmake_config.string();
     });
 
@@ -330,40 +822,58 @@ std::set<std::string> collect_saved_libs(const toml::value& value)
         toml::find_or(value, "libs", {}));
 }
 
+// compiler launcher of distributed compilation, empty if no worker is configured
+std::string dist_launcher()
+{
+    if (dist::get_workers().empty()) {
+        return {};
+    }
+
+    return fmt::format("{};{}", get_current_executable().string(), dist::kLauncherCommand);
 }
 
-void cmd::cmake_setup(const BuildContext& ctx)
+}
+
+void cmd::cmake_setup(const BuildContext& ctx, const util::CmdRunner& runner)
 {
     const auto& inventory_file = ctx.inventory_file;
 
-    const auto all_files = ctx.workspace.list_files();
-    const auto files
-        = all_files | rng::transform([](const auto& file) { return file.string(); }) | ranges::to<std::set>();
     const auto lib_targets = collect_lib_targets(ctx.workspace);
-    if (fs::exists(inventory_file)) {
-        const auto saved_inventory = toml::parse(inventory_file);
-        const auto saved = saved_inventory.at("files").as_array()
-            | rng::transform([](const auto& val) { return val.as_string().str; });
-        const auto saved_libs = collect_saved_libs(saved_inventory);
+    const auto launcher = dist_launcher();
+    const auto saved_launcher = toml::find_or<std::string>(ctx.inventory(), "launcher", "");
+
+    // the source index tells whether source files are added or removed without comparing the whole list
+    if (!ctx.source_index.changed() && fs::exists(inventory_file) && !ctx.is_expired(inventory_file)
+        && launcher == saved_launcher) {
+        const auto saved_libs = collect_saved_libs(ctx.inventory());
         // the add of new header-only libs do not change source file list
-        if (ranges::equal(files, saved) && !ctx.is_expired(inventory_file) && lib_targets == saved_libs) {
+        if (lib_targets == saved_libs) {
             debug("files not changed, skip");
+            ctx.source_index.save();
             return;
         }
     }
 
     status("config", "generate cmake files");
-    write(ctx.build_dir / "CMakeLists.txt", cmd_internals::cmake_gen_config(ctx));
+    // profiles may be configured concurrently, they generate the same files
+    write_atomic(ctx.build_dir / "CMakeLists.txt", cmd_internals::cmake_gen_config(ctx));
 
-    const std::string cmd = fmt::format("cmake -B {} -S build -DCMAKE_BUILD_TYPE={} -DCMAKE_EXPORT_COMPILE_COMMANDS=ON "
-                                        "-DCONAN_GENERATORS_FOLDER={} -DCPPSHIP_DEPS_DIR={}",
+    std::string cmd = fmt::format("cmake -B {} -S build -DCMAKE_BUILD_TYPE={} -D{}={} "
+                                  "-DCMAKE_EXPORT_COMPILE_COMMANDS=ON "
+                                  "-DCONAN_GENERATORS_FOLDER={} -DCPPSHIP_DEPS_DIR={}",
         ctx.profile_dir.string(),
-        ctx.profile,
+        ctx.build_type,
+        cmake::kCppshipProfileVar,
+        parse_profile(ctx.profile).name(),
         (ctx.profile_dir / "conan").string(),
-        ctx.deps_dir.string());
+        ctx.deps_config_dir.string());
+    // leave launchers set up by users alone unless distributed compilation is or was enabled
+    if (!launcher.empty() || !saved_launcher.empty()) {
+        cmd += fmt::format(" \"-DCMAKE_CXX_COMPILER_LAUNCHER={}\"", launcher);
+    }
 
     status("config", "config cmake: {}", cmd);
-    const int res = run_cmd(cmd);
+    const int res = runner.run(cmd);
     if (res != 0) {
         throw Error { "config cmake failed" };
     }
@@ -372,10 +882,84 @@ void cmd::cmake_setup(const BuildContext& ctx)
         fs::rename(compile_db, ctx.build_dir / "compile_commands.json");
     }
 
+    ctx.source_index.save();
+
     toml::value value;
-    value["files"] = files;
     value["libs"] = lib_targets;
-    write(inventory_file, toml::format(value));
+    value["launcher"] = launcher;
+    ctx.save_inventory(std::move(value));
+}
+
+namespace {
+
+std::optional<core::cfg::Compiler> to_cfg_compiler(compiler::CompilerId id)
+{
+    using compiler::CompilerId;
+
+    switch (id) {
+    case CompilerId::gcc:
+        return core::cfg::Compiler::gcc;
+
+    case CompilerId::clang:
+        return core::cfg::Compiler::clang;
+
+    case CompilerId::apple_clang:
+        return core::cfg::Compiler::apple_clang;
+
+    case CompilerId::msvc:
+        return core::cfg::Compiler::msvc;
+
+    case CompilerId::unknown:
+        break;
+    }
+
+    return std::nullopt;
+}
+
+}
+
+void cmd::compile_db_setup(const BuildContext& ctx)
+{
+    // include dirs of conan packages are read from the CMakeDeps output, git deps are known after conan setup.
+    // both are skipped when up to date
+    conan_detect_profile(ctx);
+    conan_setup(ctx);
+    conan_install(ctx);
+
+    auto includes = collect_conan_include_dirs(ctx.profile_dir / "conan", ctx.build_type);
+    if (fs::exists(ctx.git_dep_file)) {
+        for (const auto& dep : ctx.git_dependencies()) {
+            if (auto dir = ctx.deps_dir / dep.package / kIncludePath; fs::exists(dir)) {
+                includes.insert(std::move(dir));
+            }
+        }
+    }
+
+    const compiler::CompilerInfo info;
+    const auto content = cmake::generate_compile_db(ctx.workspace,
+        ctx.manifest,
+        {
+            .compiler = std::string { info.command() },
+            .profile = parse_profile(ctx.profile),
+            .platform = {
+                .os = core::cfg::current_os(),
+                .compiler = to_cfg_compiler(info.id()),
+                .arch = core::cfg::current_arch(),
+                .features = core::cfg::target_features(),
+            },
+            .build_dir = ctx.profile_dir,
+            .dependency_includes = std::move(includes),
+        });
+
+    // regenerated as a whole since it is cheap, but only written on changes to keep watchers of it quiet
+    const auto compile_db = ctx.build_dir / "compile_commands.json";
+    if (fs::exists(compile_db) && read_as_string(compile_db) == content) {
+        debug("compile_commands.json is up to date");
+        return;
+    }
+
+    status("config", "generate {}", compile_db.string());
+    write_atomic(compile_db, content);
 }
 
 namespace {
@@ -423,6 +1007,33 @@ void validate_options(const cmd::BuildContext& ctx, const cmd::BuildOptions& opt
             throw InvalidCmdOption("package", "invalid package specified by --package");
         }
     }
+    if (options.changed_since && (options.package || options.cmake_target)) {
+        throw InvalidCmdOption("changed-since", "--changed-since cannot be used with a package or target");
+    }
+}
+
+// the log is only written by the ninja generator
+std::uintmax_t ninja_log_size(const cmd::BuildContext& ctx)
+{
+    const auto ninja_log = ctx.profile_dir / kNinjaLogFile;
+    return fs::exists(ninja_log) ? fs::file_size(ninja_log) : 0;
+}
+
+// ninja appends to its log, lines past the old end belong to this build
+void record_ninja_log(const cmd::BuildContext& ctx, std::uintmax_t offset)
+{
+    const auto ninja_log = ctx.profile_dir / kNinjaLogFile;
+    if (!fs::exists(ninja_log)) {
+        return;
+    }
+
+    const auto log = read_as_string(ninja_log);
+    if (log.size() < offset) {
+        debug("ninja log recompacted, units of the build not recorded");
+        return;
+    }
+
+    history_internals::parse_ninja_log(std::string_view { log }.substr(offset), ctx.build_record());
 }
 
 }
@@ -434,17 +1045,70 @@ int cmd::cmake_build(const BuildContext& ctx, const BuildOptions& options, const
     auto cmd = fmt::format("cmake --build {} -j {} --config {}",
         ctx.profile_dir.string(),
         options.max_concurrency,
-        to_string(options.profile));
+        ctx.build_type);
+    const auto groups = options.groups.empty() ? std::set { BuildGroup::binaries } : options.groups;
     if (options.cmake_target) {
         cmd += fmt::format(" --target {}", *options.cmake_target);
-    } else if (options.groups.empty()) {
-        cmd += fmt::format(" --target {}", to_cmake_group(BuildGroup::binaries, ctx, options));
+    } else if (options.changed_since) {
+        const auto& packages = ctx.affected_packages(*options.changed_since);
+        status("build", "{} packages affected since {}", packages.size(), *options.changed_since);
+        if (packages.empty()) {
+            return EXIT_SUCCESS;
+        }
+
+        for (const auto& package : packages) {
+            for (const auto group : groups) {
+                cmd += fmt::format(" --target {}_{}", package, to_cmake_group(group));
+            }
+        }
     } else {
-        for (const auto group : options.groups) {
+        for (const auto group : groups) {
             cmd += fmt::format(" --target {}", to_cmake_group(group, ctx, options));
         }
     }
 
+    const auto ninja_log_offset = ninja_log_size(ctx);
     status("build", "{}", cmd);
-    return runner.run(cmd);
+    const int res = runner.run(cmd);
+    record_ninja_log(ctx, ninja_log_offset);
+
+    // libs built before a failure are worth sharing too
+    upload_prebuilt(ctx);
+    return res;
+}
+
+std::set<std::string> cmd::list_affected_packages(const BuildContext& ctx, std::string_view rev)
+{
+    if (!fs::exists(ctx.root / ".git")) {
+        throw Error { "--changed-since requires a git repository" };
+    }
+
+    // passed as args rather than through a shell, ref names may contain shell metacharacters
+    const util::CmdRunner runner;
+    const auto results = runner.run_all(
+        {
+            // both sides of renames are changed
+            {
+                .args = {
+                    "git", "diff", "--name-only", "-z", "--no-renames", "--end-of-options", std::string { rev }, "--",
+                },
+                .cwd = ctx.root,
+                .capture_stderr = false,
+            },
+            // new files not added yet
+            {
+                .args = { "git", "ls-files", "-z", "--others", "--exclude-standard" },
+                .cwd = ctx.root,
+                .capture_stderr = false,
+            },
+        },
+        0);
+    if (!results[0].ok() || !results[1].ok()) {
+        throw InvalidCmdOption("changed-since", fmt::format("cannot list files changed since {}", rev));
+    }
+
+    std::set<fs::path> changed;
+    insert_git_paths(changed, ctx.root, results[0].output);
+    insert_git_paths(changed, ctx.root, results[1].output);
+    return affected_packages(ctx.workspace, ctx.manifest, changed);
 }
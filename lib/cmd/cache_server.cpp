@@ -0,0 +1,20 @@
+#include "cppship/cmd/cache_server.h"
+
+#include <cstdlib>
+
+#include "cppship/core/cache_server.h"
+#include "cppship/util/log.h"
+
+using namespace cppship;
+
+int cmd::run_cache_server(const CacheServerOptions& options)
+{
+    const auto root = options.root.value_or(get_cache_dir() / "server");
+
+    CacheServer server(root, options.host, options.port, options.max_size << 20);
+    status("cache", "serve {} at http://{}:{}", root.string(), options.host, server.port());
+    status("cache", "use it by CPPSHIP_REMOTE_CACHE=http://{}:{}", options.host, server.port());
+
+    server.run();
+    return EXIT_SUCCESS;
+}
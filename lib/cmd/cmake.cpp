@@ -18,7 +18,7 @@ int cmd::run_cmake(const CmakeOptions&)
 {
     status("cmake", "generate config");
 
-    BuildContext ctx({});
+    BuildContext ctx(Profile::debug);
     std::ignore = enforce_default_package(ctx.workspace);
 
     ScopedCurrentDir guard(ctx.root);
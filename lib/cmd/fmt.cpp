@@ -1,11 +1,18 @@
 #include "cppship/cmd/fmt.h"
 
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
 #include <string_view>
+#include <vector>
 
-#include <boost/process/system.hpp>
 #include <fmt/core.h>
+#include <range/v3/algorithm/any_of.hpp>
 
+#include "cppship/exception.h"
 #include "cppship/util/cmd.h"
+#include "cppship/util/cmd_runner.h"
 #include "cppship/util/log.h"
 #include "cppship/util/repo.h"
 
@@ -13,32 +20,61 @@ constexpr std::string_view kFmtCmd = "clang-format";
 
 using namespace cppship;
 
-namespace pr = boost::process;
+namespace {
 
-int cmd::run_fmt(const FmtOptions& options)
+std::map<fs::path, std::vector<LineRange>> list_files_to_format(const cmd::FmtOptions& options)
 {
-    require_cmd(kFmtCmd);
+    const ListOptions list_options { .cached_only = options.cached_only, .commit = options.commit };
+    if (options.changed_lines) {
+        return list_changed_lines(list_options);
+    }
 
-    const auto files = options.all
-        ? list_all_files()
-        : list_changed_files({ .cached_only = options.cached_only, .commit = options.commit });
+    std::map<fs::path, std::vector<LineRange>> result;
+    for (const auto& file : options.all ? list_all_files() : list_changed_files(list_options)) {
+        result.emplace(file, std::vector<LineRange> {});
+    }
 
-    int exit_code = 0;
+    return result;
+}
 
-    status("format", "run clang-format");
-    for (const auto& file : files) {
-        status("format", "{}", file.string());
+}
 
-        const int err
-            = pr::system(fmt::format("{} {} {}", kFmtCmd, file.string(), (options.fix ? "-i" : "-n --Werror")));
-        if (err != 0) {
-            exit_code = EXIT_FAILURE;
+int cmd::run_fmt(const FmtOptions& options)
+{
+    if (options.all && options.changed_lines) {
+        throw InvalidCmdOption { "--lines", "--lines cannot be used with --all" };
+    }
+
+    require_cmd(kFmtCmd);
+
+    const auto files = list_files_to_format(options);
+
+    std::vector<util::Task> tasks;
+    for (const auto& [file, lines] : files) {
+        auto& task = tasks.emplace_back();
+        task.args = { std::string { kFmtCmd }, file.string() };
+        for (const auto& range : lines) {
+            task.args.push_back(fmt::format("--lines={}:{}", range.first, range.last));
+        }
+        if (options.fix) {
+            task.args.emplace_back("-i");
+        } else {
+            task.args.insert(task.args.end(), { "-n", "--Werror" });
         }
     }
 
+    status("format", "run clang-format");
+    const auto results = util::CmdRunner {}.run_all(tasks, 0, [&tasks](std::size_t i, const util::TaskResult& result) {
+        status("format", "{}", tasks[i].args[1]);
+        // diagnostics of a file are printed together
+        std::cerr << result.output << result.error_output << std::flush;
+    });
+
+    const int exit_code
+        = ranges::any_of(results, [](const util::TaskResult& result) { return !result.ok(); }) ? EXIT_FAILURE : 0;
     if (exit_code == 0) {
         status("format", "all files are formated");
     }
 
     return exit_code;
-}
\ No newline at end of file
+}
@@ -51,15 +51,17 @@ int cmd::run_install([[maybe_unused]] const InstallOptions& options)
     }
 
     const auto& layout = ctx.workspace.as_package();
-    if (options.binary && !layout.binary(*options.binary).has_value()) {
+    if (options.binary && layout.binary(*options.binary) == nullptr) {
         throw InvalidCmdOption { "--bin", fmt::format("specified binary {} is not found", *options.binary) };
     }
 
     cmake::NameTargetMapper mapper(layout.package());
-    const int result = run_build({
-        .profile = options.profile,
-        .cmake_target = options.binary.has_value() ? std::make_optional(mapper.binary(*options.binary)) : std::nullopt,
-    });
+    const int result = run_build(ctx,
+        {
+            .profile = options.profile,
+            .cmake_target
+            = options.binary.has_value() ? std::make_optional(mapper.binary(*options.binary)) : std::nullopt,
+        });
     if (result != 0) {
         return EXIT_FAILURE;
     }
@@ -69,8 +71,7 @@ int cmd::run_install([[maybe_unused]] const InstallOptions& options)
             return std::vector<std::string> { *options.binary };
         }
 
-        const auto tmp = layout.binaries();
-        return tmp | ranges::views::transform(&Target::name) | ranges::to<std::vector>();
+        return layout.binaries() | ranges::views::transform(&Target::name) | ranges::to<std::vector>();
     });
 
     return do_install(ctx, binaries, "/usr/local");
@@ -1,15 +1,18 @@
 #include "cppship/cmd/lint.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <iostream>
+#include <string>
 #include <string_view>
 #include <vector>
 
-#include <BS_thread_pool_light.hpp>
-#include <boost/process/system.hpp>
-#include <fmt/core.h>
+#include <gsl/narrow>
 #include <range/v3/algorithm/any_of.hpp>
 
+#include "cppship/cmd/build.h"
 #include "cppship/util/cmd.h"
+#include "cppship/util/cmd_runner.h"
 #include "cppship/util/log.h"
 #include "cppship/util/repo.h"
 
@@ -22,32 +25,36 @@ int cmd::run_lint(const LintOptions& options)
     require_cmd(kLintCmd);
 
     ScopedCurrentDir guard(get_project_root());
+    if (!fs::exists(fs::path { kBuildPath } / "compile_commands.json")) {
+        // clang-tidy only needs flags, not a configured build
+        compile_db_setup(BuildContext { Profile::debug });
+    }
+
     const auto files = options.all
         ? list_all_files()
         : list_changed_files({ .cached_only = options.cached_only, .commit = options.commit });
-    const auto concurrency = options.max_concurrency;
 
-    BS::thread_pool_light pool(concurrency);
-    std::vector<std::future<int>> tasks;
-    tasks.reserve(files.size());
-
-    status("lint", "run clang-tidy");
+    std::vector<util::Task> tasks;
     for (const auto& file : files) {
         if (file.extension() != ".cpp") {
             continue;
         }
 
-        auto fut = pool.submit([file] {
-            status("lint", "{}", file.string());
-
-            return boost::process::system(
-                fmt::format("{} {} -p build --warnings-as-errors=true --quiet", kLintCmd, file.string()),
-                boost::process::std_err > boost::process::null);
+        tasks.push_back({
+            .args = { std::string { kLintCmd }, file.string(), "-p", "build", "--warnings-as-errors=true", "--quiet" },
+            .capture_stderr = false,
         });
-        tasks.push_back(std::move(fut));
     }
 
-    pool.wait_for_tasks();
+    status("lint", "run clang-tidy");
+    const auto results = util::CmdRunner {}.run_all(tasks,
+        gsl::narrow_cast<unsigned>(std::max(options.max_concurrency, 0)),
+        [&tasks](std::size_t i, const util::TaskResult& result) {
+            status("lint", "{}", tasks[i].args[1]);
+            // diagnostics of a file are printed together
+            std::cout << result.output << result.error_output << std::flush;
+        });
 
-    return ranges::any_of(tasks, [](auto& fut) { return fut.get() != 0; }) ? EXIT_FAILURE : EXIT_SUCCESS;
-}
\ No newline at end of file
+    return ranges::any_of(results, [](const util::TaskResult& result) { return !result.ok(); }) ? EXIT_FAILURE
+                                                                                                : EXIT_SUCCESS;
+}
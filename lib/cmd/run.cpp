@@ -54,8 +54,8 @@ std::string choose_target(const cmd::BuildContext& ctx, const cmd::RunOptions& o
         });
 
         const auto* layout = ctx.workspace.layout(package);
-        auto target = layout->binary(package);
-        if (!target) {
+        const auto* target = layout->binary(package);
+        if (target == nullptr) {
             throw Error { fmt::format("package {} has no default binary", package) };
         }
 
@@ -73,10 +73,10 @@ std::string choose_target(const cmd::BuildContext& ctx, const cmd::RunOptions& o
 
     const auto candidates = layouts | ranges::views::filter([&](const Layout* layout) {
         if (options.bin) {
-            return layout->binary(*options.bin).has_value();
+            return layout->binary(*options.bin) != nullptr;
         }
         if (options.example) {
-            return layout->example(*options.example).has_value();
+            return layout->example(*options.example) != nullptr;
         }
         return false;
     }) | ranges::to<std::vector>();
@@ -108,7 +108,7 @@ int cmd::run_run(const RunOptions& options)
     validate_options(ctx, options);
 
     const auto target = choose_target(ctx, options);
-    const int result = run_build({ .profile = options.profile, .cmake_target = target });
+    const int result = run_build(ctx, { .profile = options.profile, .cmake_target = target });
     if (result != 0) {
         return EXIT_FAILURE;
     }
@@ -0,0 +1,245 @@
+#include "cppship/cmd/stats.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <fmt/chrono.h>
+#include <fmt/core.h>
+#include <range/v3/algorithm/any_of.hpp>
+#include <range/v3/algorithm/find_if.hpp>
+#include <range/v3/algorithm/sort.hpp>
+#include <range/v3/view/take.hpp>
+
+#include "cppship/core/build_history.h"
+#include "cppship/core/profile.h"
+#include "cppship/exception.h"
+#include "cppship/util/cmd_runner.h"
+#include "cppship/util/log.h"
+#include "cppship/util/repo.h"
+
+using namespace cppship;
+
+namespace {
+
+std::string format_ms(double ms)
+{
+    if (ms < 1000) {
+        return fmt::format("{:.0f}ms", ms);
+    }
+
+    return fmt::format("{:.2f}s", ms / 1000);
+}
+
+std::string format_time(std::int64_t time)
+{
+    return fmt::format("{:%Y-%m-%d %H:%M}", fmt::localtime(static_cast<std::time_t>(time)));
+}
+
+std::string format_growth(double before, double after)
+{
+    return before <= 0 ? "new" : fmt::format("{:+.0f}%", (after / before - 1) * 100);
+}
+
+std::int64_t stage_ms(const BuildRecord& record, std::string_view stage)
+{
+    const auto it = ranges::find_if(record.stages, [stage](const StageTime& time) { return time.name == stage; });
+    return it == record.stages.end() ? 0 : it->ms;
+}
+
+double mean_total_ms(const std::vector<BuildRecord>& records, std::size_t first, std::size_t last)
+{
+    std::int64_t sum = 0;
+    for (auto i = first; i < last; ++i) {
+        sum += records[i].total_ms();
+    }
+
+    return last == first ? 0 : static_cast<double>(sum) / static_cast<double>(last - first);
+}
+
+// whether a build is since the day, or since the commit if it contains the commit
+std::function<bool(const BuildRecord&)> parse_since(const std::string& since, const std::vector<BuildRecord>& history)
+{
+    std::tm tm {};
+    std::istringstream iss(since);
+    iss >> std::get_time(&tm, "%Y-%m-%d");
+    if (!iss.fail() && iss.peek() == std::char_traits<char>::eof()) {
+        tm.tm_isdst = -1;
+        const auto cutoff = std::mktime(&tm);
+        return [cutoff](const BuildRecord& record) { return record.time >= cutoff; };
+    }
+
+    // passed as args rather than through a shell, an option is not a revision either
+    const util::CmdRunner runner;
+    const util::Task rev_parse { .args = { "git", "rev-parse", "--verify", "--quiet", since + "^{commit}" } };
+    const auto rev = since.starts_with('-') ? util::TaskResult {} : runner.run_all({ rev_parse }, 1).front();
+    if (!rev.ok()) {
+        throw InvalidCmdOption("since", fmt::format("neither a date nor a git revision: {}", since));
+    }
+
+    // builds out of git are taken as before it
+    const auto commit = boost::trim_copy(rev.output);
+    std::set<std::string> commits;
+    for (const auto& record : history) {
+        if (!record.commit.empty()) {
+            commits.insert(record.commit);
+        }
+    }
+
+    std::vector<util::Task> tasks;
+    for (const auto& build_commit : commits) {
+        tasks.push_back({
+            .args = { "git", "merge-base", "--is-ancestor", commit, build_commit },
+            .capture_stderr = false,
+        });
+    }
+
+    const auto results = runner.run_all(tasks, 0);
+    std::set<std::string> containing;
+    for (auto it = commits.begin(); const auto& result : results) {
+        if (result.ok()) {
+            containing.insert(*it);
+        }
+        ++it;
+    }
+
+    return [containing = std::move(containing)](
+               const BuildRecord& record) { return containing.contains(record.commit); };
+}
+
+void print_trend(const std::vector<BuildRecord>& history, std::size_t top)
+{
+    const auto first = history.size() - std::min(top, history.size());
+    fmt::print("builds, the latest {} of {}\n", history.size() - first, history.size());
+    fmt::print("  {:<16}  {:<10}  {:<10}  {:>8}  {:>8}  {:>6}  {:>8}  {}\n",
+        "time",
+        "commit",
+        "profile",
+        "total",
+        "build",
+        "units",
+        "prebuilt",
+        "result");
+    for (auto i = first; i < history.size(); ++i) {
+        const auto& record = history[i];
+        fmt::print("  {:<16}  {:<10}  {:<10}  {:>8}  {:>8}  {:>6}  {:>8}  {}\n",
+            format_time(record.time),
+            record.commit.empty() ? "-" : record.commit,
+            record.profile,
+            format_ms(static_cast<double>(record.total_ms())),
+            format_ms(static_cast<double>(stage_ms(record, "cmake_build"))),
+            record.units.size(),
+            fmt::format("{}/{}", record.prebuilt_hits, record.prebuilt_hits + record.prebuilt_misses),
+            record.result == 0 ? "ok" : "failed");
+    }
+
+    // builds before the latest ones, the same number of them
+    const auto previous = first - std::min(first, history.size() - first);
+    if (previous < first) {
+        const auto latest = mean_total_ms(history, first, history.size());
+        const auto before = mean_total_ms(history, previous, first);
+        fmt::print("mean total of the latest {}: {}, of the {} before: {} ({})\n",
+            history.size() - first,
+            format_ms(latest),
+            first - previous,
+            format_ms(before),
+            format_growth(before, latest));
+    }
+}
+
+// by the latest measurement of each name
+void print_slowest(std::string_view title, const std::map<std::string, std::int64_t>& times, std::size_t top)
+{
+    std::vector<std::pair<std::string, std::int64_t>> slowest(times.begin(), times.end());
+    ranges::sort(slowest, std::greater<> {}, [](const auto& time) { return time.second; });
+    slowest.resize(std::min(top, slowest.size()));
+
+    fmt::print("\n{}\n", title);
+    for (const auto& [name, ms] : slowest) {
+        fmt::print("  {:>8}  {}\n", format_ms(static_cast<double>(ms)), name);
+    }
+}
+
+void print_slowest(const std::vector<BuildRecord>& history, std::size_t top)
+{
+    std::map<std::pair<std::string, std::string>, std::int64_t> latest_units;
+    std::map<std::string, std::int64_t> links;
+    for (const auto& record : history) {
+        for (const auto& unit : record.units) {
+            latest_units[{ unit.target, unit.source }] = unit.ms;
+        }
+        for (const auto& link : record.links) {
+            links[link.output] = link.ms;
+        }
+    }
+
+    std::map<std::string, std::int64_t> units;
+    std::map<std::string, std::int64_t> targets;
+    for (const auto& [key, ms] : latest_units) {
+        const auto& [target, source] = key;
+        units[fmt::format("{} ({})", source, target)] = ms;
+        targets[target] += ms;
+    }
+
+    print_slowest("slowest units, by their latest compile", units, top);
+    print_slowest("slowest targets, by the sum of their units", targets, top);
+    print_slowest("slowest links", links, top);
+}
+
+void print_regressions(std::string_view title, const std::vector<Regression>& regressions, std::size_t top)
+{
+    fmt::print("  {}{}\n", title, regressions.empty() ? ": none" : "");
+    for (const auto& reg : regressions | ranges::views::take(top)) {
+        fmt::print("    {:>8} -> {:>8} ({})  {}\n",
+            format_ms(reg.before_ms),
+            format_ms(reg.after_ms),
+            format_growth(reg.before_ms, reg.after_ms),
+            reg.name);
+    }
+}
+
+}
+
+int cmd::run_stats(const StatsOptions& options)
+{
+    const auto history_file = get_project_root() / kBuildPath / kBuildHistoryFile;
+    auto history = load_build_history(history_file);
+    if (options.profile) {
+        const std::string profile { to_string(parse_profile(*options.profile)) };
+        std::erase_if(history, [&profile](const BuildRecord& record) { return record.profile != profile; });
+    }
+
+    if (history.empty()) {
+        status("stats", "no build recorded in {}", history_file.string());
+        return EXIT_SUCCESS;
+    }
+
+    print_trend(history, options.top);
+
+    const bool has_units = ranges::any_of(history, [](const BuildRecord& record) { return !record.units.empty(); });
+    if (!has_units) {
+        warn("compile times are only recorded with the ninja generator, eg. export CMAKE_GENERATOR=Ninja");
+        return EXIT_SUCCESS;
+    }
+
+    print_slowest(history, options.top);
+
+    if (options.since) {
+        const auto regressions = find_regressions(history, parse_since(*options.since, history));
+        fmt::print("\nregressions since {}, mean compile time before and since\n", *options.since);
+        print_regressions("units", regressions.units, options.top);
+        print_regressions("targets", regressions.targets, options.top);
+    }
+
+    return EXIT_SUCCESS;
+}
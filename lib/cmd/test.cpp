@@ -1,11 +1,15 @@
 #include "cppship/cmd/test.h"
 
 #include <cstdlib>
+#include <set>
+#include <string>
 
+#include <boost/algorithm/string/join.hpp>
 #include <boost/process/system.hpp>
 #include <gsl/narrow>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view/filter.hpp>
+#include <range/v3/view/transform.hpp>
 #include <spdlog/spdlog.h>
 
 #include "cppship/cmake/naming.h"
@@ -13,6 +17,7 @@
 #include "cppship/core/workspace.h"
 #include "cppship/util/fs.h"
 #include "cppship/util/log.h"
+#include "cppship/util/string.h"
 
 using namespace cppship;
 
@@ -23,6 +28,9 @@ void valid_options(const cmd::TestOptions& options)
     if (options.name && options.name_regex) {
         throw Error { "testname and -R should not be specified both" };
     }
+    if (options.changed_since && (options.name || options.package || options.rerun_failed)) {
+        throw Error { "--changed-since should not be specified with testname, package or --rerun-failed" };
+    }
 }
 
 }
@@ -35,7 +43,7 @@ int cmd::run_test(const TestOptions& options)
     BuildOptions build_opts { .profile = options.profile };
     if (options.name && !options.rerun_failed) {
         const auto layouts = ctx.workspace.layouts()
-            | ranges::views::filter([&](const Layout& layout) { return layout.test(*options.name).has_value(); })
+            | ranges::views::filter([&](const Layout& layout) { return layout.test(*options.name) != nullptr; })
             | ranges::to<std::vector>();
         if (layouts.empty()) {
             throw Error { fmt::format("test `{}` not found", *options.name) };
@@ -50,10 +58,20 @@ int cmd::run_test(const TestOptions& options)
         build_opts.cmake_target = cmake::NameTargetMapper(layouts.front().package()).test(*options.name);
     } else {
         build_opts.package = options.package;
+        build_opts.changed_since = options.changed_since;
         build_opts.groups.insert(BuildGroup::tests);
     }
 
-    const int result = run_build(build_opts);
+    std::set<std::string> affected;
+    if (options.changed_since) {
+        affected = ctx.affected_packages(*options.changed_since);
+        if (affected.empty()) {
+            status("test", "no package affected since {}", *options.changed_since);
+            return EXIT_SUCCESS;
+        }
+    }
+
+    const int result = run_build(ctx, build_opts);
     if (result != 0) {
         return EXIT_FAILURE;
     }
@@ -72,6 +90,9 @@ int cmd::run_test(const TestOptions& options)
         }
     } else if (options.package) {
         cmd += fmt::format(" -L '^{}$'", *options.package);
+    } else if (options.changed_since) {
+        const auto labels = affected | ranges::views::transform(util::escape_regex);
+        cmd += fmt::format(" -L '^({})$'", boost::join(labels, "|"));
     }
 
     status("test", "{}", cmd);
@@ -0,0 +1,237 @@
+#include "cppship/cmd/vendor.h"
+
+#include <array>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+
+#include <fmt/core.h>
+#include <gsl/util>
+#include <toml.hpp>
+
+#include "cppship/cmd/build.h"
+#include "cppship/core/lockfile.h"
+#include "cppship/exception.h"
+#include "cppship/util/cmd.h"
+#include "cppship/util/fs.h"
+#include "cppship/util/io.h"
+#include "cppship/util/log.h"
+
+using namespace cppship;
+
+// the vendor archive:
+//  vendor.toml: archive version and the dependency fingerprint it is created from
+//  cppship.lock, conan.lock
+//  build/conanfile.txt, build/git_dep.toml
+//  deps/<package>: git deps without .git, including footprints
+//  conan_cache.tgz: `conan cache save` of all packages in the dependency graph
+namespace {
+
+constexpr std::int64_t kVendorVersion = 1;
+constexpr std::string_view kVendorMeta = "vendor.toml";
+constexpr std::string_view kConanCacheArchive = "conan_cache.tgz";
+
+void run_or_throw(std::string_view cmd, std::string_view error)
+{
+    if (run_cmd(cmd) != 0) {
+        throw Error { std::string { error } };
+    }
+}
+
+void copy_if_exists(const fs::path& from, const fs::path& to)
+{
+    if (fs::exists(from)) {
+        fs::create_directories(to.parent_path());
+        fs::copy_file(from, to, fs::copy_options::overwrite_existing);
+    }
+}
+
+std::string conan_lock_args(const cmd::BuildContext& ctx)
+{
+    return fs::exists(ctx.conan_lock_file)
+        ? fmt::format("--lockfile={} --lockfile-partial", ctx.conan_lock_file.string())
+        : std::string {};
+}
+
+void save_conan_cache(const cmd::BuildContext& ctx, const fs::path& staging)
+{
+    status("vendor", "save conan packages");
+
+    const auto graph_file = ctx.profile_dir / "vendor_graph.json";
+    const auto list_file = ctx.profile_dir / "vendor_pkglist.json";
+    const auto cleanup = gsl::finally([&graph_file, &list_file] {
+        std::error_code ec;
+        fs::remove(graph_file, ec);
+        fs::remove(list_file, ec);
+    });
+
+    write(graph_file,
+        check_output(fmt::format("conan graph info {} -pr {} {} --format=json",
+            ctx.build_dir.string(),
+            ctx.conan_profile_path.string(),
+            conan_lock_args(ctx))));
+
+    write(list_file,
+        check_output(fmt::format(
+            "conan list --graph={} \"--graph-recipes=*\" \"--graph-binaries=*\" --format=json", graph_file.string())));
+
+    run_or_throw(fmt::format("conan cache save --list={} --file={}",
+                     list_file.string(),
+                     (staging / kConanCacheArchive).string()),
+        "save conan packages failed");
+}
+
+int export_vendor(const cmd::VendorOptions& options)
+{
+    cmd::BuildContext ctx(options.profile);
+    ScopedCurrentDir guard(ctx.root);
+
+    // make sure everything to vendor is in place
+    cmd::conan_detect_profile(ctx);
+    cmd::conan_setup(ctx);
+    cmd::conan_install(ctx);
+
+    const auto staging = ctx.build_dir / "vendor";
+    fs::remove_all(staging);
+    fs::create_directories(staging);
+
+    status("vendor", "collect dependencies");
+    if (fs::exists(ctx.deps_dir)) {
+        for (const auto& entry : fs::directory_iterator { ctx.deps_dir }) {
+            if (entry.is_directory()) {
+                cmd::vendor_internals::copy_tree(entry.path(), staging / kBuildDepsPath / entry.path().filename());
+            }
+        }
+    }
+
+    copy_if_exists(ctx.lock_file, staging / kLockFile);
+    copy_if_exists(ctx.conan_lock_file, staging / kConanLockFile);
+    copy_if_exists(ctx.conan_file, staging / kBuildPath / ctx.conan_file.filename());
+    copy_if_exists(ctx.git_dep_file, staging / kBuildPath / ctx.git_dep_file.filename());
+
+    save_conan_cache(ctx, staging);
+
+    const auto fingerprint = dependency_fingerprint(ctx.manifest);
+    const auto output_dir = options.output_dir.value_or(ctx.build_dir);
+    fs::create_directories(output_dir);
+    const auto archive = cmd::vendor_internals::archive_path(output_dir, fingerprint);
+    cmd::vendor_internals::pack(staging, fingerprint, archive);
+    fs::remove_all(staging);
+
+    status("vendor", "dependencies are vendored to {}", archive.string());
+    return EXIT_SUCCESS;
+}
+
+int restore_vendor(const cmd::VendorOptions& options)
+{
+    const auto archive = fs::absolute(*options.restore);
+    if (!fs::exists(archive)) {
+        throw InvalidCmdOption { "--restore", fmt::format("vendor archive {} not found", archive.string()) };
+    }
+
+    cmd::BuildContext ctx(options.profile);
+    ScopedCurrentDir guard(ctx.root);
+
+    const auto staging = ctx.build_dir / "vendor";
+    cmd::vendor_internals::unpack(archive, dependency_fingerprint(ctx.manifest), staging);
+
+    if (const auto conan_cache = staging / kConanCacheArchive; fs::exists(conan_cache)) {
+        status("vendor", "restore conan packages");
+        run_or_throw(fmt::format("conan cache restore {}", conan_cache.string()), "restore conan packages failed");
+    }
+
+    status("vendor", "restore dependencies");
+    if (const auto deps = staging / kBuildDepsPath; fs::exists(deps)) {
+        for (const auto& entry : fs::directory_iterator { deps }) {
+            const auto dst = ctx.deps_dir / entry.path().filename();
+            fs::remove_all(dst);
+            cmd::vendor_internals::copy_tree(entry.path(), dst);
+        }
+    }
+
+    copy_if_exists(staging / kLockFile, ctx.lock_file);
+    copy_if_exists(staging / kConanLockFile, ctx.conan_lock_file);
+    copy_if_exists(staging / kBuildPath / ctx.conan_file.filename(), ctx.conan_file);
+    copy_if_exists(staging / kBuildPath / ctx.git_dep_file.filename(), ctx.git_dep_file);
+
+    // stages are fresh now: conan_setup is skipped, conan install only hits the local cache
+    for (const auto& file : std::array { ctx.lock_file, ctx.conan_lock_file, ctx.conan_file, ctx.git_dep_file }) {
+        if (fs::exists(file)) {
+            touch(file);
+        }
+    }
+
+    fs::remove_all(staging);
+
+    status("vendor", "dependencies are restored from {}", archive.string());
+    return EXIT_SUCCESS;
+}
+
+}
+
+void cmd::vendor_internals::copy_tree(const fs::path& from, const fs::path& to)
+{
+    fs::create_directories(to);
+
+    for (auto it = fs::recursive_directory_iterator { from }; it != fs::recursive_directory_iterator {}; ++it) {
+        const auto& path = it->path();
+        if (it->is_directory() && path.filename() == ".git") {
+            it.disable_recursion_pending();
+            continue;
+        }
+
+        const auto dst = to / path.lexically_relative(from);
+        if (it->is_directory()) {
+            fs::create_directories(dst);
+        } else {
+            fs::copy(path, dst, fs::copy_options::overwrite_existing | fs::copy_options::copy_symlinks);
+        }
+    }
+}
+
+fs::path cmd::vendor_internals::archive_path(const fs::path& output_dir, std::string_view fingerprint)
+{
+    return output_dir / fmt::format("cppship-vendor-{}.tar.gz", fingerprint);
+}
+
+void cmd::vendor_internals::pack(const fs::path& staging, std::string_view fingerprint, const fs::path& archive)
+{
+    toml::value meta;
+    meta["version"] = kVendorVersion;
+    meta["fingerprint"] = std::string { fingerprint };
+    write(staging / kVendorMeta, toml::format(meta));
+
+    // written aside and renamed, an archive with the name is always complete
+    auto tmp_archive = fs::absolute(archive);
+    tmp_archive += ".tmp";
+    {
+        ScopedCurrentDir staging_guard(staging);
+        run_or_throw(fmt::format("cmake -E tar czf {} .", tmp_archive.string()), "create vendor archive failed");
+    }
+
+    fs::rename(tmp_archive, archive);
+}
+
+void cmd::vendor_internals::unpack(const fs::path& archive, std::string_view fingerprint, const fs::path& staging)
+{
+    fs::remove_all(staging);
+    fs::create_directories(staging);
+    {
+        ScopedCurrentDir staging_guard(staging);
+        run_or_throw(
+            fmt::format("cmake -E tar xzf {}", fs::absolute(archive).string()), "extract vendor archive failed");
+    }
+
+    const auto meta = toml::parse(staging / kVendorMeta);
+    if (toml::find_or<std::int64_t>(meta, "version", 0) != kVendorVersion) {
+        throw Error { fmt::format("unsupported vendor archive {}", archive.string()) };
+    }
+    if (toml::find_or<std::string>(meta, "fingerprint", "") != fingerprint) {
+        throw Error { "vendor archive is created from different dependencies" };
+    }
+}
+
+int cmd::run_vendor(const VendorOptions& options)
+{
+    return options.restore ? restore_vendor(options) : export_vendor(options);
+}
@@ -0,0 +1,34 @@
+#include "cppship/cmd/worker.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+#include "cppship/core/compiler.h"
+#include "cppship/core/dist.h"
+#include "cppship/util/log.h"
+
+using namespace cppship;
+
+int cmd::run_worker(const WorkerOptions& options)
+{
+    const auto compiler = options.compiler ? *options.compiler : std::string { compiler::CompilerInfo {}.command() };
+    const auto slots = options.slots.value_or(std::max(std::thread::hardware_concurrency(), 1U));
+
+    auto token = options.token ? *options.token : dist::get_token();
+    const bool has_token = !token.empty();
+
+    dist::WorkerServer server(compiler, options.host, options.port, slots, std::move(token));
+    status("worker", "serve {} with {} slots at {}:{}", compiler, slots, options.host, server.port());
+    status("worker",
+        "use it by CPPSHIP_DIST_WORKERS={}:{}{}",
+        options.host,
+        server.port(),
+        has_token ? " and CPPSHIP_DIST_TOKEN of the same token" : "");
+
+    server.run();
+    return EXIT_SUCCESS;
+}
+
+int cmd::run_dist_compile(const std::vector<std::string>& cmd) { return dist::compile(cmd); }
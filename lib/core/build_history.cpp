@@ -0,0 +1,258 @@
+#include "cppship/core/build_history.h"
+
+#include <charconv>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <fmt/format.h>
+#include <range/v3/algorithm/sort.hpp>
+#include <toml.hpp>
+
+#include "cppship/exception.h"
+
+using namespace cppship;
+
+namespace {
+
+constexpr std::string_view kCmakeFilesDir = "CMakeFiles/";
+constexpr std::string_view kTargetDirSuffix = ".dir/";
+
+// growth below either is taken as noise
+constexpr double kRegressionRatio = 1.1;
+constexpr double kRegressionMinMs = 10;
+
+std::string quote(const std::string& str) { return toml::format(toml::value(str)); }
+
+std::vector<toml::value> find_array(const toml::value& value, const std::string& key)
+{
+    return toml::find_or<std::vector<toml::value>>(value, key, {});
+}
+
+BuildRecord record_from_toml(const toml::value& value)
+{
+    BuildRecord record {
+        .time = toml::find_or<std::int64_t>(value, "time", 0),
+        .commit = toml::find_or<std::string>(value, "commit", ""),
+        .profile = toml::find_or<std::string>(value, "profile", ""),
+        .result = toml::find_or<int>(value, "result", 0),
+        .prebuilt_hits = toml::find_or<std::size_t>(value, "prebuilt_hits", 0),
+        .prebuilt_misses = toml::find_or<std::size_t>(value, "prebuilt_misses", 0),
+    };
+
+    for (const auto& stage : find_array(value, "stages")) {
+        record.stages.push_back({
+            .name = toml::find<std::string>(stage, "name"),
+            .ms = toml::find<std::int64_t>(stage, "ms"),
+        });
+    }
+    for (const auto& unit : find_array(value, "units")) {
+        record.units.push_back({
+            .target = toml::find<std::string>(unit, "target"),
+            .source = toml::find<std::string>(unit, "source"),
+            .ms = toml::find<std::int64_t>(unit, "ms"),
+        });
+    }
+    for (const auto& link : find_array(value, "links")) {
+        record.links.push_back({
+            .output = toml::find<std::string>(link, "output"),
+            .ms = toml::find<std::int64_t>(link, "ms"),
+        });
+    }
+
+    return record;
+}
+
+std::optional<std::int64_t> parse_ms(std::string_view field)
+{
+    std::int64_t ms = 0;
+    const auto* end = field.data() + field.size();
+    const auto [ptr, ec] = std::from_chars(field.data(), end, ms);
+    if (ec != std::errc {} || ptr != end) {
+        return std::nullopt;
+    }
+
+    return ms;
+}
+
+struct Mean {
+    std::int64_t sum = 0;
+    std::int64_t count = 0;
+
+    void add(std::int64_t ms)
+    {
+        sum += ms;
+        ++count;
+    }
+
+    double value() const { return count == 0 ? 0 : static_cast<double>(sum) / static_cast<double>(count); }
+};
+
+bool is_regression(const Regression& reg)
+{
+    return reg.after_ms > reg.before_ms * kRegressionRatio && reg.after_ms - reg.before_ms >= kRegressionMinMs;
+}
+
+std::vector<Regression> worst_first(std::vector<Regression> regressions)
+{
+    std::erase_if(regressions, [](const Regression& reg) { return !is_regression(reg); });
+    ranges::sort(regressions, std::greater<> {}, [](const Regression& reg) { return reg.after_ms - reg.before_ms; });
+    return regressions;
+}
+
+}
+
+std::int64_t BuildRecord::total_ms() const
+{
+    std::int64_t total = 0;
+    for (const auto& stage : stages) {
+        total += stage.ms;
+    }
+
+    return total;
+}
+
+Regressions cppship::find_regressions(
+    const std::vector<BuildRecord>& history, const std::function<bool(const BuildRecord&)>& is_since)
+{
+    // keyed by target and source
+    std::map<std::pair<std::string, std::string>, std::pair<Mean, Mean>> units;
+    for (const auto& record : history) {
+        for (const auto& unit : record.units) {
+            auto& [before, after] = units[{ unit.target, unit.source }];
+            (is_since(record) ? after : before).add(unit.ms);
+        }
+    }
+
+    Regressions result;
+    std::map<std::string, Regression> targets;
+    for (const auto& [key, means] : units) {
+        const auto& [before, after] = means;
+        if (before.count == 0 || after.count == 0) {
+            continue;
+        }
+
+        const auto& [target, source] = key;
+        result.units.push_back({
+            .name = fmt::format("{} ({})", source, target),
+            .before_ms = before.value(),
+            .after_ms = after.value(),
+        });
+
+        auto& target_reg = targets[target];
+        target_reg.name = target;
+        target_reg.before_ms += before.value();
+        target_reg.after_ms += after.value();
+    }
+
+    for (auto& [_, reg] : targets) {
+        result.targets.push_back(std::move(reg));
+    }
+
+    result.units = worst_first(std::move(result.units));
+    result.targets = worst_first(std::move(result.targets));
+    return result;
+}
+
+Regressions cppship::find_regressions(const std::vector<BuildRecord>& history, std::int64_t cutoff)
+{
+    return find_regressions(history, [cutoff](const BuildRecord& record) { return record.time >= cutoff; });
+}
+
+// written by hand rather than by toml::format, which cannot emit a single element of an array of tables
+void cppship::append_build_record(const fs::path& file, const BuildRecord& record)
+{
+    std::ostringstream out;
+    out << "[[builds]]\n";
+    out << fmt::format("time = {}\ncommit = {}\nprofile = {}\nresult = {}\n",
+        record.time,
+        quote(record.commit),
+        quote(record.profile),
+        record.result);
+    out << fmt::format("prebuilt_hits = {}\nprebuilt_misses = {}\n", record.prebuilt_hits, record.prebuilt_misses);
+
+    out << "stages = [\n";
+    for (const auto& stage : record.stages) {
+        out << fmt::format("  {{ name = {}, ms = {} }},\n", quote(stage.name), stage.ms);
+    }
+    out << "]\nunits = [\n";
+    for (const auto& unit : record.units) {
+        out << fmt::format(
+            "  {{ target = {}, source = {}, ms = {} }},\n", quote(unit.target), quote(unit.source), unit.ms);
+    }
+    out << "]\nlinks = [\n";
+    for (const auto& link : record.links) {
+        out << fmt::format("  {{ output = {}, ms = {} }},\n", quote(link.output), link.ms);
+    }
+    out << "]\n\n";
+
+    std::ofstream ofs(file, std::ios::app | std::ios::binary);
+    ofs << out.str();
+    if (!ofs.flush()) {
+        throw Error { fmt::format("failed to append build history to {}", file.string()) };
+    }
+}
+
+std::vector<BuildRecord> cppship::load_build_history(const fs::path& file)
+{
+    if (!fs::exists(file)) {
+        return {};
+    }
+
+    std::vector<BuildRecord> history;
+    for (const auto& build : find_array(toml::parse(file), "builds")) {
+        history.push_back(record_from_toml(build));
+    }
+
+    return history;
+}
+
+// a v5 line is: start end mtime output hash, separated by tabs
+void history_internals::parse_ninja_log(std::string_view log, BuildRecord& record)
+{
+    std::istringstream iss { std::string { log } };
+    for (std::string line; std::getline(iss, line);) {
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        std::vector<std::string_view> fields;
+        std::string_view rest = line;
+        for (auto pos = rest.find('\t'); pos != std::string_view::npos; pos = rest.find('\t')) {
+            fields.push_back(rest.substr(0, pos));
+            rest.remove_prefix(pos + 1);
+        }
+        fields.push_back(rest);
+        if (fields.size() < 4) {
+            continue;
+        }
+
+        const auto start = parse_ms(fields[0]);
+        const auto end = parse_ms(fields[1]);
+        if (!start || !end) {
+            continue;
+        }
+
+        const auto ms = *end - *start;
+        const std::string_view output = fields[3];
+        const auto target_begin = output.find(kCmakeFilesDir);
+        const auto target_end = output.find(kTargetDirSuffix, target_begin);
+        const bool is_object = boost::ends_with(output, ".o") || boost::ends_with(output, ".obj");
+        if (target_begin == std::string_view::npos || target_end == std::string_view::npos || !is_object) {
+            record.links.push_back({ .output = std::string { output }, .ms = ms });
+            continue;
+        }
+
+        const auto name_begin = target_begin + kCmakeFilesDir.size();
+        const auto target = output.substr(name_begin, target_end - name_begin);
+        auto source = output.substr(target_end + kTargetDirSuffix.size());
+        source.remove_suffix(source.size() - source.rfind('.'));
+        record.units.push_back({ .target = std::string { target }, .source = std::string { source }, .ms = ms });
+    }
+}
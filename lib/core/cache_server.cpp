@@ -0,0 +1,89 @@
+#include "cppship/core/cache_server.h"
+
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "cppship/util/io.h"
+#include "cppship/util/log.h"
+
+using namespace cppship;
+using namespace cppship::util;
+
+namespace {
+
+constexpr unsigned kMinWorkers = 8;
+
+// uploads in flight, kinds never start with a dot
+constexpr std::string_view kUploadDir = ".uploads";
+
+// kind and key must be plain names, so that requests never escape the root
+bool is_valid_name(std::string_view name)
+{
+    return !name.empty() && name.front() != '.' && std::ranges::all_of(name, [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_'
+            || c == '.';
+    });
+}
+
+// target in form of [/prefix]/<kind>/<key>, the prefix is ignored
+std::optional<fs::path> to_blob_path(const fs::path& root, std::string_view target)
+{
+    const auto key_pos = target.rfind('/');
+    if (key_pos == std::string_view::npos || key_pos == 0) {
+        return std::nullopt;
+    }
+
+    const auto kind_pos = target.rfind('/', key_pos - 1);
+    if (kind_pos == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    const auto kind = target.substr(kind_pos + 1, key_pos - kind_pos - 1);
+    const auto key = target.substr(key_pos + 1);
+    if (!is_valid_name(kind) || !is_valid_name(key)) {
+        return std::nullopt;
+    }
+
+    return root / kind / key;
+}
+
+}
+
+CacheServer::CacheServer(fs::path root, std::string_view host, std::uint16_t port, std::uint64_t max_blob_size)
+    : mRoot(std::move(root))
+    , mServer(
+          host, port, [this](const HttpRequest& req) { return handle_(req); },
+          std::max(kMinWorkers, std::thread::hardware_concurrency()), max_blob_size, mRoot / kUploadDir)
+{
+}
+
+HttpResponse CacheServer::handle_(const HttpRequest& req) const
+{
+    HttpResponse res;
+
+    const auto blob = to_blob_path(mRoot, req.target);
+    if (!blob) {
+        res.status = kHttpBadRequest;
+    } else if (req.method == "GET" || req.method == "HEAD") {
+        if (fs::is_regular_file(*blob)) {
+            res.body_file = *blob;
+        } else {
+            res.status = kHttpNotFound;
+        }
+    } else if (req.method == "PUT") {
+        fs::create_directories(blob->parent_path());
+        // uploads are under the root, so moving them in place is atomic
+        if (req.body_file.empty()) {
+            write_atomic(*blob, req.body);
+        } else {
+            fs::rename(req.body_file, *blob);
+        }
+    } else {
+        res.status = kHttpMethodNotAllowed;
+    }
+
+    debug("cache-server {} {} {}", req.method, req.target, res.status);
+    return res;
+}
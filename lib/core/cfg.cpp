@@ -1,8 +1,16 @@
 #include "cppship/core/cfg.h"
 #include "cppship/exception.h"
 
+#include <array>
+#include <cstdlib>
 #include <string>
+#include <utility>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include <boost/algorithm/string/classification.hpp>
 #include <boost/phoenix/bind/bind_member_variable.hpp>
 #include <boost/phoenix/core.hpp>
 #include <boost/phoenix/operator.hpp>
@@ -10,7 +18,13 @@
 #include <boost/spirit/include/qi.hpp>
 #include <fmt/core.h>
 #include <fmt/ostream.h>
+#include <range/v3/algorithm/all_of.hpp>
+#include <range/v3/algorithm/any_of.hpp>
 #include <range/v3/algorithm/equal.hpp>
+#include <range/v3/algorithm/find.hpp>
+
+#include "cppship/util/log.h"
+#include "cppship/util/string.h"
 
 using namespace cppship;
 using namespace cppship::core;
@@ -21,6 +35,13 @@ namespace phoenix = boost::phoenix;
 
 namespace {
 
+constexpr std::array<std::pair<std::string_view, cfg::Feature>, 4> kFeatures { {
+    { "sse4.2", cfg::Feature::sse4_2 },
+    { "avx2", cfg::Feature::avx2 },
+    { "avx512f", cfg::Feature::avx512f },
+    { "neon", cfg::Feature::neon },
+} };
+
 /*
 Syntax
 ConfigurationPredicate :
@@ -32,6 +53,8 @@ ConfigurationPredicate :
 ConfigurationOption :
    [IDENTIFIER] (= ([STRING_LITERAL] | [RAW_STRING_LITERAL]))?
 
+   os, compiler, target_arch and target_feature are supported
+
 ConfigurationAll
    all ( ConfigurationPredicateList? )
 
@@ -59,6 +82,8 @@ struct CfgParser : qi::grammar<std::string_view::const_iterator, CfgPredicate(),
 
         os_symbols.name("os");
         compiler_symbols.name("compiler");
+        arch_symbols.name("target_arch");
+        feature_symbols.name("target_feature");
 
         cfg.name("Cfg");
         cfg_predicate.name("CfgPredicate");
@@ -77,8 +102,17 @@ struct CfgParser : qi::grammar<std::string_view::const_iterator, CfgPredicate(),
         compiler_symbols.add("clang", cfg::Compiler::clang);
         compiler_symbols.add("apple_clang", cfg::Compiler::apple_clang);
 
-        cfg_option
-            = (lit("os") > '=' > '"' > os_symbols > '"') | (lit("compiler") > '=' > '"' > compiler_symbols > '"');
+        for (const auto arch : { cfg::Arch::x86_64, cfg::Arch::aarch64 }) {
+            arch_symbols.add(std::string { cfg::to_string(arch) }, arch);
+        }
+        for (const auto& [name, feature] : kFeatures) {
+            feature_symbols.add(std::string { name }, feature);
+        }
+
+        cfg_option = (lit("os") > '=' > '"' > os_symbols > '"')
+            | (lit("compiler") > '=' > '"' > compiler_symbols > '"')
+            | (lit("target_arch") > '=' > '"' > arch_symbols > '"')
+            | (lit("target_feature") > '=' > '"' > feature_symbols > '"');
         cfg_predicate_list = cfg_predicate[push_back(_val, _1)] % ',';
         cfg_all = lit("all") > '(' > cfg_predicate_list[bind(&CfgAll::predicates, _val) = _1] > ')';
         cfg_any = lit("any") > '(' > cfg_predicate_list[bind(&CfgAny::predicates, _val) = _1] > ')';
@@ -89,6 +123,8 @@ struct CfgParser : qi::grammar<std::string_view::const_iterator, CfgPredicate(),
 
     qi::symbols<char, cfg::Os> os_symbols;
     qi::symbols<char, cfg::Compiler> compiler_symbols;
+    qi::symbols<char, cfg::Arch> arch_symbols;
+    qi::symbols<char, cfg::Feature> feature_symbols;
 
     qi::rule<Iterator, CfgPredicate(), ascii::space_type> cfg;
     qi::rule<Iterator, CfgPredicate(), ascii::space_type> cfg_predicate;
@@ -146,4 +182,182 @@ struct CfgEquals {
 };
 }
 
-bool core::operator==(const CfgPredicate& a, const CfgPredicate& b) { return CfgEquals {}(a, b); }
\ No newline at end of file
+bool core::operator==(const CfgPredicate& a, const CfgPredicate& b) { return CfgEquals {}(a, b); }
+namespace {
+
+// NOLINTBEGIN(misc-no-recursion)
+struct CfgEval {
+    const cfg::Platform& platform; // NOLINT
+
+    bool operator()(const CfgPredicate& cfg) const { return std::visit(*this, cfg); }
+
+    bool operator()(const CfgOption& opt) const { return std::visit(*this, opt); }
+
+    bool operator()(cfg::Os os) const { return os == platform.os; }
+
+    bool operator()(cfg::Compiler compiler) const { return compiler == platform.compiler; }
+
+    bool operator()(cfg::Arch arch) const { return arch == platform.arch; }
+
+    bool operator()(cfg::Feature feature) const { return platform.features.contains(feature); }
+
+    bool operator()(const boost::recursive_wrapper<CfgAll>& cfg) const
+    {
+        return ranges::all_of(cfg.get().predicates, *this);
+    }
+
+    bool operator()(const boost::recursive_wrapper<CfgAny>& cfg) const
+    {
+        return ranges::any_of(cfg.get().predicates, *this);
+    }
+
+    bool operator()(const boost::recursive_wrapper<CfgNot>& cfg) const { return !(*this)(cfg.get().predicate); }
+};
+// NOLINTEND(misc-no-recursion)
+
+}
+
+cfg::Os cfg::current_os()
+{
+#if defined(_WIN32)
+    return Os::windows;
+#elif defined(__APPLE__)
+    return Os::macos;
+#else
+    return Os::linux;
+#endif
+}
+
+std::optional<cfg::Arch> cfg::current_arch()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return Arch::x86_64;
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return Arch::aarch64;
+#else
+    return std::nullopt;
+#endif
+}
+
+std::string_view cfg::to_string(Arch arch)
+{
+    switch (arch) {
+    case Arch::x86_64:
+        return "x86_64";
+
+    case Arch::aarch64:
+        return "aarch64";
+    }
+
+    std::abort();
+}
+
+std::string_view cfg::to_string(Feature feature)
+{
+    const auto* it = ranges::find(kFeatures, feature, &std::pair<std::string_view, Feature>::second);
+    if (it == kFeatures.end()) {
+        std::abort();
+    }
+
+    return it->first;
+}
+
+std::optional<cfg::Feature> cfg::parse_feature(std::string_view feature)
+{
+    const auto* it = ranges::find(kFeatures, feature, &std::pair<std::string_view, Feature>::first);
+    if (it == kFeatures.end()) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+// keep in sync with the detection of generated cmake files, see cmake::generate_feature_detection
+std::set<cfg::Feature> cfg::target_features()
+{
+    std::set<Feature> features;
+
+    if (const char* env = std::getenv(kTargetFeaturesEnv.data())) {
+        for (const auto& name : util::split(std::string { env }, boost::is_any_of(",; "))) {
+            if (name.empty()) {
+                continue;
+            }
+
+            if (const auto feature = parse_feature(name)) {
+                features.insert(*feature);
+            } else {
+                warn("unknown target feature {} in ${}", name, kTargetFeaturesEnv);
+            }
+        }
+
+        return features;
+    }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+    features.insert(Feature::neon);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    constexpr int kSse42Bit = 20;
+    constexpr int kOsxsaveBit = 27;
+    constexpr int kAvx2Bit = 5;
+    constexpr int kAvx512fBit = 16;
+    constexpr unsigned long long kAvxState = 0x6;
+    constexpr unsigned long long kAvx512State = 0xe6;
+
+    std::array<int, 4> regs {};
+    __cpuid(regs.data(), 1);
+    const bool has_xsave = (regs[2] & (1 << kOsxsaveBit)) != 0;
+    const auto xcr0 = has_xsave ? _xgetbv(0) : 0ULL;
+    if ((regs[2] & (1 << kSse42Bit)) != 0) {
+        features.insert(Feature::sse4_2);
+    }
+
+    __cpuidex(regs.data(), 7, 0);
+    if ((xcr0 & kAvxState) == kAvxState && (regs[1] & (1 << kAvx2Bit)) != 0) {
+        features.insert(Feature::avx2);
+    }
+    if ((xcr0 & kAvx512State) == kAvx512State && (regs[1] & (1 << kAvx512fBit)) != 0) {
+        features.insert(Feature::avx512f);
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        features.insert(Feature::sse4_2);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        features.insert(Feature::avx2);
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        features.insert(Feature::avx512f);
+    }
+#endif
+
+    return features;
+}
+
+bool core::eval_cfg(const CfgPredicate& cfg, const cfg::Platform& platform) { return CfgEval { platform }(cfg); }
+
+namespace {
+
+// NOLINTBEGIN(misc-no-recursion)
+struct CfgUsesFeatures {
+    bool operator()(const CfgPredicate& cfg) const { return std::visit(*this, cfg); }
+
+    bool operator()(const CfgOption& opt) const { return std::holds_alternative<cfg::Feature>(opt); }
+
+    bool operator()(const boost::recursive_wrapper<CfgAll>& cfg) const
+    {
+        return ranges::any_of(cfg.get().predicates, *this);
+    }
+
+    bool operator()(const boost::recursive_wrapper<CfgAny>& cfg) const
+    {
+        return ranges::any_of(cfg.get().predicates, *this);
+    }
+
+    bool operator()(const boost::recursive_wrapper<CfgNot>& cfg) const { return (*this)(cfg.get().predicate); }
+};
+// NOLINTEND(misc-no-recursion)
+
+}
+
+bool core::uses_target_features(const CfgPredicate& cfg) { return CfgUsesFeatures {}(cfg); }
@@ -1,10 +1,12 @@
 #include "cppship/core/compiler.h"
 #include "cppship/util/cmd.h"
+#include "cppship/util/fs.h"
 
 #include <cctype>
 #include <cstdlib>
 #include <exception>
 #include <sstream>
+#include <utility>
 
 #include <boost/algorithm/string.hpp>
 
@@ -106,11 +108,28 @@ std::string get_libcxx(CompilerId compiler_id)
 }
 
 CompilerInfo::CompilerInfo()
-    : mCommand(detect_compiler_command())
+    : CompilerInfo(detect_compiler_command())
+{
+}
+
+CompilerInfo::CompilerInfo(std::string command)
+    : mCommand(std::move(command))
     , mVersion(get_compiler_version(mCommand))
 {
-    const auto out = check_output(fmt::format("{} --version | head -n1", mCommand));
+    mVersionLine = boost::trim_copy(check_output(fmt::format("{} --version | head -n1", mCommand)));
 
-    mId = get_compiler_id(out);
+    mId = get_compiler_id(mVersionLine);
     mLibCxx = get_libcxx(mId);
+}
+
+std::string CompilerInfo::fingerprint() const
+{
+    // gcc starts the version line with how it is invoked, c++ and g++-12 may be the same compiler
+    std::string_view version = mVersionLine;
+    if (const auto program = fs::path(mCommand).filename().string(); version.starts_with(program)) {
+        version.remove_prefix(program.size());
+    }
+
+    const auto target = boost::trim_copy(check_output(fmt::format("{} -dumpmachine", mCommand)));
+    return fmt::format("{}; {}; {}", boost::trim_copy(std::string { version }), target, mLibCxx);
 }
\ No newline at end of file
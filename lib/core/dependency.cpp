@@ -2,6 +2,9 @@
 #include "cppship/exception.h"
 #include "cppship/util/string.h"
 
+#include <map>
+#include <regex>
+
 #include <boost/algorithm/string.hpp>
 
 using namespace cppship;
@@ -95,4 +98,71 @@ ResolvedDependencies cppship::collect_conan_deps(const fs::path& conan_dep_dir,
     }
 
     return deps;
-}
\ No newline at end of file
+}
+
+std::vector<fs::path> dep_internals::parse_conan_data_file(const fs::path& data_file, std::string_view profile)
+{
+    std::ifstream ifs(data_file);
+    if (!ifs) {
+        throw Error { fmt::format("cmake data file {} not found", data_file.string()) };
+    }
+
+    // set(fmt_PACKAGE_FOLDER_DEBUG "/root/.conan2/p/fmt/p")
+    // set(fmt_INCLUDE_DIRS_DEBUG "${fmt_PACKAGE_FOLDER_DEBUG}/include")
+    const auto config = boost::to_upper_copy(std::string { profile });
+    const std::regex folder_line { fmt::format(R"re(^set\((\w+_PACKAGE_FOLDER_{}) "([^"]*)"\))re", config) };
+    const std::regex include_line { fmt::format(R"(^set\(\w+_INCLUDE_DIRS_{} (.*)\))", config) };
+    const std::regex quoted { R"re("([^"]*)")re" };
+
+    std::map<std::string, std::string> folders;
+    std::vector<fs::path> dirs;
+    std::string line;
+    std::smatch match;
+    while (std::getline(ifs, line)) {
+        boost::trim(line);
+        if (std::regex_match(line, match, folder_line)) {
+            folders[fmt::format("${{{}}}", match.str(1))] = match.str(2);
+            continue;
+        }
+
+        if (!std::regex_match(line, match, include_line)) {
+            continue;
+        }
+
+        const auto values = match.str(1);
+        const std::sregex_iterator end;
+        for (auto it = std::sregex_iterator(values.begin(), values.end(), quoted); it != end; ++it) {
+            auto dir = it->str(1);
+            for (const auto& [var, folder] : folders) {
+                boost::replace_all(dir, var, folder);
+            }
+
+            dirs.emplace_back(std::move(dir));
+        }
+    }
+
+    return dirs;
+}
+
+std::set<fs::path> cppship::collect_conan_include_dirs(const fs::path& conan_dep_dir, std::string_view profile)
+{
+    std::set<fs::path> dirs;
+    if (!fs::exists(conan_dep_dir)) {
+        return dirs;
+    }
+
+    // fmt-release-x86_64-data.cmake
+    const auto infix = fmt::format("-{}-", boost::to_lower_copy(std::string { profile }));
+    for (const auto& dentry : fs::directory_iterator { conan_dep_dir }) {
+        const std::string filename = dentry.path().filename().string();
+        if (!filename.ends_with("-data.cmake") || !boost::contains(filename, infix)) {
+            continue;
+        }
+
+        for (auto& dir : dep_internals::parse_conan_data_file(dentry.path(), profile)) {
+            dirs.insert(std::move(dir));
+        }
+    }
+
+    return dirs;
+}
@@ -0,0 +1,130 @@
+#include "cppship/core/dependency_graph.h"
+
+#include <set>
+#include <utility>
+
+#include <fmt/format.h>
+#include <range/v3/action/push_back.hpp>
+#include <range/v3/action/reverse.hpp>
+
+#include "cppship/exception.h"
+#include "cppship/util/repo.h"
+
+using namespace cppship;
+
+DependencyGraph::NodeId DependencyGraph::node_(const DeclaredDependency& dep)
+{
+    auto key = fmt::format("{}@{}", dep.package, get<GitDep>(dep.desc).commit);
+    if (const auto it = mNodeIds.find(key); it != mNodeIds.end()) {
+        return it->second;
+    }
+
+    std::unique_ptr<const Manifest> manifest;
+    if (const auto file = mDepsDir / dep.package / kRepoConfigFile; fs::exists(file)) {
+        manifest = std::make_unique<const Manifest>(file);
+        if (manifest->is_workspace()) {
+            throw Error { fmt::format("package {} is a workspace", dep.package) };
+        }
+    }
+
+    const auto id = mNodes.size();
+    mNodes.push_back(Node { .manifest = std::move(manifest), .edges = std::nullopt });
+    mNodeIds.emplace(std::move(key), id);
+    return id;
+}
+
+const std::vector<DependencyGraph::Edge>& DependencyGraph::edges_(NodeId id)
+{
+    auto& node = mNodes[id];
+    if (node.edges) {
+        return *node.edges;
+    }
+
+    std::vector<Edge> edges;
+    if (node.manifest != nullptr) {
+        for (const auto& sub_dep : node.manifest->dependencies()) {
+            edges.push_back(Edge {
+                .dep = &sub_dep,
+                .node = sub_dep.is_git() ? std::optional { node_(sub_dep) } : std::nullopt,
+            });
+        }
+    }
+
+    return node.edges.emplace(std::move(edges));
+}
+
+const Manifest* DependencyGraph::manifest(const DeclaredDependency& dep)
+{
+    std::lock_guard lock(mMutex);
+    return mNodes[node_(dep)].manifest.get();
+}
+
+const ResolveResult& DependencyGraph::resolve(const PackageManifest& manifest)
+{
+    std::lock_guard lock(mMutex);
+    if (const auto it = mResults.find(manifest.name()); it != mResults.end()) {
+        return it->second;
+    }
+
+    // the same bfs as the resolver, over edges rather than manifests
+    ResolveResult result;
+    std::set<std::string, std::less<>> seen;
+    std::vector<Edge> unresolved;
+    for (const auto& dep : manifest.dependencies()) {
+        if (dep.is_git()) {
+            unresolved.push_back(Edge { .dep = &dep, .node = node_(dep) });
+            continue;
+        }
+
+        seen.insert(dep.package);
+        result.conan_dependencies.push_back(dep);
+    }
+
+    for (const auto& dep : manifest.dev_dependencies()) {
+        if (dep.is_git()) {
+            unresolved.push_back(Edge { .dep = &dep, .node = node_(dep) });
+            continue;
+        }
+
+        result.conan_dev_dependencies.push_back(dep);
+    }
+
+    while (!unresolved.empty()) {
+        std::vector<Edge> level;
+        for (const auto& edge : std::exchange(unresolved, {})) {
+            if (seen.insert(edge.dep->package).second) {
+                level.push_back(edge);
+            }
+        }
+
+        for (const auto& edge : level) {
+            for (const auto& sub_edge : edges_(*edge.node)) {
+                const auto& sub_dep = *sub_edge.dep;
+                if (seen.contains(sub_dep.package)) {
+                    continue;
+                }
+
+                if (sub_dep.is_conan()) {
+                    seen.insert(sub_dep.package);
+                    result.conan_dependencies.push_back(sub_dep);
+                    continue;
+                }
+
+                unresolved.push_back(sub_edge);
+            }
+
+            const auto& dep = *edge.dep;
+            result.dependencies.push_back(dep);
+            result.resolved_dependencies.insert(Dependency {
+                .package = dep.package,
+                .cmake_package = dep.package,
+                .cmake_target = fmt::format("cppship::{}", dep.package),
+            });
+        }
+    }
+
+    ranges::push_back(result.dependencies, result.conan_dependencies);
+    ranges::reverse(result.dependencies);
+    ranges::push_back(result.dev_dependencies, result.conan_dev_dependencies);
+    return mResults.emplace(manifest.name(), std::move(result)).first->second;
+}
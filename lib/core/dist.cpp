@@ -0,0 +1,654 @@
+#include "cppship/core/dist.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <limits>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <utility>
+
+#include <BS_thread_pool_light.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/asio/ip/address.hpp>
+#include <boost/process/args.hpp>
+#include <boost/process/exe.hpp>
+#include <boost/process/io.hpp>
+#include <boost/process/start_dir.hpp>
+#include <boost/process/system.hpp>
+#include <fmt/core.h>
+#include <gsl/narrow>
+#include <gsl/util>
+#include <toml.hpp>
+
+#include "cppship/core/compiler.h"
+#include "cppship/exception.h"
+#include "cppship/util/cmd.h"
+#include "cppship/util/hash.h"
+#include "cppship/util/io.h"
+#include "cppship/util/log.h"
+#include "cppship/util/toml.h"
+
+using namespace cppship;
+using namespace cppship::dist;
+
+namespace bp = boost::process;
+
+namespace {
+
+constexpr std::string_view kDefaultPort = "3633";
+constexpr auto kStatusTimeout = std::chrono::seconds(2);
+// each compilation is a launcher process of its own, statuses are shared by them for a while and unreachable workers
+// are not probed again for longer
+constexpr auto kStatusTtl = std::chrono::seconds(2);
+constexpr auto kDeadWorkerTtl = std::chrono::seconds(30);
+constexpr std::size_t kMaxParallelProbes = 16;
+constexpr auto kCompileTimeout = std::chrono::minutes(5);
+
+// preprocessor flags, they are not sent to workers
+constexpr std::array<std::string_view, 12> kPreprocessFlagsWithValue = {
+    "-I", "-isystem", "-iquote", "-idirafter", "-include", "-imacros", "-isysroot", "-D", "-U", "-MF", "-MT", "-MQ" };
+constexpr std::array<std::string_view, 10> kPreprocessFlagPrefixes
+    = { "-I", "-isystem", "-iquote", "-idirafter", "-D", "-U", "-MF", "-MT", "-MQ", "--sysroot=" };
+constexpr std::array<std::string_view, 3> kPreprocessFlags = { "-MD", "-MMD", "-MP" };
+
+// flags for both preprocessing and compilation with a separate value
+constexpr std::array<std::string_view, 3> kFlagsWithValue = { "-target", "-arch", "-Xclang" };
+
+// commands with these flags are compiled locally: not a plain compilation, output of multiple files, depending on
+// local files or the local machine
+constexpr std::array<std::string_view, 14> kLocalOnlyFlags = { "-E", "-S", "-M", "-MM", "-x", "-fsyntax-only",
+    "-save-temps", "-gsplit-dwarf", "-march=native", "-mtune=native", "-mcpu=native", "-ftime-trace", "-wrapper",
+    "-fmodules" };
+constexpr std::array<std::string_view, 10> kLocalOnlyPrefixes = { "@", "-fplugin", "-specs", "-B", "-fprofile-use",
+    "-fprofile-instr-use", "-fprofile-sample-use", "-fsanitize-blacklist", "-fsanitize-ignorelist", "-fmodule" };
+
+// compile args are allowlisted, a worker compiles args from any client and must never load code or write files
+// outside of its job dir, eg. by -fplugin=, -Wa,-a=<file>, -Xassembler, -dumpdir, -save-temps= or --specs=
+constexpr std::array<std::string_view, 2> kSafeFlagsWithValue = { "-target", "-arch" };
+// -f<name>=<value> takes a value only for these, other -f flags must be plain switches
+constexpr std::array<std::string_view, 21> kSafeValuedFFlags = { "-fvisibility=", "-fsanitize=", "-fno-sanitize=",
+    "-fsanitize-recover=", "-fno-sanitize-recover=", "-fsanitize-trap=", "-fno-sanitize-trap=", "-fsanitize-coverage=",
+    "-ftemplate-depth=", "-fconstexpr-depth=", "-fconstexpr-steps=", "-fdiagnostics-color=", "-fmessage-length=",
+    "-ftls-model=", "-fcf-protection=", "-ffp-contract=", "-flto=", "-fopenmp=", "-fdebug-prefix-map=",
+    "-ffile-prefix-map=", "-fmacro-prefix-map=" };
+// -f switches that dump files or load plugins, profiles and modules
+constexpr std::array<std::string_view, 9> kUnsafeFSwitches = { "-fdump", "-fplugin", "-fpass-plugin", "-fmodule",
+    "-fopt-info", "-fprofile", "-ftest-coverage", "-fsave-optimization-record", "-fcrash-diagnostics" };
+
+constexpr std::array<std::string_view, 6> kCppSources = { ".cpp", ".cc", ".cxx", ".c++", ".C", ".c" };
+
+template <std::size_t N> bool contains(const std::array<std::string_view, N>& values, std::string_view value)
+{
+    return std::ranges::find(values, value) != values.end();
+}
+
+template <std::size_t N> bool starts_with_any(const std::array<std::string_view, N>& prefixes, std::string_view value)
+{
+    return std::ranges::any_of(prefixes, [value](std::string_view prefix) { return value.starts_with(prefix); });
+}
+
+bool is_local_only(std::string_view arg)
+{
+    return contains(kLocalOnlyFlags, arg) || starts_with_any(kLocalOnlyPrefixes, arg);
+}
+
+bool is_safe_flag(const std::string& arg)
+{
+    // optimization, debug info, language, warning and machine flags, values of -m flags are never paths
+    static const std::regex safe_flag { R"(-O([0-3sgz]|fast)?|-g(gdb)?[0-3]?|-gdwarf(-[2-5])?|-gline-tables-only)"
+                                        R"(|-g(no-)?column-info|-std=[a-z0-9+]+|-stdlib=[a-z+]+|--target=[\w.-]+)"
+                                        R"(|-w|-W[\w+=-]+|-pedantic(-errors)?|-pthread|-pipe)"
+                                        R"(|-m[\w.+-]+(=[\w.,+-]+)?)" };
+    // plain switches, eg. -fPIC, -fno-exceptions, -fstack-protector-strong
+    static const std::regex f_switch { R"(-f[\w+-]+)" };
+
+    if (arg == "-mllvm") {
+        return false;
+    }
+
+    if (arg.starts_with("-f")) {
+        return starts_with_any(kSafeValuedFFlags, arg)
+            || (std::regex_match(arg, f_switch) && !starts_with_any(kUnsafeFSwitches, arg));
+    }
+
+    return std::regex_match(arg, safe_flag);
+}
+
+fs::path resolve_program(const std::string& program)
+{
+    if (fs::path(program).has_parent_path()) {
+        return program;
+    }
+
+    return find_cmd(program);
+}
+
+int run_program(const std::string& program, const std::vector<std::string>& args)
+{
+    return bp::system(bp::exe = resolve_program(program).string(), bp::args = args);
+}
+
+std::string preprocessed_extension(const fs::path& source)
+{
+    return source.extension() == ".c" ? ".i" : ".ii";
+}
+
+// CompilerInfo runs the compiler several times, the result is cached until the compiler changes
+std::string local_fingerprint(const std::string& compiler)
+{
+    const auto exe = fs::canonical(resolve_program(compiler));
+    const auto stamp = fs::last_write_time(exe).time_since_epoch().count();
+    const auto file = get_cache_dir() / "dist" / util::hash_hex(fmt::format("{}:{}", exe.string(), stamp));
+    if (fs::exists(file)) {
+        return read_binary(file);
+    }
+
+    auto fingerprint = compiler::CompilerInfo(exe.string()).fingerprint();
+    fs::create_directories(file.parent_path());
+    write_atomic(file, fingerprint);
+    return fingerprint;
+}
+
+// file of the worker shared by launchers, kind is dead or status
+fs::path worker_file(const Worker& worker, std::string_view kind)
+{
+    const auto name = util::hash_hex(fmt::format("{}:{}", worker.host, worker.port));
+    return get_cache_dir() / "dist" / fmt::format("{}-{}", kind, name);
+}
+
+bool is_fresh(const fs::path& file, fs::file_time_type::duration ttl)
+{
+    std::error_code ec;
+    const auto mtime = fs::last_write_time(file, ec);
+    return !ec && fs::file_time_type::clock::now() - mtime < ttl;
+}
+
+bool is_known_dead(const Worker& worker) { return is_fresh(worker_file(worker, "dead"), kDeadWorkerTtl); }
+
+struct Load {
+    int slots = 1;
+    int running = 0;
+};
+
+// load of the worker, nullopt if it is unusable
+std::optional<Load> probe(const Worker& worker, std::string_view fingerprint, const std::string& token)
+{
+    const auto marker = worker_file(worker, "dead");
+    const auto status_file = worker_file(worker, "status");
+
+    try {
+        std::string body;
+        if (is_fresh(status_file, kStatusTtl)) {
+            body = read_binary(status_file);
+        } else {
+            auto res = util::http_request(
+                worker.host, worker.port, { .target = "/status", .token = token }, kStatusTimeout);
+            std::error_code ec;
+            fs::remove(marker, ec);
+            if (!res.ok()) {
+                debug("skip worker {}:{}, status {}", worker.host, worker.port, res.status);
+                return std::nullopt;
+            }
+
+            fs::create_directories(status_file.parent_path(), ec);
+            write_atomic(status_file, res.body);
+            body = std::move(res.body);
+        }
+
+        std::istringstream iss(body);
+        const auto status = toml::parse(iss, "status");
+        if (toml::find<std::string>(status, "fingerprint") != fingerprint) {
+            debug("skip worker {}:{}, toolchain mismatch", worker.host, worker.port);
+            return std::nullopt;
+        }
+
+        return Load {
+            .slots = std::max<int>(toml::find<int>(status, "slots"), 1),
+            .running = toml::find<int>(status, "running"),
+        };
+    } catch (const std::exception& e) {
+        debug("skip worker {}:{}, {}", worker.host, worker.port, e.what());
+    }
+
+    std::error_code ec;
+    fs::create_directories(marker.parent_path(), ec);
+    touch(marker);
+    return std::nullopt;
+}
+
+// workers of the same toolchain, those with more free slots more likely first
+std::vector<const Worker*> schedule(
+    const std::vector<Worker>& workers, std::string_view fingerprint, const std::string& token)
+{
+    std::vector<const Worker*> alive;
+    for (const auto& worker : workers) {
+        if (is_known_dead(worker)) {
+            debug("skip worker {}:{}, unreachable recently", worker.host, worker.port);
+            continue;
+        }
+
+        alive.push_back(&worker);
+    }
+    if (alive.empty()) {
+        return {};
+    }
+
+    // probes are network bound, a slow worker delays the others by at most one status timeout
+    BS::thread_pool_light pool(gsl::narrow_cast<BS::concurrency_t>(std::min(alive.size(), kMaxParallelProbes)));
+    std::vector<std::future<std::optional<Load>>> loads;
+    loads.reserve(alive.size());
+    for (const auto* worker : alive) {
+        loads.push_back(pool.submit([worker, fingerprint, &token] { return probe(*worker, fingerprint, token); }));
+    }
+
+    // launchers within the status ttl see the same loads, rather than all going to the least loaded worker, workers
+    // are ordered at random weighted by free slots: the minimum of exponential keys of rate w is the one of weight w
+    // with probability w / sum of w. busy workers go last
+    std::mt19937 rng { std::random_device {}() };
+    std::vector<std::pair<const Worker*, double>> candidates;
+    for (std::size_t i = 0; i < alive.size(); ++i) {
+        if (const auto load = loads[i].get()) {
+            const auto free = load->slots - load->running;
+            const auto key = free > 0 ? std::exponential_distribution<> { static_cast<double>(free) }(rng)
+                                      : std::numeric_limits<double>::infinity();
+            candidates.emplace_back(alive[i], key);
+        }
+    }
+
+    std::ranges::shuffle(candidates, rng);
+    std::ranges::stable_sort(candidates, {}, [](const auto& candidate) { return candidate.second; });
+
+    std::vector<const Worker*> result;
+    for (const auto& [worker, _] : candidates) {
+        result.push_back(worker);
+    }
+
+    return result;
+}
+
+std::optional<int> compile_remote(
+    const std::string& compiler, const CompileJob& job, const std::vector<Worker>& workers, const std::string& token)
+{
+    const auto fingerprint = local_fingerprint(compiler);
+    const auto candidates = schedule(workers, fingerprint, token);
+    if (candidates.empty()) {
+        debug("no worker available for {}", job.source.string());
+        return std::nullopt;
+    }
+
+    // preprocess errors are reported by the local compilation
+    const auto extension = preprocessed_extension(job.source);
+    auto preprocessed = job.output;
+    preprocessed += ".cppship" + extension;
+    auto args = job.preprocess_args;
+    args.insert(args.end(), { "-E", job.source.string(), "-o", preprocessed.string() });
+    const auto cleanup = gsl::finally([&preprocessed] {
+        std::error_code ec;
+        fs::remove(preprocessed, ec);
+    });
+    if (run_program(compiler, args) != 0) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> parts { fingerprint, extension, read_binary(preprocessed) };
+    parts.insert(parts.end(), job.compile_args.begin(), job.compile_args.end());
+    const auto request = dist_internals::pack(parts);
+
+    for (const auto* worker : candidates) {
+        try {
+            const auto res = util::http_request(worker->host,
+                worker->port,
+                { .method = "POST", .target = "/compile", .body = request, .token = token },
+                kCompileTimeout);
+            if (!res.ok()) {
+                debug("worker {}:{} rejected {}: {}", worker->host, worker->port, job.source.string(), res.status);
+                continue;
+            }
+
+            const auto result = dist_internals::unpack(res.body);
+            if (result.size() != 3) {
+                throw Error { "malformed compile response" };
+            }
+
+            const int exit_code = std::stoi(result[0]);
+            std::fwrite(result[1].data(), 1, result[1].size(), stderr);
+            if (exit_code == 0) {
+                write_atomic(job.output, result[2]);
+            }
+
+            debug("compiled {} on {}:{}", job.source.string(), worker->host, worker->port);
+            return exit_code;
+        } catch (const std::exception& e) {
+            debug("compile {} on {}:{} failed: {}", job.source.string(), worker->host, worker->port, e.what());
+        }
+    }
+
+    return std::nullopt;
+}
+
+// dist table of the user config
+toml::value dist_config()
+{
+    const auto file = get_config_file();
+    if (file.empty() || !fs::exists(file)) {
+        return {};
+    }
+
+    const auto config = load_toml(file);
+    return config->contains("dist") ? toml::find(*config, "dist") : toml::value {};
+}
+
+// a worker runs the compiler for whoever reaches it, only local clients are trusted without a token
+std::string checked_token(std::string_view host, std::string token)
+{
+    if (token.empty() && !boost::asio::ip::make_address(std::string { host }).is_loopback()) {
+        throw Error { fmt::format("a token is required to serve on {}, see CPPSHIP_DIST_TOKEN", host) };
+    }
+
+    return token;
+}
+
+// the time taken does not depend on where they differ, so the token cannot be guessed byte by byte
+bool equals_constant_time(std::string_view lhs, std::string_view rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    unsigned char diff = 0;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        diff |= static_cast<unsigned char>(lhs[i] ^ rhs[i]);
+    }
+
+    return diff == 0;
+}
+
+}
+
+std::vector<Worker> dist::parse_workers(std::string_view spec)
+{
+    std::vector<std::string> items;
+    boost::split(items, spec, boost::is_any_of(", "), boost::token_compress_on);
+
+    std::vector<Worker> workers;
+    for (const auto& item : items) {
+        if (item.empty()) {
+            continue;
+        }
+
+        const auto colon = item.rfind(':');
+        Worker worker {
+            .host = item.substr(0, colon),
+            .port = colon == std::string::npos ? std::string { kDefaultPort } : item.substr(colon + 1),
+        };
+        if (worker.host.empty() || worker.port.empty()) {
+            throw Error { fmt::format("invalid worker {}, should be host[:port]", item) };
+        }
+
+        workers.push_back(std::move(worker));
+    }
+
+    return workers;
+}
+
+std::vector<Worker> dist::get_workers()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): environment is never modified
+    if (const auto* spec = std::getenv("CPPSHIP_DIST_WORKERS")) {
+        return parse_workers(spec);
+    }
+
+    return parse_workers(boost::join(toml::find_or<std::vector<std::string>>(dist_config(), "workers", {}), ","));
+}
+
+std::string dist::get_token()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): environment is never modified
+    if (const auto* token = std::getenv("CPPSHIP_DIST_TOKEN")) {
+        return token;
+    }
+
+    return toml::find_or<std::string>(dist_config(), "token", "");
+}
+
+std::optional<CompileJob> dist::dist_internals::parse_compile_args(const std::vector<std::string>& args)
+{
+    CompileJob job;
+    bool compile_only = false;
+    std::vector<fs::path> sources;
+
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const auto& arg = args[i];
+        const bool has_value = i + 1 < args.size();
+
+        if (arg == "-c") {
+            compile_only = true;
+        } else if (arg == "-o") {
+            if (!has_value) {
+                return std::nullopt;
+            }
+            job.output = args[++i];
+        } else if (arg.starts_with("-o")) {
+            job.output = arg.substr(2);
+        } else if (is_local_only(arg)) {
+            return std::nullopt;
+        } else if (contains(kPreprocessFlagsWithValue, arg)) {
+            if (!has_value) {
+                return std::nullopt;
+            }
+            job.preprocess_args.push_back(arg);
+            job.preprocess_args.push_back(args[++i]);
+        } else if (contains(kPreprocessFlags, arg) || starts_with_any(kPreprocessFlagPrefixes, arg)) {
+            job.preprocess_args.push_back(arg);
+        } else if (contains(kFlagsWithValue, arg)) {
+            if (!has_value) {
+                return std::nullopt;
+            }
+            job.preprocess_args.push_back(arg);
+            job.preprocess_args.push_back(args[i + 1]);
+            job.compile_args.push_back(arg);
+            job.compile_args.push_back(args[++i]);
+        } else if (!arg.starts_with('-')) {
+            // inputs other than sources, eg. object files for linking
+            if (!contains(kCppSources, fs::path(arg).extension().string())) {
+                return std::nullopt;
+            }
+            sources.emplace_back(arg);
+        } else {
+            job.preprocess_args.push_back(arg);
+            job.compile_args.push_back(arg);
+        }
+    }
+
+    // workers reject the others, compile them locally in the first place
+    if (!compile_only || job.output.empty() || sources.size() != 1 || !is_safe_compile_args(job.compile_args)) {
+        return std::nullopt;
+    }
+
+    job.source = std::move(sources.front());
+    return job;
+}
+
+bool dist::dist_internals::is_safe_compile_args(const std::vector<std::string>& args)
+{
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        if (contains(kSafeFlagsWithValue, args[i])) {
+            // a target triple or an arch name
+            static const std::regex value { R"([\w.-]+)" };
+            if (++i == args.size() || !std::regex_match(args[i], value)) {
+                return false;
+            }
+        } else if (!is_safe_flag(args[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string dist::dist_internals::pack(const std::vector<std::string>& parts)
+{
+    std::string data;
+    for (const auto& part : parts) {
+        // 8 bytes little endian length
+        auto size = static_cast<std::uint64_t>(part.size());
+        for (int i = 0; i < 8; ++i) {
+            data.push_back(static_cast<char>(size & 0xff));
+            size >>= 8;
+        }
+
+        data += part;
+    }
+
+    return data;
+}
+
+std::vector<std::string> dist::dist_internals::unpack(std::string_view data)
+{
+    std::vector<std::string> parts;
+    while (!data.empty()) {
+        if (data.size() < 8) {
+            throw Error { "malformed dist message" };
+        }
+
+        std::uint64_t size = 0;
+        for (int i = 7; i >= 0; --i) {
+            size = (size << 8) | static_cast<unsigned char>(data[i]);
+        }
+
+        data.remove_prefix(8);
+        if (size > data.size()) {
+            throw Error { "malformed dist message" };
+        }
+
+        parts.emplace_back(data.substr(0, size));
+        data.remove_prefix(size);
+    }
+
+    return parts;
+}
+
+int dist::compile(const std::vector<std::string>& cmd)
+{
+    if (cmd.empty()) {
+        throw Error { "no compiler to launch" };
+    }
+
+    const auto& compiler = cmd.front();
+    const std::vector<std::string> args(cmd.begin() + 1, cmd.end());
+
+    const auto workers = get_workers();
+    if (!workers.empty()) {
+        if (const auto job = dist_internals::parse_compile_args(args)) {
+            try {
+                if (const auto res = compile_remote(compiler, *job, workers, get_token())) {
+                    return *res;
+                }
+            } catch (const std::exception& e) {
+                warn("distributed compilation of {} failed: {}", job->source.string(), e.what());
+            }
+        }
+    }
+
+    return run_program(compiler, args);
+}
+
+WorkerServer::WorkerServer(
+    std::string compiler, std::string_view host, std::uint16_t port, unsigned slots, std::string token)
+    : mCompiler(resolve_program(compiler).string())
+    , mFingerprint(compiler::CompilerInfo(mCompiler).fingerprint())
+    , mSlots(std::max(slots, 1U))
+    , mToken(checked_token(host, std::move(token)))
+    , mServer(
+          host, port, [this](const util::HttpRequest& req) { return handle_(req); }, mSlots * 2)
+{
+}
+
+util::HttpResponse WorkerServer::handle_(const util::HttpRequest& req)
+{
+    if (!mToken.empty() && !equals_constant_time(req.token, mToken)) {
+        return { .status = util::kHttpUnauthorized };
+    }
+
+    if (req.method == "GET" && req.target == "/status") {
+        const toml::value status {
+            { "fingerprint", mFingerprint },
+            { "slots", mSlots },
+            { "running", mRunning.load() },
+        };
+
+        return { .body = toml::format(status) };
+    }
+
+    if (req.method == "POST" && req.target == "/compile") {
+        return compile_(req.body);
+    }
+
+    return { .status = util::kHttpNotFound };
+}
+
+util::HttpResponse WorkerServer::compile_(std::string_view body)
+{
+    std::vector<std::string> parts;
+    try {
+        parts = dist_internals::unpack(body);
+    } catch (const Error&) {
+        return { .status = util::kHttpBadRequest };
+    }
+
+    if (parts.size() < 3) {
+        return { .status = util::kHttpBadRequest };
+    }
+
+    // never compile for a different toolchain, the objects would not link or behave differently
+    if (parts[0] != mFingerprint) {
+        return { .status = util::kHttpConflict };
+    }
+
+    const auto& extension = parts[1];
+    const std::vector<std::string> args(parts.begin() + 3, parts.end());
+    if ((extension != ".i" && extension != ".ii") || !dist_internals::is_safe_compile_args(args)) {
+        return { .status = util::kHttpBadRequest };
+    }
+
+    // busy, let the launcher try others or compile locally
+    if (++mRunning > mSlots) {
+        --mRunning;
+        return { .status = util::kHttpServiceUnavailable };
+    }
+    const auto release = gsl::finally([this] { --mRunning; });
+
+    const auto dir = fs::temp_directory_path() / fmt::format("cppship-worker-{}-{}", port(), mJobId++);
+    fs::create_directories(dir);
+    const auto cleanup = gsl::finally([&dir] {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    });
+
+    const auto source = dir / ("source" + extension);
+    const auto object = dir / "source.o";
+    const auto errors = dir / "stderr";
+    write_atomic(source, parts[2]);
+
+    auto compile_args = args;
+    compile_args.insert(compile_args.end(), { "-c", source.string(), "-o", object.string() });
+    const int exit_code = bp::system(bp::exe = mCompiler,
+        bp::args = compile_args,
+        bp::start_dir = dir.string(),
+        bp::std_in<bp::null, bp::std_out> bp::null,
+        bp::std_err > errors.string());
+
+    return { .body = dist_internals::pack({
+                 std::to_string(exit_code),
+                 fs::exists(errors) ? read_binary(errors) : "",
+                 exit_code == 0 ? read_binary(object) : "",
+             }) };
+}
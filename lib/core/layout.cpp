@@ -1,119 +1,201 @@
 #include "cppship/core/layout.h"
 #include "cppship/exception.h"
+#include "cppship/util/binary.h"
 #include "cppship/util/repo.h"
 
+#include <cstdint>
+#include <set>
+#include <span>
+#include <utility>
+#include <vector>
+
 #include <boost/algorithm/string.hpp>
 #include <fmt/core.h>
-#include <range/v3/action.hpp>
 #include <range/v3/algorithm/mismatch.hpp>
-#include <range/v3/range/conversion.hpp>
-#include <range/v3/view.hpp>
 
 using namespace cppship;
-using namespace ranges::views;
 
 namespace {
 
 constexpr std::string_view kCppExtension = ".cpp";
 constexpr std::string_view kTestSuffix = "_test";
 
+std::set<fs::path> list_sources_from(const SourceIndex* index, const fs::path& dir)
+{
+    return index == nullptr ? list_sources(dir) : index->list_sources(dir);
+}
+
+std::set<fs::path> list_cpp_files_from(const SourceIndex* index, const fs::path& dir)
+{
+    return index == nullptr ? list_cpp_files(dir) : index->list_cpp_files(dir);
+}
+
+void write_ids(std::ostream& os, std::span<const PathId> ids)
+{
+    write_pod(os, static_cast<std::uint32_t>(ids.size()));
+    for (const auto id : ids) {
+        write_pod(os, id);
+    }
+}
+
+std::vector<PathId> read_ids(std::istream& is, std::size_t table_size)
+{
+    const auto size = read_pod<std::uint32_t>(is);
+
+    std::vector<PathId> ids;
+    for (std::uint32_t i = 0; i < size && is; ++i) {
+        const auto id = read_pod<PathId>(is);
+        if (id >= table_size) {
+            is.setstate(std::ios::failbit);
+            break;
+        }
+
+        ids.push_back(id);
+    }
+
+    return ids;
+}
+
+void write_target(std::ostream& os, const Target& target)
+{
+    write_string(os, target.name);
+    write_ids(os, target.includes.ids());
+    write_ids(os, target.sources.ids());
+}
+
+template <class Targets> void write_targets(std::ostream& os, const Targets& targets)
+{
+    write_pod(os, static_cast<std::uint32_t>(targets.size()));
+    for (const auto& [_, target] : targets) {
+        write_target(os, target);
+    }
+}
+
+template <class Targets> const Target* find_target(const Targets& targets, std::string_view name)
+{
+    auto iter = targets.find(name);
+    return iter == targets.end() ? nullptr : &iter->second;
+}
+
 }
 
-Layout::Layout(const fs::path& root, const std::string_view name)
+Layout::Layout(const fs::path& root, const std::string_view name, const SourceIndex* index)
     : mRoot(root)
     , mName(name)
 {
-    scan_binaries_();
-    scan_examples_();
-    scan_benches_();
-    scan_tests_();
-    scan_lib_();
+    std::vector<PathId> sources;
+    scan_binaries_(index, sources);
+    scan_examples_(index, sources);
+    scan_benches_(index, sources);
+    scan_tests_(index, sources);
+    scan_lib_(index, sources);
+
+    mSources = make_set_(std::move(sources));
 }
 
-void Layout::scan_binaries_()
+void Layout::scan_binaries_(const SourceIndex* index, std::vector<PathId>& sources)
 {
-    std::set<fs::path> cpp4_binary_seen;
-
-    for (const auto& path : list_cpp_files(mRoot / kSrcPath / kBinPath)) {
-        mSources.insert(path);
-        cpp4_binary_seen.insert(path);
+    const auto src_dir = mRoot / kSrcPath;
+    const auto bin_dir = src_dir / kBinPath;
+
+    // walk src once: src/bin/*.cpp are standalone binaries, the others make up the default binary
+    std::vector<PathId> bin_files;
+    for (const auto& path : list_sources_from(index, src_dir)) {
+        if (path.parent_path() == bin_dir) {
+            const auto id = mPaths->intern(path);
+            sources.push_back(id);
+
+            const auto name = path.stem().string();
+            const auto& [_, ok] = mBinaries.emplace(name, Target { .name = name, .sources = make_set_({ id }) });
+            if (!ok) {
+                throw LayoutError { fmt::format("binary {} already exists", name) };
+            }
+
+            continue;
+        }
 
-        const auto name = path.stem().string();
-        const auto& [_, ok] = mBinaries.emplace(name, Target { .name = name, .sources = { path } });
-        if (!ok) {
-            throw LayoutError { fmt::format("binary {} already exists", name) };
+        // nested directories of src/bin are not part of any binary
+        if (ranges::mismatch(bin_dir, path).in1 == bin_dir.end()) {
+            continue;
         }
+
+        bin_files.push_back(mPaths->intern(path));
     }
 
-    const auto sources = list_sources(mRoot / kSrcPath);
-    const auto bin_files = sources | filter([bin_dir = mRoot / kSrcPath / kBinPath](const fs::path& path) {
-        return ranges::mismatch(bin_dir, path).in1 != bin_dir.end();
-    }) | ranges::to<std::set<fs::path>>();
     if (!bin_files.empty()) {
         if (mBinaries.contains(mName)) {
             throw LayoutError { fmt::format("binary {} already exists", mName) };
         }
 
-        mBinaries.emplace(mName, Target { .name = mName, .includes = { mRoot / kSrcPath }, .sources = bin_files });
-
-        ranges::insert(mSources, bin_files);
+        sources.insert(sources.end(), bin_files.begin(), bin_files.end());
+        mBinaries.emplace(mName,
+            Target {
+                .name = mName,
+                .includes = make_set_({ mPaths->intern(src_dir) }),
+                .sources = make_set_(std::move(bin_files)),
+            });
     }
 }
 
-void Layout::scan_benches_()
+void Layout::scan_benches_(const SourceIndex* index, std::vector<PathId>& sources)
 {
-    for (const auto& path : list_cpp_files(mRoot / kBenchesPath)) {
-        mSources.insert(path);
+    for (const auto& path : list_cpp_files_from(index, mRoot / kBenchesPath)) {
+        const auto id = mPaths->intern(path);
+        sources.push_back(id);
 
         const auto name = path.stem().string();
-        mBenches.emplace(name, Target { .name = name, .sources = { path } });
+        mBenches.emplace(name, Target { .name = name, .sources = make_set_({ id }) });
     }
 }
 
-void Layout::scan_tests_()
+void Layout::scan_tests_(const SourceIndex* index, std::vector<PathId>& sources)
 {
-    for (const auto& path : list_sources(mRoot / kTestsPath)) {
-        mSources.insert(path);
+    for (const auto& path : list_sources_from(index, mRoot / kTestsPath)) {
+        const auto id = mPaths->intern(path);
+        sources.push_back(id);
 
         // a/b/c.cpp => a_b_c
         const auto rel_path = path.lexically_relative(mRoot / kTestsPath).generic_string();
         const auto name = boost::replace_all_copy(rel_path, "/", "_").substr(0, rel_path.size() - kCppExtension.size());
 
-        mTests.emplace(name, Target { .name = name, .sources = { path } });
+        mTests.emplace(name, Target { .name = name, .sources = make_set_({ id }) });
     }
 }
 
-void Layout::scan_examples_()
+void Layout::scan_examples_(const SourceIndex* index, std::vector<PathId>& sources)
 {
-    for (const auto& path : list_cpp_files(mRoot / kExamplesPath)) {
-        mSources.insert(path);
+    for (const auto& path : list_cpp_files_from(index, mRoot / kExamplesPath)) {
+        const auto id = mPaths->intern(path);
+        sources.push_back(id);
 
         const auto name = path.stem().string();
-        mExamples.emplace(name, Target { .name = name, .sources = { path } });
+        mExamples.emplace(name, Target { .name = name, .sources = make_set_({ id }) });
     }
 }
 
-void Layout::scan_lib_()
+void Layout::scan_lib_(const SourceIndex* index, std::vector<PathId>& sources)
 {
-    std::set<fs::path> lib_sources;
-    std::set<fs::path> lib_test_sources;
-    for (const auto& path : list_sources(mRoot / kLibPath)) {
-        mSources.insert(path);
+    std::vector<PathId> lib_sources;
+    std::vector<PathId> lib_test_sources;
+    for (const auto& path : list_sources_from(index, mRoot / kLibPath)) {
+        const auto id = mPaths->intern(path);
+        sources.push_back(id);
 
         if (path.stem().string().ends_with(kTestSuffix)) {
-            lib_test_sources.insert(path);
+            lib_test_sources.push_back(id);
         } else {
-            lib_sources.insert(path);
+            lib_sources.push_back(id);
         }
     }
 
-    for (const auto& path : lib_test_sources) {
+    for (const auto id : lib_test_sources) {
+        const auto path = (*mPaths)[id];
         const auto rel_path = path.lexically_relative(mRoot / kLibPath).generic_string();
         // a/b/c_test.cpp => a_b_c
         const auto name = boost::replace_all_copy(rel_path, "/", "_")
                               .substr(0, rel_path.size() - kCppExtension.size() - kTestSuffix.size());
 
-        const auto& [_, ok] = mTests.emplace(name, Target { .name = name, .sources = { path } });
+        const auto& [_, ok] = mTests.emplace(name, Target { .name = name, .sources = make_set_({ id }) });
         if (!ok) {
             throw LayoutError { fmt::format("test {} already exist", name) };
         }
@@ -124,59 +206,87 @@ void Layout::scan_lib_()
     }
     mLib.emplace(Target {
         .name = mName,
-        .includes = { mRoot / kIncludePath },
-        .sources = lib_sources,
+        .includes = make_set_({ mPaths->intern(mRoot / kIncludePath) }),
+        .sources = make_set_(std::move(lib_sources)),
     });
 }
 
-std::set<fs::path> Layout::all_files() const { return mSources; }
-
-std::optional<Target> Layout::lib() const { return mLib; }
-
-std::optional<Target> Layout::binary(std::string_view name) const
+void Layout::save(std::ostream& os) const
 {
-    auto iter = mBinaries.find(name);
-    if (iter == mBinaries.end()) {
-        return std::nullopt;
+    write_string(os, mRoot.string());
+    write_string(os, mName);
+
+    write_pod(os, static_cast<std::uint32_t>(mPaths->size()));
+    for (PathId id = 0; id < mPaths->size(); ++id) {
+        write_string(os, (*mPaths)[id].string());
     }
 
-    return iter->second;
+    write_ids(os, mSources.ids());
+    write_pod(os, static_cast<std::uint8_t>(mLib.has_value()));
+    if (mLib) {
+        write_target(os, *mLib);
+    }
+    write_targets(os, mBinaries);
+    write_targets(os, mExamples);
+    write_targets(os, mBenches);
+    write_targets(os, mTests);
 }
 
-std::optional<Target> Layout::example(std::string_view name) const
+std::optional<Layout> Layout::load(std::istream& is)
 {
-    auto iter = mExamples.find(name);
-    if (iter == mExamples.end()) {
+    Layout layout;
+    layout.mRoot = read_string(is);
+    layout.mName = read_string(is);
+
+    const auto size = read_pod<std::uint32_t>(is);
+    for (std::uint32_t i = 0; i < size && is; ++i) {
+        layout.mPaths->intern(read_string(is));
+    }
+    if (!is || layout.mPaths->size() != size) {
         return std::nullopt;
     }
 
-    return iter->second;
-}
+    // braced initializers are evaluated in order
+    const auto read_target = [&] {
+        return Target {
+            .name = read_string(is),
+            .includes = layout.make_set_(read_ids(is, size)),
+            .sources = layout.make_set_(read_ids(is, size)),
+        };
+    };
+    const auto read_targets = [&](std::map<std::string, Target, std::less<>>& targets) {
+        const auto count = read_pod<std::uint32_t>(is);
+        for (std::uint32_t i = 0; i < count && is; ++i) {
+            auto target = read_target();
+            targets.emplace(target.name, std::move(target));
+        }
+    };
 
-std::optional<Target> Layout::bench(std::string_view name) const
-{
-    auto iter = mBenches.find(name);
-    if (iter == mBenches.end()) {
+    layout.mSources = layout.make_set_(read_ids(is, size));
+    if (read_pod<std::uint8_t>(is) != 0) {
+        layout.mLib.emplace(read_target());
+    }
+    read_targets(layout.mBinaries);
+    read_targets(layout.mExamples);
+    read_targets(layout.mBenches);
+    read_targets(layout.mTests);
+    if (!is) {
         return std::nullopt;
     }
 
-    return iter->second;
-}
-
-std::optional<Target> Layout::test(std::string_view name) const
-{
-    auto iter = mTests.find(name);
-    if (iter == mTests.end()) {
+    // a lib without sources exists as long as its include dir does, which the index does not list
+    const auto& lib = layout.mLib;
+    if ((!lib || lib->sources.empty()) && lib.has_value() != fs::exists(layout.mRoot / kIncludePath)) {
         return std::nullopt;
     }
 
-    return iter->second;
+    return layout;
 }
 
-std::vector<Target> Layout::binaries() const { return mBinaries | values | ranges::to<std::vector>(); }
+const Target* Layout::binary(std::string_view name) const { return find_target(mBinaries, name); }
 
-std::vector<Target> Layout::examples() const { return mExamples | values | ranges::to<std::vector>(); }
+const Target* Layout::example(std::string_view name) const { return find_target(mExamples, name); }
 
-std::vector<Target> Layout::benches() const { return mBenches | values | ranges::to<std::vector>(); }
+const Target* Layout::bench(std::string_view name) const { return find_target(mBenches, name); }
 
-std::vector<Target> Layout::tests() const { return mTests | values | ranges::to<std::vector>(); }
\ No newline at end of file
+const Target* Layout::test(std::string_view name) const { return find_target(mTests, name); }
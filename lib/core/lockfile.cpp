@@ -0,0 +1,251 @@
+#include "cppship/core/lockfile.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <range/v3/algorithm/sort.hpp>
+#include <toml.hpp>
+
+#include "cppship/exception.h"
+#include "cppship/util/hash.h"
+#include "cppship/util/io.h"
+#include "cppship/util/log.h"
+
+using namespace cppship;
+
+namespace {
+
+constexpr std::int64_t kLockVersion = 1;
+
+// ordered tables keep the lockfile stable across runs, so it diffs well in vcs
+using LockValue = toml::basic_value<toml::discard_comments, std::map, std::vector>;
+using LockTable = LockValue::table_type;
+using LockArray = LockValue::array_type;
+
+LockValue to_lock(const DeclaredDependency& dep)
+{
+    LockTable table { { "package", dep.package } };
+    if (!dep.components.empty()) {
+        table.emplace("components", LockArray(dep.components.begin(), dep.components.end()));
+    }
+
+    if (const auto* conan = std::get_if<ConanDep>(&dep.desc)) {
+        table.emplace("version", conan->version);
+
+        if (!conan->options.empty()) {
+            LockTable options;
+            for (const auto& [key, val] : conan->options) {
+                options.emplace(key, val);
+            }
+
+            table.emplace("options", std::move(options));
+        }
+    } else {
+        const auto& git = std::get<GitDep>(dep.desc);
+        table.emplace("git", git.git);
+        table.emplace("commit", git.commit);
+        if (git.sparse) {
+            table.emplace("sparse", true);
+        }
+    }
+
+    return table;
+}
+
+DeclaredDependency declared_from_lock(const LockValue& value)
+{
+    DeclaredDependency dep {
+        .package = toml::find<std::string>(value, "package"),
+        .components = toml::find_or<std::vector<std::string>>(value, "components", {}),
+    };
+
+    if (value.contains("git")) {
+        GitDep git {
+            .git = toml::find<std::string>(value, "git"),
+            .commit = toml::find<std::string>(value, "commit"),
+            .sparse = toml::find_or<bool>(value, "sparse", false),
+        };
+        // manifests reject it too, it would reach git as an empty argument
+        if (git.commit.empty()) {
+            throw Error { fmt::format("empty commit for git dependency {}", dep.package) };
+        }
+
+        dep.desc = std::move(git);
+    } else {
+        const LockTable empty_table;
+
+        ConanDep conan { .version = toml::find<std::string>(value, "version") };
+        for (const auto& [key, val] : toml::find_or<LockTable>(value, "options", empty_table)) {
+            conan.options.emplace(key, val.as_string().str);
+        }
+
+        dep.desc = std::move(conan);
+    }
+
+    return dep;
+}
+
+LockValue to_lock(const Dependency& dep)
+{
+    return LockTable {
+        { "package", dep.package },
+        { "cmake_package", dep.cmake_package },
+        { "cmake_target", dep.cmake_target },
+        { "components", LockArray(dep.components.begin(), dep.components.end()) },
+    };
+}
+
+Dependency resolved_from_lock(const LockValue& value)
+{
+    return Dependency {
+        .package = toml::find<std::string>(value, "package"),
+        .cmake_package = toml::find<std::string>(value, "cmake_package"),
+        .cmake_target = toml::find<std::string>(value, "cmake_target"),
+        .components = toml::find_or<std::vector<std::string>>(value, "components", {}),
+    };
+}
+
+template <class Deps> LockArray to_lock_array(const Deps& deps)
+{
+    LockArray array;
+    for (const auto& dep : deps) {
+        array.push_back(to_lock(dep));
+    }
+
+    return array;
+}
+
+std::vector<DeclaredDependency> declared_list_from_lock(const LockValue& value, const std::string& key)
+{
+    const LockArray empty_array;
+
+    std::vector<DeclaredDependency> deps;
+    for (const auto& dep : toml::find_or<LockArray>(value, key, empty_array)) {
+        deps.push_back(declared_from_lock(dep));
+    }
+
+    return deps;
+}
+
+// fingerprint is not checked if nullopt
+std::optional<ResolveResult> parse_lockfile(const fs::path& file, std::optional<std::string_view> fingerprint)
+{
+    if (!fs::exists(file)) {
+        return std::nullopt;
+    }
+
+    try {
+        std::istringstream iss(read_as_string(file));
+        const auto value = toml::parse<toml::discard_comments, std::map, std::vector>(iss, file.string());
+        if (toml::find_or<std::int64_t>(value, "version", 0) != kLockVersion
+            || (fingerprint && toml::find_or<std::string>(value, "fingerprint", "") != *fingerprint)) {
+            debug("lockfile {} is outdated", file.string());
+            return std::nullopt;
+        }
+
+        ResolveResult result {
+            .conan_dependencies = declared_list_from_lock(value, "conan_dependencies"),
+            .conan_dev_dependencies = declared_list_from_lock(value, "conan_dev_dependencies"),
+            .dependencies = declared_list_from_lock(value, "dependencies"),
+            .dev_dependencies = declared_list_from_lock(value, "dev_dependencies"),
+        };
+        const LockArray empty_array;
+        for (const auto& dep : toml::find_or<LockArray>(value, "resolved_dependencies", empty_array)) {
+            result.resolved_dependencies.insert(resolved_from_lock(dep));
+        }
+
+        return result;
+    } catch (const toml::exception& e) {
+        warn("ignore invalid lockfile {}: {}", file.string(), e.what());
+        return std::nullopt;
+    } catch (const std::out_of_range& e) {
+        warn("ignore invalid lockfile {}: {}", file.string(), e.what());
+        return std::nullopt;
+    } catch (const Error& e) {
+        warn("ignore invalid lockfile {}: {}", file.string(), e.what());
+        return std::nullopt;
+    }
+}
+
+}
+
+std::string cppship::dependency_fingerprint(const Manifest& manifest)
+{
+    // the order of deps depends on the toml table implementation, not the manifest
+    const auto sorted = [](std::vector<DeclaredDependency> deps) {
+        ranges::sort(deps, std::less<> {}, &DeclaredDependency::package);
+        return LockValue(to_lock_array(deps));
+    };
+
+    util::Hasher hasher;
+    hasher.update(std::to_string(kLockVersion));
+    hasher.update(toml::format(sorted(manifest.dependencies())));
+    hasher.update(toml::format(sorted(manifest.dev_dependencies())));
+
+    return hasher.hex();
+}
+
+void cppship::save_lockfile(const fs::path& file, std::string_view fingerprint, const ResolveResult& result)
+{
+    const LockValue value = LockTable {
+        { "version", kLockVersion },
+        { "fingerprint", std::string { fingerprint } },
+        { "conan_dependencies", to_lock_array(result.conan_dependencies) },
+        { "conan_dev_dependencies", to_lock_array(result.conan_dev_dependencies) },
+        { "dependencies", to_lock_array(result.dependencies) },
+        { "dev_dependencies", to_lock_array(result.dev_dependencies) },
+        { "resolved_dependencies", to_lock_array(result.resolved_dependencies) },
+    };
+
+    write(file,
+        fmt::format("# generated by cppship, do not edit\n{}", toml::format(value, 0 /* never inline tables */)));
+}
+
+std::optional<ResolveResult> cppship::load_lockfile(const fs::path& file, std::string_view fingerprint)
+{
+    return parse_lockfile(file, fingerprint);
+}
+
+std::optional<std::set<std::string>> cppship::changed_conan_packages(
+    const fs::path& file, const ResolveResult& result)
+{
+    const auto locked = parse_lockfile(file, std::nullopt);
+    if (!locked) {
+        return std::nullopt;
+    }
+
+    const auto declared = [](const ResolveResult& result) {
+        std::map<std::string, std::set<std::string>> packages;
+        for (const auto* deps : { &result.conan_dependencies, &result.conan_dev_dependencies }) {
+            for (const auto& dep : *deps) {
+                packages[dep.package].insert(toml::format(to_lock(dep)));
+            }
+        }
+
+        return packages;
+    };
+
+    const auto before = declared(*locked);
+    const auto after = declared(result);
+
+    std::set<std::string> changed;
+    for (const auto& [package, decls] : before) {
+        if (const auto it = after.find(package); it == after.end() || it->second != decls) {
+            changed.insert(package);
+        }
+    }
+    for (const auto& [package, _] : after) {
+        if (!before.contains(package)) {
+            changed.insert(package);
+        }
+    }
+
+    return changed;
+}
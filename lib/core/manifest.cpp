@@ -3,15 +3,20 @@
 #include <array>
 #include <cstdlib>
 #include <filesystem>
+#include <map>
 #include <set>
+#include <utility>
 
 #include <boost/algorithm/string.hpp>
 #include <fmt/os.h>
 #include <range/v3/action/push_back.hpp>
 #include <range/v3/algorithm/any_of.hpp>
 #include <range/v3/algorithm/find.hpp>
+#include <range/v3/algorithm/reverse.hpp>
+#include <range/v3/range/conversion.hpp>
 #include <range/v3/view/concat.hpp>
 #include <range/v3/view/filter.hpp>
+#include <range/v3/view/map.hpp>
 #include <toml.hpp>
 #include <toml/get.hpp>
 #include <toml/value.hpp>
@@ -21,6 +26,7 @@
 #include "cppship/util/fs.h"
 #include "cppship/util/io.h"
 #include "cppship/util/repo.h"
+#include "cppship/util/toml.h"
 
 using namespace cppship;
 using namespace ranges;
@@ -123,6 +129,7 @@ std::vector<DeclaredDependency> parse_dependencies(const toml::value& manifest,
                 GitDep desc;
                 desc.git = toml::find<std::string>(dep_config, "git");
                 desc.commit = find_or<std::string>(dep_config, "commit", "");
+                desc.sparse = get_bool(dep_config, "sparse").value_or(false);
                 if (desc.git.empty()) {
                     throw Error { fmt::format("invalid git url {}", desc.git) };
                 }
@@ -191,6 +198,66 @@ ProfileConfig parse_profile_options(const toml::value& manifest, const std::stri
     return config;
 }
 
+void append_config(ProfileConfig& to, const ProfileConfig& from)
+{
+    to.cxxflags.insert(to.cxxflags.end(), from.cxxflags.begin(), from.cxxflags.end());
+    to.linkflags.insert(to.linkflags.end(), from.linkflags.begin(), from.linkflags.end());
+    to.definitions.insert(to.definitions.end(), from.definitions.begin(), from.definitions.end());
+
+    for (const auto& [field, value] : { std::pair { &ProfileConfig::ubsan, from.ubsan },
+             std::pair { &ProfileConfig::tsan, from.tsan },
+             std::pair { &ProfileConfig::asan, from.asan },
+             std::pair { &ProfileConfig::leak, from.leak } }) {
+        if (value) {
+            to.*field = value;
+        }
+    }
+}
+
+ConditionConfig when_msvc(bool msvc, ProfileConfig config)
+{
+    return {
+        .condition = core::parse_cfg(msvc ? R"(cfg(compiler = "msvc"))" : R"(cfg(not(compiler = "msvc")))"),
+        .config = std::move(config),
+    };
+}
+
+// profiles every package has, [profile.<name>] of them appends to the predefined options
+std::map<Profile, std::pair<Profile, ProfileOptions>> predefined_profiles()
+{
+    std::map<Profile, std::pair<Profile, ProfileOptions>> profiles;
+
+    // release with debug info and frame pointers, for perf and friends
+    profiles.emplace(Profile { kProfileProfiling },
+        std::pair { Profile::release,
+            ProfileOptions {
+                .config = {},
+                .conditional_configs = {
+                    when_msvc(false, { .cxxflags = { "-g", "-fno-omit-frame-pointer" } }),
+                    when_msvc(true, { .cxxflags = { "/Zi", "/Oy-" }, .linkflags = { "/DEBUG" } }),
+                },
+            } });
+
+    // release tuned for the build machine, the default of cppship bench
+    profiles.emplace(Profile { kProfileBench },
+        std::pair { Profile::release,
+            ProfileOptions {
+                .config = {},
+                .conditional_configs = { when_msvc(false, { .cxxflags = { "-march=native" } }) },
+            } });
+
+    // release collecting profile data for profile guided optimization
+    profiles.emplace(Profile { kProfileInstrumented },
+        std::pair { Profile::release,
+            ProfileOptions {
+                .config = {},
+                .conditional_configs = { when_msvc(false,
+                    { .cxxflags = { "-fprofile-generate" }, .linkflags = { "-fprofile-generate" } }) },
+            } });
+
+    return profiles;
+}
+
 }
 
 PackageManifest::PackageManifest(const toml::value& value)
@@ -205,12 +272,42 @@ PackageManifest::PackageManifest(const toml::value& value)
 
     check_dependency_dups(mDependencies, mDevDependencies);
 
-    // parse [profile] and [profile.debug]
+    // parse [profile] and [profile.<name>]
     mProfileDefault.config = parse_profile_options(value, "profile");
 
-    const auto profile = find_or(value, "profile", {});
-    mProfileDebug.config = parse_profile_options(profile, "debug");
-    mProfileRelease.config = parse_profile_options(profile, "release");
+    mProfiles[Profile::debug] = {};
+    mProfiles[Profile::release] = {};
+    for (auto& [prof, decl] : predefined_profiles()) {
+        mInherits.emplace(prof, std::move(decl.first));
+        mProfiles.emplace(prof, std::move(decl.second));
+    }
+
+    for (const auto& [name, table] : get_table(value, "profile")) {
+        if (!table.is_table()) {
+            continue;
+        }
+
+        const auto prof = parse_profile(name);
+        auto& options = mProfiles[prof];
+        append_config(options.config, parse_profile_options(value.at("profile"), name));
+        if (table.contains("inherits")) {
+            if (prof.is_build_type()) {
+                throw Error { fmt::format("profile {} cannot inherit other profiles", name) };
+            }
+
+            mInherits.insert_or_assign(prof, parse_profile(get<std::string>(table, "inherits")));
+        } else if (!mInherits.contains(prof) && !prof.is_build_type()) {
+            throw Error { fmt::format("profile {} should inherit debug, release or another profile", name) };
+        }
+    }
+
+    for (const auto& [prof, _] : mInherits) {
+        profile_chain(prof);
+    }
+
+    for (const auto& source : get_list(find_or(value, "lib", {}), "multiversion")) {
+        mMultiversionSources.emplace_back(source);
+    }
 
     // parse [target.<cfg>.profile]
     for (const auto& [condition_str, config] : get_table(value, "target")) {
@@ -225,33 +322,69 @@ PackageManifest::PackageManifest(const toml::value& value)
             .config = parse_profile_options(config, "profile"),
         });
 
+        // [target.<cfg>.profile.<name>]
         const auto profile = get_table(config, "profile");
-        if (profile.contains("debug")) {
-            mProfileDebug.conditional_configs.push_back({
-                .condition = condition,
-                .config = parse_profile_options(profile, "debug"),
-            });
-        }
-        if (profile.contains("release")) {
-            mProfileRelease.conditional_configs.push_back({
+        for (const auto& [name, table] : profile) {
+            if (!table.is_table()) {
+                continue;
+            }
+
+            const auto prof = parse_profile(name);
+            if (!mProfiles.contains(prof)) {
+                throw Error { fmt::format("profile {} of target {} is not declared", name, condition_str) };
+            }
+
+            mProfiles[prof].conditional_configs.push_back({
                 .condition = condition,
-                .config = parse_profile_options(profile, "release"),
+                .config = parse_profile_options(config.at("profile"), name),
             });
         }
     }
 }
 
-const ProfileOptions& PackageManifest::profile(Profile prof) const
+bool PackageManifest::is_multiversion_source(const fs::path& package_root, const fs::path& source) const
+{
+    const auto file = source.lexically_normal();
+    return ranges::any_of(mMultiversionSources, [&](const fs::path& entry) {
+        const auto rel = file.lexically_relative((package_root / entry).lexically_normal());
+        return !rel.empty() && *rel.begin() != "..";
+    });
+}
+
+const ProfileOptions& PackageManifest::profile(const Profile& prof) const
 {
-    switch (prof) {
-    case Profile::debug:
-        return mProfileDebug;
+    static const ProfileOptions S_EMPTY;
+
+    const auto it = mProfiles.find(prof);
+    return it == mProfiles.end() ? S_EMPTY : it->second;
+}
+
+std::vector<Profile> PackageManifest::list_profiles() const
+{
+    return mProfiles | views::keys | to<std::vector>();
+}
+
+std::vector<Profile> PackageManifest::profile_chain(const Profile& prof) const
+{
+    if (!mProfiles.contains(prof)) {
+        throw InvalidProfile { prof.name() };
+    }
+
+    std::vector<Profile> chain { prof };
+    while (!chain.back().is_build_type()) {
+        const auto& parent = mInherits.at(chain.back());
+        if (!mProfiles.contains(parent)) {
+            throw Error { fmt::format("profile {} inherits unknown profile {}", chain.back().name(), parent.name()) };
+        }
+        if (ranges::find(chain, parent) != chain.end()) {
+            throw Error { fmt::format("profile {} inherits itself", parent.name()) };
+        }
 
-    case Profile::release:
-        return mProfileRelease;
+        chain.push_back(parent);
     }
 
-    std::abort();
+    ranges::reverse(chain);
+    return chain;
 }
 
 Manifest::Manifest(const fs::path& file)
@@ -261,7 +394,8 @@ Manifest::Manifest(const fs::path& file)
     }
 
     try {
-        const auto value = toml::parse(file);
+        const auto document = load_toml(file);
+        const auto& value = *document;
         if (!value.contains("workspace")) {
             const auto& p = packages_.emplace<PackageManifest>(value);
             mDependencies = p.dependencies();
@@ -284,7 +418,7 @@ Manifest::Manifest(const fs::path& file)
             }
 
             const auto& it
-                = packages.emplace(std::move(package_path), PackageManifest { toml::parse(package_manifest_path) })
+                = packages.emplace(std::move(package_path), PackageManifest { *load_toml(package_manifest_path) })
                       .first->second;
             if (!package_names.emplace(it.name()).second) {
                 throw Error { fmt::format("conflict package name: {}", it.name()) };
@@ -300,6 +434,33 @@ Manifest::Manifest(const fs::path& file)
     }
 }
 
+std::vector<Profile> Manifest::profile_chain(const Profile& prof) const
+{
+    if (const auto* package = get_if_package()) {
+        return package->profile_chain(prof);
+    }
+
+    std::optional<std::vector<Profile>> chain;
+    for (const auto& [path, package] : list_packages()) {
+        if (!package.has_profile(prof)) {
+            continue;
+        }
+
+        auto package_chain = package.profile_chain(prof);
+        if (chain && *chain != package_chain) {
+            throw Error { fmt::format("profile {} inherits differently in package {}", prof.name(), package.name()) };
+        }
+
+        chain = std::move(package_chain);
+    }
+
+    if (!chain) {
+        throw InvalidProfile { prof.name() };
+    }
+
+    return std::move(*chain);
+}
+
 const PackageManifest* Manifest::get(std::string_view package) const
 {
     switch (packages_.index()) {
@@ -0,0 +1,117 @@
+#include "cppship/core/path_table.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include <gsl/narrow>
+
+using namespace cppship;
+
+namespace {
+
+constexpr PathId kEmptySlot = std::numeric_limits<PathId>::max();
+constexpr std::size_t kMinSlots = 64;
+
+std::size_t hash(PathTable::string_view_type path) { return std::hash<PathTable::string_view_type> {}(path); }
+
+}
+
+PathId PathTable::intern(const fs::path& path)
+{
+    if ((size() + 1) * 2 > mSlots.size()) {
+        rehash_();
+    }
+
+    const auto slot = probe_(path.native());
+    if (mSlots[slot] != kEmptySlot) {
+        return mSlots[slot];
+    }
+
+    const auto id = gsl::narrow<PathId>(size());
+    mBuffer += path.native();
+    mOffsets.push_back(mBuffer.size());
+    mSlots[slot] = id;
+    return id;
+}
+
+std::optional<PathId> PathTable::find(const fs::path& path) const
+{
+    if (mSlots.empty()) {
+        return std::nullopt;
+    }
+
+    const auto id = mSlots[probe_(path.native())];
+    return id == kEmptySlot ? std::nullopt : std::make_optional(id);
+}
+
+std::size_t PathTable::probe_(string_view_type path) const
+{
+    const auto mask = mSlots.size() - 1;
+    for (auto slot = hash(path) & mask;; slot = (slot + 1) & mask) {
+        const auto id = mSlots[slot];
+        if (id == kEmptySlot || view(id) == path) {
+            return slot;
+        }
+    }
+}
+
+void PathTable::rehash_()
+{
+    mSlots.assign(std::max(kMinSlots, mSlots.size() * 2), kEmptySlot);
+
+    const auto mask = mSlots.size() - 1;
+    for (PathId id = 0; id < size(); ++id) {
+        auto slot = hash(view(id)) & mask;
+        while (mSlots[slot] != kEmptySlot) {
+            slot = (slot + 1) & mask;
+        }
+
+        mSlots[slot] = id;
+    }
+}
+
+PathSet::PathSet(std::shared_ptr<const PathTable> table, std::vector<PathId> ids)
+    : mTable(std::move(table))
+    , mIds(std::move(ids))
+{
+    // ids are mostly interned in the order of paths listed
+    const auto by_path = [table = mTable.get()](PathId lhs, PathId rhs) { return table->view(lhs) < table->view(rhs); };
+    if (!std::is_sorted(mIds.begin(), mIds.end(), by_path)) {
+        std::sort(mIds.begin(), mIds.end(), by_path);
+    }
+    mIds.erase(std::unique(mIds.begin(), mIds.end()), mIds.end());
+}
+
+PathSet::PathSet(std::initializer_list<fs::path> paths)
+{
+    auto table = std::make_shared<PathTable>();
+    std::vector<PathId> ids;
+    ids.reserve(paths.size());
+    for (const auto& path : paths) {
+        ids.push_back(table->intern(path));
+    }
+
+    *this = PathSet { std::move(table), std::move(ids) };
+}
+
+bool PathSet::contains(const fs::path& path) const
+{
+    if (mIds.empty()) {
+        return false;
+    }
+
+    const PathTable::string_view_type native = path.native();
+    const auto it = std::lower_bound(mIds.begin(), mIds.end(), native, [this](PathId id, auto rhs) {
+        return mTable->view(id) < rhs;
+    });
+    return it != mIds.end() && mTable->view(*it) == native;
+}
+
+bool PathSet::operator==(const PathSet& other) const
+{
+    return std::equal(mIds.begin(), mIds.end(), other.mIds.begin(), other.mIds.end(), [&](PathId lhs, PathId rhs) {
+        return mTable->view(lhs) == other.mTable->view(rhs);
+    });
+}
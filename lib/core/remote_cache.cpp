@@ -0,0 +1,173 @@
+#include "cppship/core/remote_cache.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+
+#include <fmt/core.h>
+
+#include "cppship/exception.h"
+#include "cppship/util/http.h"
+#include "cppship/util/io.h"
+#include "cppship/util/log.h"
+
+using namespace cppship;
+
+namespace {
+
+constexpr std::string_view kScheme = "http://";
+
+std::uint64_t parse_mib(const std::string_view value)
+{
+    std::uint64_t mib = 0;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), mib);
+    if (ec != std::errc {} || ptr != value.data() + value.size() || mib == 0) {
+        throw Error { fmt::format("invalid CPPSHIP_REMOTE_CACHE_MAX_SIZE {}, expect MiB", value) };
+    }
+
+    return mib << 20;
+}
+
+}
+
+RemoteCache::RemoteCache(const std::string_view url, const std::uint64_t max_blob_size)
+    : mMaxBlobSize(max_blob_size)
+{
+    if (!url.starts_with(kScheme)) {
+        throw Error { fmt::format("invalid remote cache {}, only {}host[:port][/prefix] is supported", url, kScheme) };
+    }
+
+    auto location = url.substr(kScheme.size());
+
+    const auto slash = location.find('/');
+    const auto authority = location.substr(0, slash);
+    if (slash != std::string_view::npos) {
+        mPrefix = location.substr(slash);
+        while (mPrefix.ends_with('/')) {
+            mPrefix.pop_back();
+        }
+    }
+
+    const auto colon = authority.rfind(':');
+    mHost = authority.substr(0, colon);
+    mPort = colon == std::string_view::npos ? "80" : authority.substr(colon + 1);
+    if (mHost.empty() || mPort.empty()) {
+        throw Error { fmt::format("invalid remote cache {}", url) };
+    }
+}
+
+RemoteCache::~RemoteCache() { wait(); }
+
+std::string RemoteCache::target_(std::string_view kind, std::string_view key) const
+{
+    return fmt::format("{}/{}/{}", mPrefix, kind, key);
+}
+
+std::optional<std::string> RemoteCache::get(std::string_view kind, std::string_view key) const
+{
+    try {
+        auto res = util::http_request(mHost, mPort, { .method = "GET", .target = target_(kind, key) });
+        if (res.ok()) {
+            debug("remote cache hit {}/{}", kind, key);
+            return std::move(res.body);
+        }
+
+        if (res.status != util::kHttpNotFound) {
+            warn("remote cache get {}/{} failed: {}", kind, key, res.status);
+        }
+    } catch (const std::exception& e) {
+        warn("remote cache get {}/{} failed: {}", kind, key, e.what());
+    }
+
+    return std::nullopt;
+}
+
+bool RemoteCache::get_file(std::string_view kind, std::string_view key, const fs::path& file) const
+{
+    try {
+        fs::create_directories(file.parent_path());
+        const auto tmp_file = temp_file_for(file);
+        const auto res = util::http_download(
+            mHost, mPort, { .method = "GET", .target = target_(kind, key) }, tmp_file, mMaxBlobSize);
+        if (res.ok()) {
+            fs::rename(tmp_file, file);
+            debug("remote cache hit {}/{}", kind, key);
+            return true;
+        }
+
+        if (res.status != util::kHttpNotFound) {
+            warn("remote cache get {}/{} failed: {}", kind, key, res.status);
+        }
+    } catch (const std::exception& e) {
+        warn("remote cache get {}/{} failed: {}", kind, key, e.what());
+    }
+
+    return false;
+}
+
+bool RemoteCache::put(std::string_view kind, std::string_view key, std::string body) const
+{
+    try {
+        const auto res = util::http_request(
+            mHost, mPort, { .method = "PUT", .target = target_(kind, key), .body = std::move(body) });
+        if (res.ok()) {
+            debug("remote cache put {}/{}", kind, key);
+            return true;
+        }
+
+        warn("remote cache put {}/{} failed: {}", kind, key, res.status);
+    } catch (const std::exception& e) {
+        warn("remote cache put {}/{} failed: {}", kind, key, e.what());
+    }
+
+    return false;
+}
+
+bool RemoteCache::put_file(std::string_view kind, std::string_view key, const fs::path& file) const
+{
+    try {
+        const auto res = util::http_request(
+            mHost, mPort, { .method = "PUT", .target = target_(kind, key), .body_file = file });
+        if (res.ok()) {
+            debug("remote cache put {}/{}", kind, key);
+            return true;
+        }
+
+        warn("remote cache put {}/{} failed: {}", kind, key, res.status);
+    } catch (const std::exception& e) {
+        warn("remote cache put {}/{} failed: {}", kind, key, e.what());
+    }
+
+    return false;
+}
+
+void RemoteCache::put_file_async(std::string kind, std::string key, fs::path file)
+{
+    mUploader.push_task(
+        [this, kind = std::move(kind), key = std::move(key), file = std::move(file)] { put_file(kind, key, file); });
+}
+
+void RemoteCache::wait() { mUploader.wait_for_tasks(); }
+
+RemoteCache* cppship::get_remote_cache()
+{
+    static const std::unique_ptr<RemoteCache> cache = []() -> std::unique_ptr<RemoteCache> {
+        // NOLINTNEXTLINE(concurrency-mt-unsafe): environment is never modified
+        const auto* url = std::getenv("CPPSHIP_REMOTE_CACHE");
+        if (url == nullptr || *url == '\0') {
+            return nullptr;
+        }
+
+        // NOLINTNEXTLINE(concurrency-mt-unsafe): environment is never modified
+        const auto* max_size = std::getenv("CPPSHIP_REMOTE_CACHE_MAX_SIZE");
+        if (max_size == nullptr || *max_size == '\0') {
+            return std::make_unique<RemoteCache>(url);
+        }
+
+        return std::make_unique<RemoteCache>(url, parse_mib(max_size));
+    }();
+
+    return cache.get();
+}
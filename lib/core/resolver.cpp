@@ -1,9 +1,18 @@
 #include "cppship/core/resolver.h"
 
+#include <algorithm>
+#include <future>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <BS_thread_pool_light.hpp>
 #include <fmt/format.h>
+#include <gsl/narrow>
 #include <range/v3/action/push_back.hpp>
 #include <range/v3/action/reverse.hpp>
 
+#include "cppship/core/dependency_graph.h"
 #include "cppship/core/manifest.h"
 #include "cppship/util/io.h"
 #include "cppship/util/log.h"
@@ -13,14 +22,15 @@ using namespace cppship;
 using namespace fmt::literals;
 
 Resolver::Resolver(const fs::path& deps_dir, const std::vector<DeclaredDependency>& deps,
-    const std::vector<DeclaredDependency>& dev_deps, GitFetcher fetcher)
+    const std::vector<DeclaredDependency>& dev_deps, GitFetcher fetcher, DependencyGraph* graph)
     : mDepsDir(deps_dir)
     , mFetcher(std::move(fetcher))
+    , mGraph(graph)
 {
     for (const auto& dep : deps) {
         const auto* conanlib = get_if<ConanDep>(&dep.desc);
         if (conanlib == nullptr) {
-            mUnresolved.push(dep);
+            mUnresolved.push_back(dep);
             continue;
         }
 
@@ -31,7 +41,7 @@ Resolver::Resolver(const fs::path& deps_dir, const std::vector<DeclaredDependenc
     for (const auto& dep : dev_deps) {
         const auto* conanlib = get_if<ConanDep>(&dep.desc);
         if (conanlib == nullptr) {
-            mUnresolved.push(dep);
+            mUnresolved.push_back(dep);
             continue;
         }
 
@@ -46,15 +56,22 @@ Resolver::Resolver(const fs::path& deps_dir, const std::vector<DeclaredDependenc
 cppship::ResolveResult Resolver::resolve() &&
 {
     while (!mUnresolved.empty()) {
-        const auto dep = std::move(mUnresolved.front());
-        mUnresolved.pop();
-
-        if (const bool existed = !mPackageSeen.insert(dep.package).second; existed) {
-            status("resolve", "package {} already seen, skip", dep.package);
-            continue;
+        std::vector<DeclaredDependency> level;
+        for (auto& dep : std::exchange(mUnresolved, {})) {
+            if (const bool existed = !mPackageSeen.insert(dep.package).second; existed) {
+                status("resolve", "package {} already seen, skip", dep.package);
+                continue;
+            }
+
+            level.push_back(std::move(dep));
         }
 
-        do_resolve_(dep);
+        fetch_git_dependencies(mDepsDir, level, mFetcher);
+
+        // sub deps are collected in order, so the result is the same as a sequential bfs
+        for (const auto& dep : level) {
+            do_resolve_(dep);
+        }
     }
 
     ranges::push_back(mResult.dependencies, mResult.conan_dependencies);
@@ -67,6 +84,8 @@ cppship::ResolveResult Resolver::resolve() &&
 
 namespace {
 
+constexpr std::size_t kMaxParallelFetches = 8;
+
 void verify_git_dependency(const std::string_view package, const fs::path& dep_dir)
 {
     if (fs::exists(dep_dir / kRepoConfigFile)) {
@@ -85,19 +104,52 @@ void verify_git_dependency(const std::string_view package, const fs::path& dep_d
 
 }
 
-void Resolver::do_resolve_(const DeclaredDependency& dep)
+fs::path cppship::git_dependency_footprint(const fs::path& deps_dir, const DeclaredDependency& dep)
 {
-    const auto& desc = get<GitDep>(dep.desc);
-    const auto package_dir = mDepsDir / dep.package;
-    const auto footprint = fmt::format("{}/cppship.{}", package_dir.string(), desc.commit);
-    if (!fs::exists(footprint) && mFetcher) {
-        status("resolve", "fetch {} from {}::{}", dep.package, desc.git, desc.commit);
+    return deps_dir / dep.package / fmt::format("cppship.{}", get<GitDep>(dep.desc).commit);
+}
 
-        mFetcher(dep.package, mDepsDir, desc.git, desc.commit);
-        verify_git_dependency(dep.package, package_dir);
+void cppship::fetch_git_dependencies(
+    const fs::path& deps_dir, const std::vector<DeclaredDependency>& deps, const GitFetcher& fetcher)
+{
+    if (!fetcher) {
+        return;
     }
 
-    resolve_package_(dep.package, package_dir);
+    std::vector<const DeclaredDependency*> to_fetch;
+    for (const auto& dep : deps) {
+        if (dep.is_git() && !fs::exists(git_dependency_footprint(deps_dir, dep))) {
+            to_fetch.push_back(&dep);
+        }
+    }
+    if (to_fetch.empty()) {
+        return;
+    }
+
+    // fetching is network bound rather than cpu bound, but each fetch is a git process and a connection to the server
+    BS::thread_pool_light pool(gsl::narrow_cast<BS::concurrency_t>(std::min(to_fetch.size(), kMaxParallelFetches)));
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(to_fetch.size());
+    for (const auto* dep : to_fetch) {
+        tasks.push_back(pool.submit([&deps_dir, &fetcher, dep] {
+            const auto& desc = get<GitDep>(dep->desc);
+            status("resolve", "fetch {} from {}::{}", dep->package, desc.git, desc.commit);
+
+            fetcher(dep->package, deps_dir, desc);
+            verify_git_dependency(dep->package, deps_dir / dep->package);
+        }));
+    }
+
+    pool.wait_for_tasks();
+
+    for (auto& task : tasks) {
+        task.get();
+    }
+}
+
+void Resolver::do_resolve_(const DeclaredDependency& dep)
+{
+    resolve_package_(dep);
 
     mResult.dependencies.push_back(dep);
     mResult.resolved_dependencies.insert(Dependency {
@@ -106,13 +158,22 @@ void Resolver::do_resolve_(const DeclaredDependency& dep)
         .cmake_target = fmt::format("cppship::{}", dep.package),
     });
 
-    touch(footprint);
+    // a resolution without fetching is a query, the deps are left as they are
+    if (mFetcher) {
+        touch(git_dependency_footprint(mDepsDir, dep));
+    }
 }
 
-void Resolver::resolve_package_(std::string_view package, const fs::path& package_dir)
+void Resolver::resolve_package_(const DeclaredDependency& dep)
 {
-    const auto cppship_manifest = package_dir / kRepoConfigFile;
-    if (!fs::exists(cppship_manifest)) {
+    const auto& package = dep.package;
+    std::optional<DependencyGraph> local_graph;
+    if (mGraph == nullptr) {
+        local_graph.emplace(mDepsDir);
+    }
+
+    const auto* manifest = (mGraph != nullptr ? *mGraph : *local_graph).manifest(dep);
+    if (manifest == nullptr) {
         status("resolve", "header only lib {} found", package);
 
         return;
@@ -120,12 +181,7 @@ void Resolver::resolve_package_(std::string_view package, const fs::path& packag
 
     status("resolve", "cppship lib {} found", package);
 
-    Manifest manifest(cppship_manifest);
-    if (manifest.is_workspace()) {
-        throw Error { fmt::format("package {} is a workspace", package) };
-    }
-
-    for (const auto& sub_dep : manifest.dependencies()) {
+    for (const auto& sub_dep : manifest->dependencies()) {
         if (mPackageSeen.contains(sub_dep.package)) {
             status("resolve", "package {} already seen, skip", sub_dep.package);
             continue;
@@ -137,6 +193,6 @@ void Resolver::resolve_package_(std::string_view package, const fs::path& packag
             continue;
         }
 
-        mUnresolved.push(sub_dep);
+        mUnresolved.push_back(sub_dep);
     }
 }
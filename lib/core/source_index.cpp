@@ -0,0 +1,306 @@
+#include "cppship/core/source_index.h"
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include <BS_thread_pool_light.hpp>
+#include <gsl/narrow>
+#include <range/v3/algorithm/sort.hpp>
+
+#include "cppship/util/binary.h"
+#include "cppship/util/hash.h"
+#include "cppship/util/log.h"
+
+using namespace cppship;
+
+namespace {
+
+constexpr std::string_view kIndexMagic = "CPPSHIP-INDEX";
+constexpr std::uint32_t kIndexVersion = 1;
+constexpr std::string_view kIndexedExtension = ".cpp";
+
+struct Stamp {
+    std::int64_t mtime = 0;
+    std::uint64_t inode = 0;
+    bool is_dir = false;
+};
+
+std::optional<Stamp> stat_path(const fs::path& path)
+{
+#ifdef _WIN32
+    std::error_code ec;
+    const auto status = fs::status(path, ec);
+    if (ec || !fs::exists(status)) {
+        return std::nullopt;
+    }
+
+    const auto mtime = fs::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    return Stamp { .mtime = mtime.time_since_epoch().count(), .is_dir = fs::is_directory(status) };
+#else
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0) {
+        return std::nullopt;
+    }
+
+#ifdef __APPLE__
+    const auto& mtime = st.st_mtimespec;
+#else
+    const auto& mtime = st.st_mtim;
+#endif
+    constexpr std::int64_t kNanosPerSecond = 1'000'000'000;
+    return Stamp {
+        .mtime = static_cast<std::int64_t>(mtime.tv_sec) * kNanosPerSecond + mtime.tv_nsec,
+        .inode = static_cast<std::uint64_t>(st.st_ino),
+        .is_dir = S_ISDIR(st.st_mode),
+    };
+#endif
+}
+
+std::optional<Stamp> stat_dir(const fs::path& dir)
+{
+    auto stamp = stat_path(dir);
+    return stamp && stamp->is_dir ? stamp : std::nullopt;
+}
+
+}
+
+SourceIndex::SourceIndex(fs::path index_file)
+    : mIndexFile(std::move(index_file))
+{
+    if (fs::exists(mIndexFile)) {
+        load_();
+    }
+}
+
+void SourceIndex::load_()
+{
+    // directories modified in the same timestamp tick as the index was written may have changed after listed
+    if (const auto stamp = stat_path(mIndexFile)) {
+        mIndexTime = stamp->mtime;
+    }
+
+    std::ifstream ifs(mIndexFile, std::ios::binary);
+
+    std::string magic(kIndexMagic.size(), '\0');
+    ifs.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+    if (magic != kIndexMagic || read_pod<std::uint32_t>(ifs) != kIndexVersion) {
+        debug("source index {} is outdated, ignore it", mIndexFile.string());
+        return;
+    }
+
+    const auto count = read_pod<std::uint64_t>(ifs);
+    for (std::uint64_t i = 0; i < count && ifs; ++i) {
+        auto path = read_string(ifs);
+
+        Directory dir;
+        dir.mtime = read_pod<std::int64_t>(ifs);
+        dir.inode = read_pod<std::uint64_t>(ifs);
+        dir.files = read_strings(ifs);
+        dir.subdirs = read_strings(ifs);
+
+        mDirs.emplace(std::move(path), std::move(dir));
+    }
+
+    if (!ifs) {
+        debug("source index {} is corrupted, ignore it", mIndexFile.string());
+        mDirs.clear();
+    }
+}
+
+void SourceIndex::refresh(const std::vector<fs::path>& roots)
+{
+    // stat is io bound, roots are walked concurrently, each reading the loaded index only
+    const auto concurrency = std::min<std::size_t>(roots.size(), std::thread::hardware_concurrency());
+    BS::thread_pool_light pool(gsl::narrow_cast<BS::concurrency_t>(std::max<std::size_t>(concurrency, 1)));
+    std::vector<std::future<Walk>> tasks;
+    tasks.reserve(roots.size());
+    for (const auto& root : roots) {
+        tasks.push_back(pool.submit([this, &root] { return walk_(root); }));
+    }
+
+    pool.wait_for_tasks();
+
+    std::map<fs::path, Directory> dirs;
+    for (auto& task : tasks) {
+        auto walk = task.get();
+        mChanged = mChanged || walk.changed;
+        mDirty = mDirty || walk.dirty;
+        // roots may nest, a directory walked twice is listed the same
+        dirs.merge(walk.dirs);
+    }
+
+    // removed directories
+    for (const auto& [path, _] : mDirs) {
+        if (!dirs.contains(path)) {
+            mChanged = true;
+            mDirty = true;
+            break;
+        }
+    }
+
+    mDirs = std::move(dirs);
+}
+
+SourceIndex::Walk SourceIndex::walk_(const fs::path& root) const
+{
+    Walk walk;
+    std::vector<fs::path> pending { root };
+
+    while (!pending.empty()) {
+        auto path = std::move(pending.back());
+        pending.pop_back();
+
+        const auto stamp = stat_dir(path);
+        if (!stamp || walk.dirs.contains(path)) {
+            continue;
+        }
+
+        const auto it = mDirs.find(path);
+        Directory dir;
+        // like racily clean entries of git, a directory not strictly older than the index is listed again
+        const bool racy = stamp->mtime >= mIndexTime;
+        if (it != mDirs.end() && it->second.mtime == stamp->mtime && it->second.inode == stamp->inode && !racy) {
+            dir = it->second;
+        } else {
+            dir = list_dir_(path, stamp->mtime, stamp->inode);
+            walk.dirty = true;
+
+            if (it == mDirs.end() || it->second.files != dir.files || it->second.subdirs != dir.subdirs) {
+                walk.changed = true;
+            }
+        }
+
+        for (const auto& subdir : dir.subdirs) {
+            pending.push_back(path / subdir);
+        }
+
+        walk.dirs.emplace(std::move(path), std::move(dir));
+    }
+
+    return walk;
+}
+
+SourceIndex::Directory SourceIndex::list_dir_(const fs::path& dir, std::int64_t mtime, std::uint64_t inode)
+{
+    Directory result { .mtime = mtime, .inode = inode };
+
+    for (const fs::directory_entry& entry : fs::directory_iterator { dir }) {
+        const auto& path = entry.path();
+        // recursive_directory_iterator does not follow directory symlinks either
+        if (entry.is_directory() && !entry.is_symlink()) {
+            result.subdirs.push_back(path.filename().string());
+        } else if (path.extension() == kIndexedExtension) {
+            result.files.push_back(path.filename().string());
+        }
+    }
+
+    ranges::sort(result.files);
+    ranges::sort(result.subdirs);
+    return result;
+}
+
+void SourceIndex::save() const
+{
+    if (!mDirty || mIndexFile.empty()) {
+        return;
+    }
+
+    // write to a temp file first, a partial index should never be observed
+    auto tmp_file = mIndexFile;
+    tmp_file += ".tmp";
+    {
+        std::ofstream ofs(tmp_file, std::ios::binary | std::ios::trunc);
+        ofs.write(kIndexMagic.data(), static_cast<std::streamsize>(kIndexMagic.size()));
+        write_pod(ofs, kIndexVersion);
+        write_pod(ofs, static_cast<std::uint64_t>(mDirs.size()));
+        for (const auto& [path, dir] : mDirs) {
+            write_string(ofs, path.string());
+            write_pod(ofs, dir.mtime);
+            write_pod(ofs, dir.inode);
+            write_strings(ofs, dir.files);
+            write_strings(ofs, dir.subdirs);
+        }
+    }
+
+    fs::rename(tmp_file, mIndexFile);
+}
+
+std::uint64_t SourceIndex::digest() const
+{
+    util::Hasher hasher;
+    for (const auto& [path, dir] : mDirs) {
+        hasher.update(path.string()).update(std::string_view { "\0", 1 });
+        for (const auto& name : dir.files) {
+            hasher.update(name).update("/");
+        }
+        for (const auto& name : dir.subdirs) {
+            hasher.update(name).update("\n");
+        }
+    }
+
+    return hasher.digest();
+}
+
+std::set<fs::path> SourceIndex::list_sources(const fs::path& dir) const
+{
+    std::set<fs::path> files;
+
+    std::vector<fs::path> pending { dir };
+    while (!pending.empty()) {
+        const auto path = std::move(pending.back());
+        pending.pop_back();
+
+        const auto it = mDirs.find(path);
+        if (it == mDirs.end()) {
+            continue;
+        }
+
+        for (const auto& file : it->second.files) {
+            files.insert(path / file);
+        }
+        for (const auto& subdir : it->second.subdirs) {
+            pending.push_back(path / subdir);
+        }
+    }
+
+    return files;
+}
+
+std::set<fs::path> SourceIndex::list_cpp_files(const fs::path& dir) const
+{
+    std::set<fs::path> files;
+
+    if (const auto it = mDirs.find(dir); it != mDirs.end()) {
+        for (const auto& file : it->second.files) {
+            files.insert(dir / file);
+        }
+    }
+
+    return files;
+}
+
+std::set<fs::path> SourceIndex::list_files() const
+{
+    std::set<fs::path> files;
+    for (const auto& [path, dir] : mDirs) {
+        for (const auto& file : dir.files) {
+            files.insert(path / file);
+        }
+    }
+
+    return files;
+}
@@ -1,18 +1,33 @@
 #include "cppship/core/workspace.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <fstream>
 #include <functional>
+#include <future>
+#include <sstream>
+#include <thread>
 #include <tuple>
 #include <utility>
+#include <vector>
 
+#include <BS_thread_pool_light.hpp>
+#include <gsl/narrow>
+#include <range/v3/algorithm/any_of.hpp>
 #include <range/v3/algorithm/find_if.hpp>
 #include <range/v3/algorithm/transform.hpp>
 #include <range/v3/to_container.hpp>
 #include <range/v3/view/concat.hpp>
-#include <range/v3/view/join.hpp>
 #include <range/v3/view/map.hpp>
 #include <range/v3/view/transform.hpp>
 
+#include "cppship/core/lockfile.h"
 #include "cppship/core/manifest.h"
+#include "cppship/util/binary.h"
+#include "cppship/util/io.h"
+#include "cppship/util/log.h"
+#include "cppship/util/repo.h"
 
 using namespace ranges::views;
 
@@ -20,6 +35,50 @@ namespace cppship {
 
 namespace {
 
+// directories listed by Layout
+std::vector<fs::path> source_dirs(const fs::path& package_root)
+{
+    return { package_root / kSrcPath,
+        package_root / kLibPath,
+        package_root / kTestsPath,
+        package_root / kBenchesPath,
+        package_root / kExamplesPath };
+}
+
+constexpr std::string_view kSnapshotMagic = "CPPSHIP-WORKSPACE";
+constexpr std::uint32_t kSnapshotVersion = 1;
+
+// directories of all members
+std::vector<fs::path> source_dirs(const fs::path& root, const Manifest& manifest)
+{
+    if (manifest.get_if_package() != nullptr) {
+        return source_dirs(root);
+    }
+
+    std::vector<fs::path> dirs;
+    for (const auto& path : keys(manifest.list_packages())) {
+        const auto package_dirs = source_dirs(root / path);
+        dirs.insert(dirs.end(), package_dirs.begin(), package_dirs.end());
+    }
+
+    return dirs;
+}
+
+// whether the packages are exactly the members of the manifest
+bool is_members_of(const std::map<fs::path, Layout>& packages, const Manifest& manifest)
+{
+    if (const auto* p = manifest.get_if_package()) {
+        return packages.size() == 1 && packages.begin()->first.empty()
+            && packages.begin()->second.package() == p->name();
+    }
+
+    const auto& members = manifest.list_packages();
+    const auto same = [](const auto& lhs, const auto& rhs) {
+        return lhs.first == rhs.first && lhs.second.package() == rhs.second.name();
+    };
+    return std::equal(packages.begin(), packages.end(), members.begin(), members.end(), same);
+}
+
 template <class Layouts, class Proj>
 // NOLINTNEXTLINE(cppcoreguidelines-missing-std-forward)
 void check_duplicate_target(std::string_view kind, const Layouts& layouts, Proj&& proj)
@@ -40,27 +99,123 @@ void check_duplicate_target(std::string_view kind, const Layouts& layouts, Proj&
 }
 
 Workspace::Workspace(const fs::path& project_root, const Manifest& manifest)
+    : Workspace(project_root, manifest, nullptr, {})
+{
+}
+
+Workspace::Workspace(
+    const fs::path& project_root, const Manifest& manifest, SourceIndex& index, const fs::path& snapshot_file)
+    : Workspace(project_root, manifest, &index, snapshot_file)
+{
+}
+
+Workspace::Workspace(
+    const fs::path& project_root, const Manifest& manifest, SourceIndex* index, const fs::path& snapshot_file)
     : root_(project_root)
 {
-    if (const auto* p = manifest.get_if_package()) {
-        packages_.emplace(
-            std::piecewise_construct, std::forward_as_tuple(fs::path {}), std::forward_as_tuple(root_, p->name()));
+    if (index != nullptr) {
+        index->refresh(source_dirs(root_, manifest));
+    }
+
+    // targets only change with the listed sources or members
+    const auto digest = index != nullptr && !snapshot_file.empty() ? std::make_optional(index->digest()) : std::nullopt;
+    if (digest && load_snapshot_(snapshot_file, *digest, manifest)) {
         return;
     }
 
-    for (const auto& [path, package_manifest] : manifest.list_packages()) {
+    scan_(manifest, index);
+    if (digest) {
+        save_snapshot_(snapshot_file, *digest);
+    }
+}
+
+void Workspace::scan_(const Manifest& manifest, const SourceIndex* index)
+{
+    if (const auto* p = manifest.get_if_package()) {
         packages_.emplace(std::piecewise_construct,
-            std::forward_as_tuple(path),
-            std::forward_as_tuple(root_ / path, package_manifest.name()));
+            std::forward_as_tuple(fs::path {}),
+            std::forward_as_tuple(root_, p->name(), index));
+        return;
+    }
+
+    const auto& members = manifest.list_packages();
+    const auto concurrency = std::min<std::size_t>(members.size(), std::thread::hardware_concurrency());
+
+    // directory walking is io bound, scan packages concurrently
+    BS::thread_pool_light pool(gsl::narrow_cast<BS::concurrency_t>(std::max<std::size_t>(concurrency, 1)));
+    std::vector<std::pair<fs::path, std::future<Layout>>> tasks;
+    tasks.reserve(members.size());
+    for (const auto& member : members) {
+        tasks.emplace_back(member.first, pool.submit([this, &member, index] {
+            return Layout { root_ / member.first, member.second.name(), index };
+        }));
+    }
+
+    pool.wait_for_tasks();
+
+    for (auto& [path, task] : tasks) {
+        packages_.emplace(path, task.get());
     }
 
     check_duplicate_target("binary", layouts(), &Layout::binaries);
 }
 
-std::set<fs::path> Workspace::list_files() const
+bool Workspace::load_snapshot_(const fs::path& snapshot_file, std::uint64_t digest, const Manifest& manifest)
 {
-    return join(values(packages_) | transform([](const auto& layout) { return layout.all_files(); }))
-        | ranges::to<std::set>();
+    std::ifstream ifs(snapshot_file, std::ios::binary);
+    if (!ifs) {
+        return false;
+    }
+
+    std::string magic(kSnapshotMagic.size(), '\0');
+    ifs.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+    if (magic != kSnapshotMagic || read_pod<std::uint32_t>(ifs) != kSnapshotVersion
+        || read_pod<std::uint64_t>(ifs) != digest || read_string(ifs) != root_.string()) {
+        debug("workspace snapshot {} is outdated, ignore it", snapshot_file.string());
+        return false;
+    }
+
+    std::map<fs::path, Layout> packages;
+    const auto count = read_pod<std::uint32_t>(ifs);
+    for (std::uint32_t i = 0; i < count && ifs; ++i) {
+        fs::path path = read_string(ifs);
+        auto layout = Layout::load(ifs);
+        if (!layout) {
+            return false;
+        }
+
+        packages.emplace(std::move(path), std::move(*layout));
+    }
+
+    if (!ifs || packages.size() != count || !is_members_of(packages, manifest)) {
+        debug("workspace snapshot {} is outdated, ignore it", snapshot_file.string());
+        return false;
+    }
+
+    packages_ = std::move(packages);
+    return true;
+}
+
+void Workspace::save_snapshot_(const fs::path& snapshot_file, std::uint64_t digest) const
+{
+    std::ostringstream oss;
+    oss.write(kSnapshotMagic.data(), static_cast<std::streamsize>(kSnapshotMagic.size()));
+    write_pod(oss, kSnapshotVersion);
+    write_pod(oss, digest);
+    write_string(oss, root_.string());
+    write_pod(oss, static_cast<std::uint32_t>(packages_.size()));
+    for (const auto& [path, layout] : packages_) {
+        write_string(oss, path.string());
+        layout.save(oss);
+    }
+
+    // a snapshot is an optimization only, never fail the command
+    try {
+        create_if_not_exist(snapshot_file.parent_path());
+        write_atomic(snapshot_file, oss.str());
+    } catch (const std::exception& e) {
+        debug("cannot save workspace snapshot {}: {}", snapshot_file.string(), e.what());
+    }
 }
 
 const Layout* Workspace::layout(std::string_view package) const
@@ -71,6 +226,28 @@ const Layout* Workspace::layout(std::string_view package) const
     return it == l.end() ? nullptr : &*it;
 }
 
+const Layout* Workspace::owner(const fs::path& file) const
+{
+    const auto relative = file.lexically_normal().lexically_relative(root_.lexically_normal());
+    if (relative.empty() || *relative.begin() == "..") {
+        return nullptr;
+    }
+
+    const Layout* result = nullptr;
+    std::ptrdiff_t result_depth = -1;
+    for (const auto& [path, layout] : packages_) {
+        const auto depth = std::distance(path.begin(), path.end());
+        const bool contains
+            = std::mismatch(path.begin(), path.end(), relative.begin(), relative.end()).first == path.end();
+        if (contains && depth > result_depth) {
+            result = &layout;
+            result_depth = depth;
+        }
+    }
+
+    return result;
+}
+
 const Layout& enforce_default_package(const Workspace& workspace)
 {
     const auto* l = workspace.get_default();
@@ -81,4 +258,46 @@ const Layout& enforce_default_package(const Workspace& workspace)
     return *l;
 }
 
+std::set<std::string> affected_packages(
+    const Workspace& workspace, const Manifest& manifest, const std::set<fs::path>& changed_files)
+{
+    std::set<std::string> affected;
+    for (const auto& file : changed_files) {
+        if (const auto* layout = workspace.owner(file)) {
+            affected.emplace(layout->package());
+            continue;
+        }
+
+        // git deps are pinned by them, so are conan deps
+        const auto relative = file.lexically_relative(workspace.root());
+        if (relative == kRepoConfigFile || relative == kLockFile || relative == kConanLockFile) {
+            return workspace.layouts()
+                | transform([](const Layout& layout) { return std::string { layout.package() }; })
+                | ranges::to<std::set>();
+        }
+    }
+
+    // reverse dependency closure, packages are few enough to iterate until no change
+    for (bool grown = true; grown;) {
+        grown = false;
+        for (const auto& layout : workspace.layouts()) {
+            const std::string package { layout.package() };
+            const auto* package_manifest = manifest.get(package);
+            if (affected.contains(package) || package_manifest == nullptr) {
+                continue;
+            }
+
+            const auto deps = concat(package_manifest->dependencies(), package_manifest->dev_dependencies());
+            const bool depends_on_affected = ranges::any_of(
+                deps, [&affected](const DeclaredDependency& dep) { return affected.contains(dep.package); });
+            if (depends_on_affected) {
+                affected.insert(package);
+                grown = true;
+            }
+        }
+    }
+
+    return affected;
+}
+
 }
@@ -15,6 +15,16 @@ bool cppship::has_cmd(std::string_view cmd)
     return !path.empty();
 }
 
+fs::path cppship::find_cmd(std::string_view cmd)
+{
+    const auto path = search_path(cmd);
+    if (path.empty()) {
+        throw CmdNotFound { cmd };
+    }
+
+    return path.string();
+}
+
 int cppship::run_cmd(const std::string_view cmd)
 {
     if (spdlog::should_log(spdlog::level::info)) {
@@ -1,9 +1,310 @@
 #include "cppship/util/cmd_runner.h"
 
+#include <array>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/process/args.hpp>
+#include <boost/process/async_pipe.hpp>
+#include <boost/process/child.hpp>
+#include <boost/process/exe.hpp>
+#include <boost/process/group.hpp>
+#include <boost/process/io.hpp>
+#include <boost/process/start_dir.hpp>
+#include <fmt/core.h>
+
+// children are reaped once their output is closed without pidfd
+#if defined(__linux__) && __has_include(<sys/syscall.h>)
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef SYS_pidfd_open
+#define CPPSHIP_HAS_PIDFD
+#include <boost/asio/posix/stream_descriptor.hpp>
+#endif
+#endif
+
 #include "cppship/util/cmd.h"
 
 namespace cppship::util {
 
+namespace {
+
+namespace asio = boost::asio;
+namespace bp = boost::process;
+
+constexpr std::size_t kReadBufferSize = 4096;
+
+// output of a child read into a buffer of the task
+struct OutputPipe {
+    bp::async_pipe pipe;
+    std::array<char, kReadBufferSize> buffer {};
+    std::string* sink = nullptr;
+
+    OutputPipe(asio::io_context& ioc, std::string* sink_)
+        : pipe(ioc)
+        , sink(sink_)
+    {
+    }
+};
+
+struct RunningTask {
+    std::size_t index = 0;
+    TaskResult result;
+    bp::group group;
+    std::optional<OutputPipe> out;
+    std::optional<OutputPipe> err;
+    // output of tasks with a log file is written by the scheduler, so that each task has a pipe to watch
+    std::ofstream log;
+    int open_pipes = 0;
+    asio::steady_timer timer;
+    bp::child child;
+#ifdef CPPSHIP_HAS_PIDFD
+    // readable once the child exits
+    asio::posix::stream_descriptor pidfd;
+#endif
+    // without an exit watch, the child is reaped once its output is closed
+    bool reap_on_close = true;
+    bool exited = false;
+
+    explicit RunningTask(asio::io_context& ioc)
+        : timer(ioc)
+#ifdef CPPSHIP_HAS_PIDFD
+        , pidfd(ioc)
+#endif
+    {
+    }
+};
+
+// children are watched by one thread: output, exits and timeouts are all events of the io context. exits are watched
+// through a pidfd where supported, otherwise a child is reaped once its output is closed, which most children only
+// do by exiting
+class TaskScheduler {
+public:
+    TaskScheduler(const std::vector<Task>& tasks, unsigned max_concurrency, const TaskCallback& on_done)
+        : mTasks(tasks)
+        , mMaxConcurrency(max_concurrency)
+        , mOnDone(on_done)
+        , mResults(tasks.size())
+    {
+    }
+
+    std::vector<TaskResult> run(const std::stop_token& stop)
+    {
+        if (stop.stop_requested()) {
+            cancel_();
+            return std::move(mResults);
+        }
+
+        const std::stop_callback on_stop(stop, [this] { asio::post(mIoc, [this] { cancel_(); }); });
+        while (mNext < mTasks.size() && mRunning.size() < mMaxConcurrency) {
+            launch_next_();
+        }
+
+        mIoc.run();
+        return std::move(mResults);
+    }
+
+private:
+    void launch_next_()
+    {
+        const auto index = mNext++;
+        const auto& task = mTasks[index];
+
+        auto running = std::make_shared<RunningTask>(mIoc);
+        running->index = index;
+        running->out.emplace(mIoc, task.log_file ? nullptr : &running->result.output);
+        if (!task.log_file && task.capture_stderr) {
+            running->err.emplace(mIoc, &running->result.error_output);
+        }
+
+        try {
+            if (task.log_file) {
+                running->log.open(*task.log_file, std::ios::binary | std::ios::trunc);
+                if (!running->log) {
+                    throw IOError { fmt::format("cannot open file {} to write", task.log_file->string()) };
+                }
+            }
+
+            running->child = spawn_(task, *running);
+        } catch (const std::exception& e) {
+            running->result.error_output = e.what();
+            done_(std::move(running->result), index);
+            launch_more_();
+            return;
+        }
+
+        mRunning.emplace(index, running);
+        for (auto* pipe : { &running->out, &running->err }) {
+            if (*pipe) {
+                ++running->open_pipes;
+                read_(running, **pipe);
+            }
+        }
+        watch_exit_(running);
+
+        if (task.timeout) {
+            running->timer.expires_after(*task.timeout);
+            running->timer.async_wait([running](const boost::system::error_code& ec) {
+                if (ec) {
+                    return;
+                }
+
+                running->result.timed_out = true;
+                std::error_code kill_ec;
+                running->group.terminate(kill_ec);
+            });
+        }
+    }
+
+    static bp::child spawn_(const Task& task, RunningTask& running)
+    {
+        if (task.args.empty()) {
+            throw Error { "empty task" };
+        }
+
+        const auto exe = fs::path(task.args.front()).has_parent_path() ? fs::path(task.args.front())
+                                                                         : find_cmd(task.args.front());
+        const std::vector<std::string> args(task.args.begin() + 1, task.args.end());
+        const auto dir = task.cwd.value_or(fs::current_path()).string();
+
+        // io redirections are types, so are the combinations. a log file keeps stdout and stderr in order
+        auto& out = running.out->pipe;
+        if (running.err) {
+            return bp::child(bp::exe = exe.string(), bp::args = args, bp::start_dir = dir, bp::std_in < bp::null,
+                bp::std_out > out, bp::std_err > running.err->pipe, running.group);
+        }
+
+        if (task.log_file && task.capture_stderr) {
+            return bp::child(bp::exe = exe.string(), bp::args = args, bp::start_dir = dir, bp::std_in < bp::null,
+                (bp::std_out & bp::std_err) > out, running.group);
+        }
+
+        return bp::child(bp::exe = exe.string(), bp::args = args, bp::start_dir = dir, bp::std_in < bp::null,
+            bp::std_out > out, bp::std_err > bp::null, running.group);
+    }
+
+    void read_(const std::shared_ptr<RunningTask>& running, OutputPipe& pipe)
+    {
+        pipe.pipe.async_read_some(asio::buffer(pipe.buffer),
+            [this, running, &pipe](const boost::system::error_code& ec, std::size_t size) {
+                if (pipe.sink != nullptr) {
+                    pipe.sink->append(pipe.buffer.data(), size);
+                } else {
+                    running->log.write(pipe.buffer.data(), static_cast<std::streamsize>(size));
+                }
+
+                if (!ec) {
+                    read_(running, pipe);
+                    return;
+                }
+
+                if (--running->open_pipes == 0 && running->reap_on_close) {
+                    reap_(running);
+                }
+                finish_if_done_(running);
+            });
+    }
+
+    void watch_exit_(const std::shared_ptr<RunningTask>& running)
+    {
+#ifdef CPPSHIP_HAS_PIDFD
+        // fails on kernels older than 5.3
+        const auto fd = ::syscall(SYS_pidfd_open, running->child.id(), 0);
+        if (fd < 0) {
+            return;
+        }
+
+        running->reap_on_close = false;
+        running->pidfd.assign(static_cast<int>(fd));
+        running->pidfd.async_wait(asio::posix::descriptor_base::wait_read,
+            [this, running](const boost::system::error_code& ec) {
+                if (ec == asio::error::operation_aborted) {
+                    return;
+                }
+
+                reap_(running);
+                finish_if_done_(running);
+            });
+#else
+        (void)running;
+#endif
+    }
+
+    static void reap_(const std::shared_ptr<RunningTask>& running)
+    {
+        std::error_code ec;
+        running->child.wait(ec);
+        running->exited = true;
+        running->result.exit_code = ec ? -1 : running->child.exit_code();
+    }
+
+    void finish_if_done_(const std::shared_ptr<RunningTask>& running)
+    {
+        // output may still be buffered in the pipes when the child exits
+        if (!running->exited || running->open_pipes > 0) {
+            return;
+        }
+
+        running->timer.cancel();
+        running->log.close();
+        mRunning.erase(running->index);
+        done_(std::move(running->result), running->index);
+
+        launch_more_();
+    }
+
+    void done_(TaskResult result, std::size_t index)
+    {
+        mResults[index] = std::move(result);
+        if (mOnDone) {
+            mOnDone(index, mResults[index]);
+        }
+    }
+
+    void launch_more_()
+    {
+        while (!mCancelled && mNext < mTasks.size() && mRunning.size() < mMaxConcurrency) {
+            launch_next_();
+        }
+    }
+
+    void cancel_()
+    {
+        mCancelled = true;
+        for (; mNext < mTasks.size(); ++mNext) {
+            TaskResult result;
+            result.cancelled = true;
+            done_(std::move(result), mNext);
+        }
+
+        for (const auto& [_, running] : mRunning) {
+            running->result.cancelled = true;
+            std::error_code ec;
+            running->group.terminate(ec);
+        }
+    }
+
+private:
+    const std::vector<Task>& mTasks;
+    unsigned mMaxConcurrency;
+    const TaskCallback& mOnDone;
+
+    asio::io_context mIoc;
+    std::size_t mNext = 0;
+    bool mCancelled = false;
+    std::map<std::size_t, std::shared_ptr<RunningTask>> mRunning;
+    std::vector<TaskResult> mResults;
+};
+
+}
+
 int CmdRunner::run(std::string_view cmd) const
 {
     if (mHook) {
@@ -13,4 +314,32 @@ int CmdRunner::run(std::string_view cmd) const
     return run_cmd(cmd);
 }
 
+std::vector<TaskResult> CmdRunner::run_all(
+    const std::vector<Task>& tasks, unsigned max_concurrency, const TaskCallback& on_done, std::stop_token stop) const
+{
+    if (mHook) {
+        std::vector<TaskResult> results;
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            auto& result = results.emplace_back();
+            if (stop.stop_requested()) {
+                result.cancelled = true;
+            } else {
+                result.exit_code = mHook(boost::join(tasks[i].args, " "));
+            }
+
+            if (on_done) {
+                on_done(i, result);
+            }
+        }
+
+        return results;
+    }
+
+    if (max_concurrency == 0) {
+        max_concurrency = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    return TaskScheduler(tasks, max_concurrency, on_done).run(stop);
+}
+
 }
@@ -0,0 +1,98 @@
+#include "cppship/util/fs.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+#include "cppship/exception.h"
+
+using namespace cppship;
+
+namespace {
+
+const char* get_env(const char* name)
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): environment is never modified
+    const auto* value = std::getenv(name);
+    return value != nullptr && *value != '\0' ? value : nullptr;
+}
+
+}
+
+fs::path cppship::get_current_executable()
+{
+#ifdef _WIN32
+    std::wstring path(MAX_PATH, L'\0');
+    const auto size = GetModuleFileNameW(nullptr, path.data(), static_cast<DWORD>(path.size()));
+    if (size == 0 || size == path.size()) {
+        throw Error { "cannot get path of cppship" };
+    }
+
+    path.resize(size);
+    return path;
+#elif defined(__APPLE__)
+    std::uint32_t size = 0;
+    _NSGetExecutablePath(nullptr, &size);
+
+    std::string path(size, '\0');
+    if (_NSGetExecutablePath(path.data(), &size) != 0) {
+        throw Error { "cannot get path of cppship" };
+    }
+
+    return fs::canonical(path.c_str());
+#else
+    return fs::read_symlink("/proc/self/exe");
+#endif
+}
+
+fs::path cppship::get_cache_dir()
+{
+    if (const auto* dir = get_env("CPPSHIP_CACHE_DIR")) {
+        return dir;
+    }
+
+#ifdef _WIN32
+    if (const auto* dir = get_env("LOCALAPPDATA")) {
+        return fs::path { dir } / "cppship";
+    }
+#else
+    if (const auto* dir = get_env("XDG_CACHE_HOME")) {
+        return fs::path { dir } / "cppship";
+    }
+
+    if (const auto* home = get_env("HOME")) {
+        return fs::path { home } / ".cache" / "cppship";
+    }
+#endif
+
+    throw Error { "cannot determine cache dir, set CPPSHIP_CACHE_DIR" };
+}
+
+fs::path cppship::get_config_file()
+{
+    if (const auto* file = get_env("CPPSHIP_CONFIG")) {
+        return file;
+    }
+
+#ifdef _WIN32
+    if (const auto* dir = get_env("APPDATA")) {
+        return fs::path { dir } / "cppship" / "config.toml";
+    }
+#else
+    if (const auto* dir = get_env("XDG_CONFIG_HOME")) {
+        return fs::path { dir } / "cppship" / "config.toml";
+    }
+
+    if (const auto* home = get_env("HOME")) {
+        return fs::path { home } / ".config" / "cppship" / "config.toml";
+    }
+#endif
+
+    return {};
+}
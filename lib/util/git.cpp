@@ -2,24 +2,173 @@
 #include "cppship/exception.h"
 #include "cppship/util/cmd.h"
 #include "cppship/util/fs.h"
+#include "cppship/util/hash.h"
+#include "cppship/util/io.h"
 #include "cppship/util/log.h"
 
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
 #include <fmt/core.h>
 
 using namespace cppship;
 
-void util::git_clone(std::string_view package, const fs::path& deps_dir, std::string_view git, std::string_view commit)
+namespace {
+
+// top level files, include/ and lib/
+constexpr std::string_view kSparsePatterns = "/*\n!/*/\n/include/\n/lib/\n";
+
+void run_git(const fs::path& repo, std::string_view args, std::string_view error)
+{
+    const int res = run_cmd(fmt::format("git -C {} {}", repo.string(), args));
+    if (res != 0) {
+        throw Error { std::string { error } };
+    }
+}
+
+bool has_commit(const fs::path& repo, std::string_view commit)
+{
+    return run_cmd(fmt::format("git -C {} cat-file -e {}", repo.string(), commit)) == 0;
+}
+
+void enable_sparse_checkout(const fs::path& repo, std::string_view error)
+{
+    run_git(repo, "config core.sparseCheckout true", error);
+
+    const auto info_dir = repo / ".git" / "info";
+    fs::create_directories(info_dir);
+    write(info_dir / "sparse-checkout", kSparsePatterns);
+}
+
+// fcntl locks are owned by the process and released by closing any fd of the file, so threads fetching into the
+// same mirror are serialized by the mutex and share one file_lock, which is kept open
+struct MirrorLock {
+    std::mutex mutex;
+    std::optional<boost::interprocess::file_lock> file_lock;
+};
+
+MirrorLock& mirror_lock(const fs::path& mirror)
+{
+    static std::mutex mutex;
+    static std::map<fs::path, MirrorLock> locks;
+
+    const std::lock_guard guard(mutex);
+    return locks[mirror];
+}
+
+// fetch the commit into the user level bare mirror of the repo, return the mirror and the full commit id
+std::pair<fs::path, std::string> fetch_into_mirror(const GitDep& dep, std::string_view error)
+{
+    const auto mirror = get_cache_dir() / "git" / fmt::format("{}.git", util::hash_hex(dep.git));
+    fs::create_directories(mirror.parent_path());
+
+    auto& lock = mirror_lock(mirror);
+    const std::lock_guard thread_guard(lock.mutex);
+    if (!lock.file_lock) {
+        // file_lock requires the file to exist
+        auto lock_file = mirror;
+        lock_file += ".lock";
+        std::ofstream(lock_file, std::ios::app).close();
+        lock.file_lock.emplace(lock_file.string().c_str());
+    }
+    const std::lock_guard process_guard(*lock.file_lock);
+
+    if (!fs::exists(mirror / "HEAD")) {
+        fs::remove_all(mirror);
+        if (run_cmd(fmt::format("git init -q --bare {}", mirror.string())) != 0) {
+            throw Error { std::string { error } };
+        }
+        run_git(mirror, fmt::format("remote add --mirror=fetch origin {}", dep.git), error);
+    }
+
+    if (!has_commit(mirror, dep.commit)) {
+        status("git", "fetch {}::{} into {}", dep.git, dep.commit, mirror.string());
+
+        // the mirror is as shallow as the fetches into it, deepened only if the server refuses to serve an
+        // unadvertised or abbreviated commit
+        if (run_cmd(fmt::format("git -C {} fetch -q --depth 1 origin {}", mirror.string(), dep.commit)) != 0) {
+            warn("shallow fetch {}::{} failed, fallback to fetch all refs", dep.git, dep.commit);
+            run_git(mirror, fs::exists(mirror / "shallow") ? "fetch -q --unshallow origin" : "fetch -q origin", error);
+        }
+    }
+
+    std::string commit;
+    try {
+        commit = boost::trim_copy(check_output(fmt::format("git -C {} rev-parse {}", mirror.string(), dep.commit)));
+    } catch (const RunCmdFailed&) {
+        throw Error { fmt::format("commit {} not found for {}", dep.commit, dep.git) };
+    }
+
+    // commits fetched by id are not referenced by any branch, pin them against gc
+    run_git(mirror, fmt::format("update-ref refs/cppship/{0} {0}", commit), error);
+    return { mirror, commit };
+}
+
+void clone_direct(const fs::path& package_dep_dir, const GitDep& dep, std::string_view error)
+{
+    fs::create_directories(package_dep_dir);
+    run_git(package_dep_dir, "init -q", error);
+    run_git(package_dep_dir, fmt::format("remote add origin {}", dep.git), error);
+
+    if (dep.sparse) {
+        enable_sparse_checkout(package_dep_dir, error);
+    }
+
+    // servers may refuse to serve an unadvertised or abbreviated commit
+    if (run_cmd(fmt::format("git -C {} fetch -q --depth 1 origin {}", package_dep_dir.string(), dep.commit)) != 0) {
+        warn("shallow fetch {}::{} failed, fallback to full fetch", dep.git, dep.commit);
+        run_git(package_dep_dir, "fetch -q --tags origin", error);
+    }
+
+    run_git(package_dep_dir, fmt::format("checkout -q --detach {}", dep.commit), error);
+}
+
+}
+
+void util::git_clone(std::string_view package, const fs::path& deps_dir, const GitDep& dep)
 {
     const fs::path package_dep_dir = deps_dir / package;
     fs::remove_all(package_dep_dir);
 
-    int res = run_cmd(fmt::format("git clone {} {}", git, package_dep_dir.string()));
-    if (res != 0) {
-        throw Error { fmt::format("install {} from {} failed", package, git) };
+    const auto install_failed = fmt::format("install {} from {} failed", package, dep.git);
+
+    std::pair<fs::path, std::string> mirror;
+    try {
+        mirror = fetch_into_mirror(dep, install_failed);
+    } catch (const fs::filesystem_error& e) {
+        warn("git cache is not available: {}, fetch {} directly", e.what(), package);
+        clone_direct(package_dep_dir, dep, install_failed);
+        return;
+    } catch (const boost::interprocess::interprocess_exception& e) {
+        warn("git cache is not available: {}, fetch {} directly", e.what(), package);
+        clone_direct(package_dep_dir, dep, install_failed);
+        return;
     }
 
-    res = run_cmd(fmt::format("git -C {} reset --hard {}", package_dep_dir.string(), commit));
-    if (res != 0) {
-        throw Error { fmt::format("commit {} not found for {}", commit, package) };
+    // objects are borrowed from the mirror through alternates, nothing is copied, it is done by hand since
+    // git clone ignores --shared for a shallow source
+    const auto& [mirror_dir, commit] = mirror;
+    fs::create_directories(package_dep_dir);
+    run_git(package_dep_dir, "init -q", install_failed);
+
+    const auto git_dir = package_dep_dir / ".git";
+    write(git_dir / "objects" / "info" / "alternates",
+        fmt::format("{}\n", fs::absolute(mirror_dir / "objects").generic_string()));
+    if (fs::exists(mirror_dir / "shallow")) {
+        fs::copy_file(mirror_dir / "shallow", git_dir / "shallow", fs::copy_options::overwrite_existing);
     }
-}
\ No newline at end of file
+
+    if (dep.sparse) {
+        enable_sparse_checkout(package_dep_dir, install_failed);
+    }
+
+    run_git(package_dep_dir,
+        fmt::format("checkout -q --detach {}", commit),
+        fmt::format("commit {} not found for {}", dep.commit, package));
+}
@@ -0,0 +1,412 @@
+#include "cppship/util/http.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include <BS_thread_pool_light.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <fmt/core.h>
+
+#include "cppship/util/io.h"
+#include "cppship/util/log.h"
+
+using namespace cppship;
+using namespace cppship::util;
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = asio::ip::tcp;
+
+namespace {
+
+constexpr std::string_view kBearer = "Bearer ";
+
+std::string to_std(beast::string_view str) { return { str.data(), str.size() }; }
+
+// beast timeouts only work on async operations, so each operation is made async and run to completion with its own
+// deadline. reads and writes go chunk by chunk, a transfer times out only if it stalls rather than if it is large.
+class TimedStream {
+public:
+    explicit TimedStream(std::chrono::milliseconds timeout)
+        : mStream(mIoc)
+        , mTimeout(timeout)
+    {
+    }
+
+    tcp::socket& socket() { return mStream.socket(); }
+
+    beast::error_code connect(const tcp::resolver::results_type& endpoints)
+    {
+        return run_([&](auto handler) {
+            mStream.async_connect(endpoints, [handler](beast::error_code ec, const tcp::endpoint&) { handler(ec, 0); });
+        });
+    }
+
+    template <class Parser> beast::error_code read_header(beast::flat_buffer& buffer, Parser& parser)
+    {
+        while (!parser.is_header_done()) {
+            if (const auto ec = run_([&](auto handler) { http::async_read_some(mStream, buffer, parser, handler); })) {
+                return ec;
+            }
+        }
+
+        return {};
+    }
+
+    template <class Parser> beast::error_code read(beast::flat_buffer& buffer, Parser& parser)
+    {
+        while (!parser.is_done()) {
+            if (const auto ec = run_([&](auto handler) { http::async_read_some(mStream, buffer, parser, handler); })) {
+                return ec;
+            }
+        }
+
+        return {};
+    }
+
+    template <class Serializer> beast::error_code write(Serializer& serializer)
+    {
+        while (!serializer.is_done()) {
+            if (const auto ec = run_([&](auto handler) { http::async_write_some(mStream, serializer, handler); })) {
+                return ec;
+            }
+        }
+
+        return {};
+    }
+
+    template <class Serializer> beast::error_code write_header(Serializer& serializer)
+    {
+        return run_([&](auto handler) { http::async_write_header(mStream, serializer, handler); });
+    }
+
+private:
+    template <class Op> beast::error_code run_(Op&& op)
+    {
+        beast::error_code result;
+        mStream.expires_after(mTimeout);
+        std::forward<Op>(op)([&result](beast::error_code ec, std::size_t) { result = ec; });
+
+        mIoc.restart();
+        mIoc.run();
+        return result;
+    }
+
+private:
+    asio::io_context mIoc;
+    beast::tcp_stream mStream;
+    std::chrono::milliseconds mTimeout;
+};
+
+template <class Body>
+beast::error_code send(
+    TimedStream& stream, const std::string& host, const HttpRequest& request, http::request<Body>& req)
+{
+    req.method(http::string_to_verb(request.method));
+    req.target(request.target);
+    req.set(http::field::host, host);
+    req.set(http::field::user_agent, "cppship");
+    if (!request.token.empty()) {
+        req.set(http::field::authorization, fmt::format("{}{}", kBearer, request.token));
+    }
+    req.prepare_payload();
+
+    http::request_serializer<Body> serializer(req);
+    return stream.write(serializer);
+}
+
+// body of the request is streamed from body_file if given
+beast::error_code send(TimedStream& stream, const std::string& host, const HttpRequest& request)
+{
+    if (request.body_file.empty()) {
+        http::request<http::string_body> req;
+        req.body() = request.body;
+        return send(stream, host, request, req);
+    }
+
+    http::request<http::file_body> req;
+    beast::error_code ec;
+    req.body().open(request.body_file.string().c_str(), beast::file_mode::scan, ec);
+    return ec ? ec : send(stream, host, request, req);
+}
+
+// body of a successful response is streamed into file if given, bodies in memory are limited to kHttpMaxMemoryBody
+HttpResponse receive(TimedStream& stream, bool is_head, const fs::path& file, std::uint64_t limit)
+{
+    beast::flat_buffer buffer;
+    const auto memory_limit = std::min(limit, kHttpMaxMemoryBody);
+    http::response_parser<http::empty_body> header_parser;
+    // content length is checked against the limit along with the header
+    header_parser.body_limit(file.empty() ? memory_limit : limit);
+    // the response to HEAD has a content length but no body
+    header_parser.skip(is_head);
+    if (const auto ec = stream.read_header(buffer, header_parser)) {
+        throw beast::system_error { ec };
+    }
+
+    HttpResponse res { .status = header_parser.get().result_int() };
+    if (file.empty() || !res.ok()) {
+        if (header_parser.content_length().value_or(0) > memory_limit) {
+            throw beast::system_error { http::error::body_limit };
+        }
+
+        http::response_parser<http::string_body> parser { std::move(header_parser) };
+        parser.body_limit(memory_limit);
+        if (const auto ec = stream.read(buffer, parser)) {
+            throw beast::system_error { ec };
+        }
+
+        res.body = std::move(parser.get().body());
+        return res;
+    }
+
+    beast::error_code ec;
+    {
+        http::response_parser<http::file_body> parser { std::move(header_parser) };
+        parser.body_limit(limit);
+        parser.get().body().open(file.string().c_str(), beast::file_mode::write, ec);
+        if (!ec) {
+            ec = stream.read(buffer, parser);
+        }
+    }
+    if (ec) {
+        std::error_code remove_ec;
+        fs::remove(file, remove_ec);
+        throw beast::system_error { ec };
+    }
+
+    res.body_file = file;
+    return res;
+}
+
+HttpResponse transfer(const std::string& host, const std::string& port, const HttpRequest& request,
+    const fs::path& file, std::uint64_t limit, std::chrono::milliseconds timeout)
+{
+    asio::io_context ioc;
+    tcp::resolver resolver(ioc);
+    TimedStream stream(timeout);
+
+    beast::error_code result = stream.connect(resolver.resolve(host, port));
+    if (!result) {
+        result = send(stream, host, request);
+    }
+    if (result) {
+        throw beast::system_error { result };
+    }
+
+    auto res = receive(stream, request.method == "HEAD", file, limit);
+
+    beast::error_code ec;
+    stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+    return res;
+}
+
+template <class Body>
+beast::error_code reply(TimedStream& stream, http::response<Body>& res, const bool is_head)
+{
+    res.set(http::field::content_type, "application/octet-stream");
+    res.prepare_payload();
+
+    // content length of HEAD is the same as GET, but no body is sent
+    http::response_serializer<Body> serializer(res);
+    return is_head ? stream.write_header(serializer) : stream.write(serializer);
+}
+
+}
+
+HttpResponse util::http_request(
+    const std::string& host, const std::string& port, const HttpRequest& request, std::chrono::milliseconds timeout)
+{
+    return transfer(host, port, request, {}, kHttpMaxMemoryBody, timeout);
+}
+
+HttpResponse util::http_download(const std::string& host, const std::string& port, const HttpRequest& request,
+    const fs::path& file, std::uint64_t limit, std::chrono::milliseconds timeout)
+{
+    return transfer(host, port, request, file, limit, timeout);
+}
+
+struct HttpServer::Impl {
+    asio::io_context ioc;
+    tcp::acceptor acceptor;
+    Handler handler;
+    std::uint64_t body_limit;
+    fs::path body_dir;
+
+    // declared last, so connections are done before the others are destroyed
+    BS::thread_pool_light workers;
+
+    Impl(std::string_view host, std::uint16_t port, Handler handler_, unsigned concurrency, std::uint64_t body_limit_,
+        fs::path body_dir_)
+        : acceptor(ioc, tcp::endpoint { asio::ip::make_address(host), port })
+        , handler(std::move(handler_))
+        , body_limit(body_limit_)
+        , body_dir(std::move(body_dir_))
+        , workers(concurrency)
+    {
+        if (!body_dir.empty()) {
+            fs::create_directories(body_dir);
+        }
+    }
+
+    void accept()
+    {
+        // each connection runs its own io_context on the worker serving it, idle ones are closed by the timeout
+        auto conn = std::make_shared<TimedStream>(kHttpTimeout);
+        acceptor.async_accept(conn->socket(), [this, conn](beast::error_code ec) {
+            if (ec) {
+                // the acceptor is closed by stop
+                if (ec != asio::error::operation_aborted) {
+                    warn("http server accept failed: {}", ec.message());
+                }
+                return;
+            }
+
+            workers.push_task([this, conn] { serve(*conn); });
+            accept();
+        });
+    }
+
+    // the body goes into a temp file under body_dir if given, otherwise into memory
+    beast::error_code read_body(TimedStream& stream, beast::flat_buffer& buffer,
+        http::request_parser<http::empty_body>& header_parser, HttpRequest& request) const
+    {
+        if (body_dir.empty() || header_parser.is_done()) {
+            http::request_parser<http::string_body> parser { std::move(header_parser) };
+            parser.body_limit(std::min(body_limit, kHttpMaxMemoryBody));
+            const auto ec = stream.read(buffer, parser);
+            request.body = std::move(parser.get().body());
+            return ec;
+        }
+
+        request.body_file = temp_file_for(body_dir / "body");
+        http::request_parser<http::file_body> parser { std::move(header_parser) };
+        parser.body_limit(body_limit);
+        beast::error_code ec;
+        parser.get().body().open(request.body_file.string().c_str(), beast::file_mode::write, ec);
+        return ec ? ec : stream.read(buffer, parser);
+    }
+
+    static beast::error_code respond(TimedStream& stream, const HttpResponse& result, const unsigned version,
+        const bool keep_alive, const bool is_head)
+    {
+        const auto status = static_cast<http::status>(result.status);
+        if (result.body_file.empty()) {
+            http::response<http::string_body> res { status, version, result.body };
+            res.keep_alive(keep_alive);
+            return reply(stream, res, is_head);
+        }
+
+        http::response<http::file_body> res { status, version };
+        res.keep_alive(keep_alive);
+        beast::error_code ec;
+        res.body().open(result.body_file.string().c_str(), beast::file_mode::scan, ec);
+        return ec ? ec : reply(stream, res, is_head);
+    }
+
+    void serve(TimedStream& stream) const
+    {
+        beast::flat_buffer buffer;
+
+        try {
+            while (true) {
+                http::request_parser<http::empty_body> header_parser;
+                // content length is checked against the limit along with the header
+                header_parser.body_limit(body_dir.empty() ? std::min(body_limit, kHttpMaxMemoryBody) : body_limit);
+                auto ec = stream.read_header(buffer, header_parser);
+                if (ec == http::error::end_of_stream) {
+                    break;
+                }
+                if (ec == http::error::body_limit) {
+                    respond(stream, { .status = kHttpPayloadTooLarge }, header_parser.get().version(), false, false);
+                }
+                if (ec) {
+                    debug("http server read failed: {}", ec.message());
+                    break;
+                }
+
+                const auto& header = header_parser.get();
+                const auto version = header.version();
+                const bool keep_alive = header.keep_alive();
+                const bool is_head = header.method() == http::verb::head;
+                auto token = to_std(header[http::field::authorization]);
+                token.erase(0, token.starts_with(kBearer) ? kBearer.size() : token.size());
+                HttpRequest request {
+                    .method = to_std(header.method_string()),
+                    .target = to_std(header.target()),
+                    .token = std::move(token),
+                };
+
+                ec = read_body(stream, buffer, header_parser, request);
+                if (ec) {
+                    std::error_code remove_ec;
+                    fs::remove(request.body_file, remove_ec);
+                    debug("http server read failed: {}", ec.message());
+                    if (ec == http::error::body_limit) {
+                        respond(stream, { .status = kHttpPayloadTooLarge }, version, false, is_head);
+                    }
+                    break;
+                }
+
+                const auto result = std::invoke([&] {
+                    try {
+                        return handler(request);
+                    } catch (const std::exception& e) {
+                        warn("http server {} {} failed: {}", request.method, request.target, e.what());
+                        return HttpResponse { .status = kHttpInternalError };
+                    }
+                });
+                if (!request.body_file.empty()) {
+                    std::error_code remove_ec;
+                    fs::remove(request.body_file, remove_ec);
+                }
+
+                if (const auto write_ec = respond(stream, result, version, keep_alive, is_head)) {
+                    debug("http server write failed: {}", write_ec.message());
+                    break;
+                }
+
+                if (!keep_alive) {
+                    break;
+                }
+            }
+        } catch (const std::exception& e) {
+            debug("http server connection closed: {}", e.what());
+        }
+
+        beast::error_code ec;
+        stream.socket().shutdown(tcp::socket::shutdown_send, ec);
+    }
+};
+
+HttpServer::HttpServer(std::string_view host, std::uint16_t port, Handler handler, unsigned workers,
+    std::uint64_t body_limit, fs::path body_dir)
+    : mImpl(std::make_unique<Impl>(host, port, std::move(handler), workers, body_limit, std::move(body_dir)))
+{
+}
+
+HttpServer::~HttpServer() = default;
+
+std::uint16_t HttpServer::port() const { return mImpl->acceptor.local_endpoint().port(); }
+
+void HttpServer::run()
+{
+    mImpl->accept();
+    mImpl->ioc.run();
+}
+
+void HttpServer::stop()
+{
+    asio::post(mImpl->ioc, [impl = mImpl.get()] { impl->acceptor.close(); });
+}
@@ -1,8 +1,11 @@
 #include "cppship/util/io.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <iterator>
+#include <random>
 #include <sstream>
 
 #include "cppship/exception.h"
@@ -23,6 +26,35 @@ void cppship::write(const fs::path& file, std::string_view content)
     }
 }
 
+fs::path cppship::temp_file_for(const fs::path& file)
+{
+    // unique among threads and processes writing the same file
+    static const auto process_id = std::random_device {}();
+    static std::atomic<std::uint64_t> tmp_id = 0;
+
+    auto tmp_file = file;
+    tmp_file += fmt::format(".{:x}.{}.tmp", process_id, tmp_id++);
+    return tmp_file;
+}
+
+void cppship::write_atomic(const fs::path& file, std::string_view content)
+{
+    const auto tmp_file = temp_file_for(file);
+    {
+        std::ofstream ofs(tmp_file, std::ios::binary | std::ios::trunc);
+        ofs.write(content.data(), static_cast<std::streamsize>(content.size()));
+        ofs.flush();
+
+        if (!ofs) {
+            ofs.close();
+            fs::remove(tmp_file);
+            throw IOError { fmt::format("write file {} failed", file.string()) };
+        }
+    }
+
+    fs::rename(tmp_file, file);
+}
+
 void cppship::touch(const fs::path& file)
 {
     if (!fs::exists(file)) {
@@ -57,3 +89,13 @@ std::string cppship::read_as_string(std::istream& iss)
 
     return oss.str();
 }
+
+std::string cppship::read_binary(const fs::path& file)
+{
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs) {
+        throw IOError { fmt::format("cannot open file {} to read", file.string()) };
+    }
+
+    return read_as_string(ifs);
+}
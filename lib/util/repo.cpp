@@ -1,17 +1,23 @@
 #include "cppship/util/repo.h"
 
 #include <array>
+#include <charconv>
 #include <filesystem>
+#include <future>
+#include <iterator>
 #include <optional>
+#include <vector>
 
+#include <BS_thread_pool_light.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <range/v3/algorithm/contains.hpp>
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/view.hpp>
-#include <toml/parser.hpp>
 
 #include "cppship/exception.h"
 #include "cppship/util/cmd.h"
 #include "cppship/util/string.h"
+#include "cppship/util/toml.h"
 
 using namespace cppship;
 using namespace ranges;
@@ -26,8 +32,7 @@ std::optional<fs::path> get_workspace_root(const fs::path& root)
     while (true) {
         const auto manifest = current / kRepoConfigFile;
         if (fs::exists(manifest)) {
-            const auto value = toml::parse(manifest);
-            if (value.contains("workspace")) {
+            if (load_toml(manifest)->contains("workspace")) {
                 return current;
             }
         }
@@ -120,20 +125,35 @@ std::set<fs::path> cppship::list_cpp_files(const fs::path& dir)
 std::set<fs::path> cppship::list_all_files()
 {
     const auto root_dir = get_project_root();
+    constexpr std::array kSubdirs { kIncludePath, kSrcPath, kLibPath, kTestsPath, kBenchesPath, kExamplesPath };
+
+    // subdirs are disjoint, walk them concurrently
+    BS::thread_pool_light pool(kSubdirs.size());
+    std::vector<std::future<std::vector<fs::path>>> tasks;
+    tasks.reserve(kSubdirs.size());
+    for (const auto subdir : kSubdirs) {
+        tasks.push_back(pool.submit([dir = root_dir / subdir] {
+            std::vector<fs::path> files;
+            if (!fs::exists(dir)) {
+                return files;
+            }
 
-    std::set<fs::path> files;
+            for (const fs::directory_entry& dentry : fs::recursive_directory_iterator { dir }) {
+                if (ranges::contains(kSourceExtension, dentry.path().extension())) {
+                    files.push_back(dentry.path());
+                }
+            }
 
-    for (const auto subdir : { kIncludePath, kSrcPath, kLibPath, kTestsPath, kBenchesPath, kExamplesPath }) {
-        const auto dir = root_dir / subdir;
-        if (!fs::exists(dir)) {
-            continue;
-        }
+            return files;
+        }));
+    }
 
-        for (const fs::directory_entry& dentry : fs::recursive_directory_iterator { dir }) {
-            if (ranges::contains(kSourceExtension, dentry.path().extension())) {
-                files.insert(dentry.path());
-            }
-        }
+    pool.wait_for_tasks();
+
+    std::set<fs::path> files;
+    for (auto& task : tasks) {
+        auto subdir_files = task.get();
+        files.insert(std::make_move_iterator(subdir_files.begin()), std::make_move_iterator(subdir_files.end()));
     }
 
     return files;
@@ -146,14 +166,241 @@ std::set<fs::path> cppship::list_changed_files(const ListOptions& options)
         return list_all_files();
     }
 
-    const auto cmd = fmt::format("git diff {} --name-only {}", options.commit, (options.cached_only ? "--cached" : ""));
+    // nul separated names are never quoted
+    const auto cmd
+        = fmt::format("git diff {} --name-only -z {}", options.commit, (options.cached_only ? "--cached" : ""));
     const auto out = check_output(cmd);
 
-    const auto lines = util::split(out, boost::is_any_of("\n"));
+    const auto lines = util::split(out, [](char c) { return c == '\0'; });
 
-    return lines | views::filter([](std::string_view line) { return !line.empty(); })
+    auto files = lines | views::filter([](std::string_view line) { return !line.empty(); })
         | views::transform(
-            [root = root.string()](std::string_view line) { return fs::path(fmt::format("{}/{}", root, line)); })
+            [root = root.string()](std::string_view line) { return fs::path(fmt::format("{}/{}", root, line)); });
+    if (!options.sources_only) {
+        return files | to<std::set>();
+    }
+
+    return files
         | views::filter([](const fs::path& path) { return ranges::contains(kSourceExtension, path.extension()); })
         | views::filter([](const fs::path& path) { return fs::exists(path); }) | to<std::set>();
 }
+
+namespace {
+
+constexpr std::string_view kDiffFileHeaderPrefix = "diff --git ";
+constexpr std::string_view kDiffNewFilePrefix = "+++ ";
+constexpr std::string_view kDiffDstPrefix = "b/";
+constexpr std::string_view kDiffHunkPrefix = "@@ ";
+
+// git quotes paths with special chars in the form of C string literals, `"b/a\tb.cpp"`
+std::optional<std::string> unquote_path(std::string_view path)
+{
+    if (!path.starts_with('"')) {
+        return std::string { path };
+    }
+
+    if (path.size() < 2 || !path.ends_with('"')) {
+        return std::nullopt;
+    }
+
+    path = path.substr(1, path.size() - 2);
+    std::string result;
+    while (!path.empty()) {
+        const char c = path.front();
+        path.remove_prefix(1);
+        if (c != '\\') {
+            result.push_back(c);
+            continue;
+        }
+
+        if (path.empty()) {
+            return std::nullopt;
+        }
+
+        const char escaped = path.front();
+        path.remove_prefix(1);
+        switch (escaped) {
+        case 'a':
+            result.push_back('\a');
+            break;
+        case 'b':
+            result.push_back('\b');
+            break;
+        case 't':
+            result.push_back('\t');
+            break;
+        case 'n':
+            result.push_back('\n');
+            break;
+        case 'v':
+            result.push_back('\v');
+            break;
+        case 'f':
+            result.push_back('\f');
+            break;
+        case 'r':
+            result.push_back('\r');
+            break;
+        case '"':
+        case '\\':
+            result.push_back(escaped);
+            break;
+        default: {
+            // bytes of utf-8 names are in 3 octal digits
+            if (escaped < '0' || escaped > '3' || path.size() < 2) {
+                return std::nullopt;
+            }
+
+            int byte = escaped - '0';
+            for (int i = 0; i < 2; ++i) {
+                if (path.front() < '0' || path.front() > '7') {
+                    return std::nullopt;
+                }
+
+                byte = byte * 8 + (path.front() - '0');
+                path.remove_prefix(1);
+            }
+
+            result.push_back(static_cast<char>(byte));
+        }
+        }
+    }
+
+    return result;
+}
+
+std::optional<int> consume_int(std::string_view& str)
+{
+    int value = 0;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (ec != std::errc {}) {
+        return std::nullopt;
+    }
+
+    str.remove_prefix(static_cast<std::size_t>(ptr - str.data()));
+    return value;
+}
+
+// parse `+c,d` or `+c` in `@@ -a,b +c,d @@`, pure deletion results in an empty range
+std::optional<LineRange> parse_hunk_header(std::string_view line)
+{
+    const auto pos = line.find(" +");
+    if (pos == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    line.remove_prefix(pos + 2);
+    const auto start = consume_int(line);
+    if (!start) {
+        return std::nullopt;
+    }
+
+    int count = 1;
+    if (line.starts_with(',')) {
+        line.remove_prefix(1);
+        const auto n = consume_int(line);
+        if (!n) {
+            return std::nullopt;
+        }
+
+        count = *n;
+    }
+
+    if (count == 0) {
+        return LineRange {};
+    }
+
+    return LineRange { .first = *start, .last = *start + count - 1 };
+}
+
+}
+
+std::map<std::string, std::vector<LineRange>> repo_internals::parse_diff_hunks(std::string_view diff)
+{
+    std::map<std::string, std::vector<LineRange>> result;
+    std::vector<LineRange>* current = nullptr;
+    // added lines may also start with `+++`, only check file names in headers
+    bool in_file_header = false;
+
+    for (const auto& line : util::split(diff, boost::is_any_of("\n"))) {
+        if (line.starts_with(kDiffFileHeaderPrefix)) {
+            in_file_header = true;
+            current = nullptr;
+            continue;
+        }
+
+        if (in_file_header && line.starts_with(kDiffNewFilePrefix)) {
+            auto header = std::string_view { line }.substr(kDiffNewFilePrefix.size());
+            // names with spaces are followed by a tab
+            if (header.ends_with('\t')) {
+                header.remove_suffix(1);
+            }
+
+            const auto file = unquote_path(header);
+            if (!file) {
+                throw Error { fmt::format("invalid diff file header: {}", line) };
+            }
+
+            // deleted file has `+++ /dev/null`
+            current = file->starts_with(kDiffDstPrefix) ? &result[file->substr(kDiffDstPrefix.size())] : nullptr;
+            continue;
+        }
+
+        if (!line.starts_with(kDiffHunkPrefix)) {
+            continue;
+        }
+
+        in_file_header = false;
+        if (current == nullptr) {
+            continue;
+        }
+
+        const auto range = parse_hunk_header(line);
+        if (!range) {
+            throw Error { fmt::format("invalid diff hunk: {}", line) };
+        }
+
+        // pure deletion
+        if (range->first == 0) {
+            continue;
+        }
+
+        current->push_back(*range);
+    }
+
+    std::erase_if(result, [](const auto& item) { return item.second.empty(); });
+    return result;
+}
+
+std::map<fs::path, std::vector<LineRange>> cppship::list_changed_lines(const ListOptions& options)
+{
+    const auto root = get_project_root();
+    if (!fs::exists(root / ".git")) {
+        std::map<fs::path, std::vector<LineRange>> result;
+        for (const auto& file : list_all_files()) {
+            result.emplace(file, std::vector<LineRange> {});
+        }
+
+        return result;
+    }
+
+    // fix prefixes in case of diff.noprefix or diff.mnemonicPrefix, and keep non-ascii names unquoted
+    const auto cmd = fmt::format(
+        "git -c core.quotePath=false diff {} -U0 --no-color --no-ext-diff --src-prefix=a/ --dst-prefix=b/ {}",
+        options.commit,
+        (options.cached_only ? "--cached" : ""));
+    const auto hunks = repo_internals::parse_diff_hunks(check_output(cmd));
+
+    std::map<fs::path, std::vector<LineRange>> result;
+    for (const auto& [file, lines] : hunks) {
+        auto path = root / file;
+        if (!ranges::contains(kSourceExtension, path.extension()) || !fs::exists(path)) {
+            continue;
+        }
+
+        result.emplace(std::move(path), lines);
+    }
+
+    return result;
+}
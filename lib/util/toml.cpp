@@ -0,0 +1,62 @@
+#include "cppship/util/toml.h"
+
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <toml/parser.hpp>
+
+#include "cppship/util/io.h"
+
+using namespace cppship;
+
+namespace {
+
+struct CachedToml {
+    std::string content;
+    std::shared_ptr<const toml::value> value;
+};
+
+struct TomlCache {
+    std::mutex mutex;
+    std::map<fs::path, CachedToml> entries;
+};
+
+TomlCache& get_cache()
+{
+    static TomlCache cache;
+    return cache;
+}
+
+}
+
+std::shared_ptr<const toml::value> cppship::load_toml(const fs::path& file)
+{
+    auto& cache = get_cache();
+    const auto key = fs::absolute(file).lexically_normal();
+    // reading is much cheaper than parsing, compare content rather than mtime to be robust to coarse timestamps
+    auto content = read_as_string(key);
+
+    {
+        const std::lock_guard lock(cache.mutex);
+        if (const auto it = cache.entries.find(key); it != cache.entries.end() && it->second.content == content) {
+            return it->second.value;
+        }
+    }
+
+    std::istringstream iss(content);
+    auto value = std::make_shared<const toml::value>(toml::parse(iss, file.string()));
+
+    const std::lock_guard lock(cache.mutex);
+    cache.entries.insert_or_assign(key, CachedToml { .content = std::move(content), .value = value });
+    return value;
+}
+
+void cppship::clear_toml_cache()
+{
+    auto& cache = get_cache();
+    const std::lock_guard lock(cache.mutex);
+    cache.entries.clear();
+}
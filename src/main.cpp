@@ -1,15 +1,21 @@
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <list>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <argparse/argparse.hpp>
+#include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <gsl/narrow>
+#include <range/v3/algorithm/find.hpp>
 #include <range/v3/algorithm/find_if.hpp>
 #include <spdlog/spdlog.h>
 
+#include "cppship/core/dist.h"
 #include "cppship/cppship.h"
 #include "cppship/exception.h"
 #include "cppship/util/log.h"
@@ -51,6 +57,23 @@ Profile get_profile(const ArgumentParser& cmd)
     return cmd.get<bool>("r") ? Profile::release : Profile::debug;
 }
 
+std::vector<Profile> get_profiles(const ArgumentParser& cmd)
+{
+    std::vector<Profile> profiles;
+    if (const auto spec = cmd.present("--profiles")) {
+        std::vector<std::string> names;
+        boost::split(names, *spec, boost::is_any_of(","), boost::token_compress_on);
+        for (const auto& name : names) {
+            const auto profile = parse_profile(name);
+            if (ranges::find(profiles, profile) == profiles.end()) {
+                profiles.push_back(profile);
+            }
+        }
+    }
+
+    return profiles;
+}
+
 int get_concurrency(const ArgumentParser& cmd)
 {
     const auto jobs = cmd.get<int>("jobs");
@@ -103,6 +126,7 @@ std::list<SubCommand> build_commands(const ArgumentParser& common)
             .all = cmd.get<bool>("all"),
             .cached_only = cmd.get<bool>("cached"),
             .fix = cmd.get<bool>("fix"),
+            .changed_lines = cmd.get<bool>("lines"),
             .commit = cmd.get("--commit"),
         });
     });
@@ -111,6 +135,10 @@ std::list<SubCommand> build_commands(const ArgumentParser& common)
     fmt.parser.add_argument("-a", "--all").help("run on all code or delta").default_value(false).implicit_value(true);
     fmt.parser.add_argument("--cached").help("only lint staged changes").default_value(false).implicit_value(true);
     fmt.parser.add_argument("-f", "--fix").help("fix or check-only(default)").default_value(false).implicit_value(true);
+    fmt.parser.add_argument("-l", "--lines")
+        .help("only format changed lines rather than whole files")
+        .default_value(false)
+        .implicit_value(true);
     fmt.parser.add_argument("-c", "--commit").help("run on delta changes against the commit").default_value("HEAD"s);
 
     // build
@@ -135,6 +163,8 @@ std::list<SubCommand> build_commands(const ArgumentParser& common)
             .dry_run = cmd.get<bool>("-d"),
             .package = cmd.present("--package"),
             .groups = groups,
+            .profiles = get_profiles(cmd),
+            .changed_since = cmd.present("--changed-since"),
         });
     });
 
@@ -151,11 +181,33 @@ std::list<SubCommand> build_commands(const ArgumentParser& common)
         .implicit_value(true);
     build.parser.add_argument("-p", "--package").help("package to build");
     build.parser.add_argument("--profile").help("build with specific profile").default_value(kProfileDebug);
+    build.parser.add_argument("--profiles")
+        .help("build multiple profiles concurrently, eg. debug,release,profiling")
+        .metavar("profiles");
+    build.parser.add_argument("--changed-since")
+        .help("only build packages affected by changes since the git revision")
+        .metavar("rev");
     build.parser.add_argument("--examples").help("build all examples").default_value(false).implicit_value(true);
     build.parser.add_argument("--tests").help("build all tests").default_value(false).implicit_value(true);
     build.parser.add_argument("--bins").help("build all binaries").default_value(false).implicit_value(true);
     build.parser.add_argument("--benches").help("build all benches").default_value(false).implicit_value(true);
 
+    // stats
+    auto& stats = commands.emplace_back("stats", common, [](const ArgumentParser& cmd) {
+        return cmd::run_stats({
+            .since = cmd.present("--since"),
+            .profile = cmd.present("--profile"),
+            .top = gsl::narrow<std::size_t>(cmd.get<int>("-n")),
+        });
+    });
+
+    stats.parser.add_description("show trends of recorded builds, the slowest units and targets and regressions");
+    stats.parser.add_argument("--since")
+        .help("report regressions against builds before the date(YYYY-MM-DD) or git revision")
+        .metavar("since");
+    stats.parser.add_argument("--profile").help("only builds of the profile").metavar("profile");
+    stats.parser.add_argument("-n").help("number of builds and items to show").default_value(10).scan<'d', int>();
+
     // clean
     auto& clean = commands.emplace_back("clean", common, [](const ArgumentParser&) { return cmd::run_clean({}); });
 
@@ -205,6 +257,7 @@ std::list<SubCommand> build_commands(const ArgumentParser& common)
             .package = cmd.present("package"),
             .name_regex = cmd.present("-R"),
             .rerun_failed = cmd.get<bool>("--rerun-failed"),
+            .changed_since = cmd.present("--changed-since"),
         });
     });
 
@@ -220,6 +273,9 @@ std::list<SubCommand> build_commands(const ArgumentParser& common)
         .help("run only the tests that failed previously")
         .default_value(false)
         .implicit_value(true);
+    test.parser.add_argument("--changed-since")
+        .help("only test packages affected by changes since the git revision")
+        .metavar("rev");
     test.parser.add_argument("testname").help("if specified, only run a single test").nargs(0, 1);
 
     // bench
@@ -236,7 +292,7 @@ std::list<SubCommand> build_commands(const ArgumentParser& common)
     bench.parser.add_argument("--profile")
         .help("build with specific profile")
         .metavar("profile")
-        .default_value(std::string { kProfileRelease });
+        .default_value(std::string { kProfileBench });
     bench.parser.add_argument("benchname").help("if specified, only run bench with specified name").nargs(0, 1);
 
     // init
@@ -281,6 +337,71 @@ std::list<SubCommand> build_commands(const ArgumentParser& common)
 
     cmake.parser.add_description("generate cmake CMakeFiles.txt");
 
+    // vendor
+    auto& vendor = commands.emplace_back("vendor", common, [](const ArgumentParser& cmd) {
+        const auto output = cmd.present("--output");
+        const auto restore = cmd.present("--restore");
+        return cmd::run_vendor({
+            .profile = get_profile(cmd),
+            .output_dir = output ? std::make_optional<fs::path>(*output) : std::nullopt,
+            .restore = restore ? std::make_optional<fs::path>(*restore) : std::nullopt,
+        });
+    });
+
+    vendor.parser.add_description("pack dependencies into an archive for offline builds, or restore from it");
+    vendor.parser.add_argument("-r").help("vendor release dependencies").default_value(false).implicit_value(true);
+    vendor.parser.add_argument("--profile")
+        .help("vendor dependencies of specific profile")
+        .metavar("profile")
+        .default_value(kProfileDebug);
+    vendor.parser.add_argument("-o", "--output").help("directory to put the archive, default to build").metavar("dir");
+    vendor.parser.add_argument("--restore").help("restore dependencies from the archive").metavar("archive");
+
+    // cache-server
+    auto& cache_server = commands.emplace_back("cache-server", common, [](const ArgumentParser& cmd) {
+        const auto root = cmd.present("--root");
+        return cmd::run_cache_server({
+            .host = cmd.get("--host"),
+            .port = gsl::narrow<std::uint16_t>(cmd.get<int>("--port")),
+            .root = root ? std::make_optional<fs::path>(*root) : std::nullopt,
+            .max_size = gsl::narrow<std::uint64_t>(cmd.get<int>("--max-size")),
+        });
+    });
+
+    cache_server.parser.add_description("serve a remote build cache on local disk, see CPPSHIP_REMOTE_CACHE");
+    cache_server.parser.add_argument("--host").help("address to listen on").default_value(std::string { "127.0.0.1" });
+    cache_server.parser.add_argument("--port").help("port to listen on").default_value(8080).scan<'d', int>();
+    cache_server.parser.add_argument("--root").help("directory to store blobs").metavar("dir");
+    cache_server.parser.add_argument("--max-size")
+        .help("reject blobs larger than it, in MiB")
+        .metavar("MiB")
+        .default_value(gsl::narrow<int>(kRemoteCacheMaxBlobSize >> 20))
+        .scan<'d', int>();
+
+    // worker
+    auto& worker = commands.emplace_back("worker", common, [](const ArgumentParser& cmd) {
+        const auto slots = cmd.present<int>("-j");
+        return cmd::run_worker({
+            .host = cmd.get("--host"),
+            .port = gsl::narrow<std::uint16_t>(cmd.get<int>("--port")),
+            .slots = slots ? std::make_optional(gsl::narrow<unsigned>(*slots)) : std::nullopt,
+            .compiler = cmd.present("--cxx"),
+            .token = cmd.present("--token"),
+        });
+    });
+
+    worker.parser.add_description("serve distributed compilation, see CPPSHIP_DIST_WORKERS");
+    worker.parser.add_argument("--host").help("address to listen on").default_value(std::string { "127.0.0.1" });
+    worker.parser.add_argument("--port").help("port to listen on").default_value(3633).scan<'d', int>();
+    worker.parser.add_argument("-j")
+        .help("max concurrent compilations, default to cores")
+        .metavar("n")
+        .scan<'d', int>();
+    worker.parser.add_argument("--cxx").help("compiler to use, default to the detected one").metavar("compiler");
+    worker.parser.add_argument("--token")
+        .help("token required from clients, default to CPPSHIP_DIST_TOKEN or dist.token of the user config")
+        .metavar("token");
+
     return commands;
 }
 
@@ -290,6 +411,11 @@ int main(int argc, const char* argv[])
 try {
     spdlog::set_pattern("%v");
 
+    // args of the compiler launcher belong to the compiler
+    if (argc > 1 && argv[1] == dist::kLauncherCommand) {
+        return cmd::run_dist_compile({ argv + 2, argv + argc });
+    }
+
     ArgumentParser common("common", "", argparse::default_arguments::none);
     common.add_argument("-V", "--verbose").help("show verbose log").default_value(false).implicit_value(true);
     common.add_argument("-q", "--quiet").help("do not print log messages").default_value(false).implicit_value(true);
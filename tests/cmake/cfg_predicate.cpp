@@ -13,6 +13,13 @@ TEST(cfg_predicate, Option)
     ASSERT_EQ(generate_predicate(cfg::Compiler::msvc), R"(CMAKE_CXX_COMPILER_ID STREQUAL "MSVC")");
 }
 
+TEST(cfg_predicate, Target)
+{
+    ASSERT_EQ(generate_predicate(cfg::Arch::aarch64), R"(CMAKE_SYSTEM_PROCESSOR MATCHES "^(aarch64|arm64|ARM64)$")");
+    ASSERT_EQ(generate_predicate(cfg::Feature::sse4_2), R"("sse4.2" IN_LIST CPPSHIP_TARGET_FEATURES)");
+    ASSERT_EQ(generate_predicate(CfgNot { cfg::Feature::avx2 }), R"(NOT ("avx2" IN_LIST CPPSHIP_TARGET_FEATURES))");
+}
+
 TEST(cfg_predicate, Not)
 {
     ASSERT_EQ(generate_predicate(CfgNot { cfg::Os::windows }), R"(NOT (CMAKE_SYSTEM_NAME STREQUAL "Windows"))");
@@ -0,0 +1,136 @@
+#include "cppship/cmake/compile_db.h"
+
+#include <atomic>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <gtest/gtest.h>
+
+#include "cppship/core/dependency.h"
+#include "cppship/util/fs.h"
+#include "cppship/util/io.h"
+#include "cppship/util/repo.h"
+
+using namespace cppship;
+using namespace cppship::cmake;
+
+namespace {
+
+fs::path make_package()
+{
+    static std::atomic<int> S_COUNTER { 0 };
+
+    const auto dir = fs::temp_directory_path() / fmt::format("compile-db-{}", ++S_COUNTER);
+    fs::remove_all(dir);
+    create_if_not_exist(dir / kSrcPath);
+    create_if_not_exist(dir / kLibPath);
+    create_if_not_exist(dir / kIncludePath);
+    write(dir / kSrcPath / "main.cpp", "");
+    write(dir / kLibPath / "a.cpp", "");
+    write(dir / kRepoConfigFile, R"([package]
+name = "abc-abc"
+version = "0.1.0"
+std = 20
+
+[profile]
+definitions = ["A=1"]
+
+[target.'cfg(compiler = "msvc")'.profile]
+cxxflags = ["/MP"]
+
+[target.'cfg(not(compiler = "msvc"))'.profile]
+cxxflags = ["-Wall"]
+
+[target.'cfg(target_feature = "avx2")'.profile]
+definitions = ["HAS_AVX2"]
+
+[profile.release]
+cxxflags = ["-march=native"]
+)");
+
+    return dir;
+}
+
+}
+
+TEST(compile_db, Package)
+{
+    const auto dir = make_package();
+    const Manifest manifest { dir / kRepoConfigFile };
+    const Workspace workspace { dir, manifest };
+
+    const auto db = generate_compile_db(workspace,
+        manifest,
+        {
+            .compiler = "g++",
+            .profile = Profile::debug,
+            .platform = {
+                .os = core::cfg::Os::linux,
+                .compiler = core::cfg::Compiler::gcc,
+                .arch = core::cfg::Arch::x86_64,
+                .features = {},
+            },
+            .build_dir = dir / "build",
+            .dependency_includes = { "/deps/fmt/include" },
+        });
+
+    EXPECT_TRUE(boost::starts_with(db, "[\n")) << db;
+    EXPECT_TRUE(boost::ends_with(db, "\n]\n")) << db;
+
+    const auto lib_source = (dir / kLibPath / "a.cpp").string();
+    const auto bin_source = (dir / kSrcPath / "main.cpp").string();
+    EXPECT_TRUE(boost::contains(db, fmt::format(R"("file": "{}")", lib_source))) << db;
+    EXPECT_TRUE(boost::contains(db, fmt::format(R"("file": "{}")", bin_source))) << db;
+    EXPECT_TRUE(boost::contains(db, fmt::format(R"("-I", "{}")", (dir / kIncludePath).string()))) << db;
+    EXPECT_TRUE(boost::contains(db, R"("-isystem", "/deps/fmt/include")")) << db;
+    EXPECT_TRUE(boost::contains(db, R"("-g", "-DA=1", "-Wall", "-std=c++20")")) << db;
+    EXPECT_TRUE(boost::contains(db, R"("-DABC_ABC_VERSION=\"0.1.0\"")")) << db;
+    EXPECT_FALSE(boost::contains(db, "/MP")) << db;
+    EXPECT_FALSE(boost::contains(db, "-march=native")) << db;
+    EXPECT_FALSE(boost::contains(db, "HAS_AVX2")) << db;
+
+    fs::remove_all(dir);
+}
+
+TEST(compile_db, ProfileAndPlatform)
+{
+    const auto dir = make_package();
+    const Manifest manifest { dir / kRepoConfigFile };
+    const Workspace workspace { dir, manifest };
+
+    const auto db = generate_compile_db(workspace,
+        manifest,
+        {
+            .compiler = "cl",
+            .profile = Profile::release,
+            .platform = {
+                .os = core::cfg::Os::windows,
+                .compiler = core::cfg::Compiler::msvc,
+                .arch = core::cfg::Arch::x86_64,
+                .features = { core::cfg::Feature::avx2 },
+            },
+            .build_dir = dir / "build",
+            .dependency_includes = {},
+        });
+
+    EXPECT_TRUE(boost::contains(db, R"("/DA=1", "/MP", "/DHAS_AVX2", "-march=native", "/std:c++20")")) << db;
+    EXPECT_FALSE(boost::contains(db, "-Wall")) << db;
+
+    fs::remove_all(dir);
+}
+
+TEST(compile_db, ConanDataFile)
+{
+    const auto file = fs::temp_directory_path() / "fmt-release-x86_64-data.cmake";
+    write(file, R"(
+set(fmt_PACKAGE_FOLDER_RELEASE "/conan/p/fmt/p")
+set(fmt_BUILD_MODULES_PATHS_RELEASE )
+set(fmt_INCLUDE_DIRS_RELEASE "${fmt_PACKAGE_FOLDER_RELEASE}/include" "${fmt_PACKAGE_FOLDER_RELEASE}/include/fmt")
+set(fmt_LIB_DIRS_RELEASE "${fmt_PACKAGE_FOLDER_RELEASE}/lib")
+)");
+
+    const auto dirs = dep_internals::parse_conan_data_file(file, "Release");
+    EXPECT_EQ(dirs, (std::vector<fs::path> { "/conan/p/fmt/p/include", "/conan/p/fmt/p/include/fmt" }));
+    EXPECT_TRUE(dep_internals::parse_conan_data_file(file, "Debug").empty());
+
+    fs::remove(file);
+}
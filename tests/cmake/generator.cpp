@@ -4,6 +4,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <gtest/gtest.h>
 
+#include "cppship/cmake/lib.h"
 #include "cppship/core/manifest.h"
 #include "cppship/util/fs.h"
 #include "cppship/util/io.h"
@@ -63,9 +64,128 @@ linkflags = ["-lz"]
     )");
     CmakeGenerator gen(&layout, meta.get_if_package(), {});
     const auto content = std::move(gen).build();
-    EXPECT_TRUE(boost::contains(content, "add_compile_options(-Wall)"));
-    EXPECT_TRUE(boost::contains(content, "add_link_options(-lpthread>)"));
-    EXPECT_TRUE(boost::contains(content, "add_compile_options($<$<CONFIG:Debug>:-Wextra>)"));
-    EXPECT_TRUE(boost::contains(content, "add_link_options($<$<CONFIG:Debug>:-lz>)"));
+    EXPECT_TRUE(boost::contains(content, "add_library(abc-abc-abc_profile INTERFACE)"));
+    EXPECT_TRUE(boost::contains(content, "target_compile_options(abc-abc-abc_profile INTERFACE -Wall)"));
+    EXPECT_TRUE(boost::contains(content, "target_link_options(abc-abc-abc_profile INTERFACE -lpthread)"));
+    EXPECT_TRUE(
+        boost::contains(content, "target_compile_options(abc-abc-abc_profile INTERFACE $<$<CONFIG:Debug>:-Wextra>)"));
+    EXPECT_TRUE(boost::contains(content, "target_link_options(abc-abc-abc_profile INTERFACE $<$<CONFIG:Debug>:-lz>)"));
     EXPECT_TRUE(boost::contains(content, "target_compile_definitions(tmp_bin PRIVATE ABC_ABC_ABC_VERSION="));
+    EXPECT_TRUE(boost::contains(content, "target_link_libraries(tmp_bin PRIVATE abc-abc-abc_profile)"));
+    EXPECT_FALSE(boost::contains(content, "add_compile_options(")) << content;
+    EXPECT_FALSE(boost::contains(content, "add_link_options(")) << content;
+}
+
+TEST(generator, CustomProfile)
+{
+    const auto dir = fs::temp_directory_path();
+    create_if_not_exist(dir / kSrcPath);
+    write(dir / kSrcPath / "main.cpp", "");
+
+    Layout layout(dir, "tmp");
+    auto meta = mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[profile.release]
+cxxflags = ["-O2"]
+
+[profile.fast]
+inherits = "profiling"
+cxxflags = ["-ffast-math"]
+    )");
+    CmakeGenerator gen(&layout, meta.get_if_package(), {});
+    const auto content = std::move(gen).build();
+    EXPECT_TRUE(boost::contains(content, "target_compile_options(abc_profile INTERFACE $<$<CONFIG:Release>:-O2>)"));
+    EXPECT_TRUE(boost::contains(content,
+        "if(CPPSHIP_PROFILE STREQUAL \"fast\")\n"
+        "\tif(NOT (CMAKE_CXX_COMPILER_ID STREQUAL \"MSVC\"))\n"
+        "\t\ttarget_compile_options(abc_profile INTERFACE -g)\n"
+        "\t\ttarget_compile_options(abc_profile INTERFACE -fno-omit-frame-pointer)\n"
+        "\tendif()\n"))
+        << content;
+    EXPECT_TRUE(boost::contains(content, "\ttarget_compile_options(abc_profile INTERFACE -ffast-math)\nendif()"));
+    EXPECT_TRUE(boost::contains(content, R"(if(CPPSHIP_PROFILE STREQUAL "bench"))"));
+}
+
+TEST(generator, GitDepProfile)
+{
+    const auto dir = fs::temp_directory_path();
+    create_if_not_exist(dir / kSrcPath);
+    write(dir / kSrcPath / "main.cpp", "");
+
+    Layout layout(dir, "tmp");
+    auto meta = mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[dependencies]
+d0 = { git = "https://example.com/d0.git", commit = "c0" }
+
+[profile]
+definitions = ["ABC_CHECKED"]
+
+[profile.debug]
+asan = true
+    )");
+    CmakeGenerator gen(&layout,
+        meta.get_if_package(),
+        {
+            .deps = { { .cmake_package = "d0", .cmake_targets = { "cppship::d0" } } },
+        });
+    const auto content = std::move(gen).build();
+
+    // libs of git deps built from source link cppship_deps_profile, see package_configurer
+    EXPECT_TRUE(boost::contains(
+        content, "if(NOT TARGET cppship_deps_profile)\n\tadd_library(cppship_deps_profile INTERFACE)\nendif()"))
+        << content;
+    EXPECT_TRUE(boost::contains(content, "target_compile_definitions(cppship_deps_profile INTERFACE ABC_CHECKED)"))
+        << content;
+    EXPECT_TRUE(boost::contains(
+        content, "target_compile_options(cppship_deps_profile INTERFACE $<$<CONFIG:Debug>:-fsanitize=address>)"))
+        << content;
+    EXPECT_TRUE(boost::contains(content, "target_compile_definitions(abc_profile INTERFACE ABC_CHECKED)")) << content;
+    EXPECT_TRUE(boost::contains(content, "target_link_libraries(tmp_bin PRIVATE cppship::d0)")) << content;
+    // not linked by the package, its own flags come from abc_profile
+    EXPECT_FALSE(boost::contains(content, "PRIVATE cppship_deps_profile")) << content;
+}
+
+TEST(generator, MultiversionProfileMarch)
+{
+    const auto dir = fs::temp_directory_path() / "cppship.generator.isa";
+    fs::remove_all(dir);
+    fs::create_directories(dir / kLibPath / "simd");
+    write(dir / kLibPath / "a.cpp", "");
+    write(dir / kLibPath / "simd" / "dot.cpp", "");
+
+    Layout layout(dir, "abc");
+    auto meta = mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[lib]
+multiversion = ["lib/simd"]
+
+[profile.release]
+cxxflags = ["-march=native"]
+    )");
+    CmakeGenerator gen(&layout, meta.get_if_package(), {});
+    const auto content = std::move(gen).build();
+    fs::remove_all(dir);
+
+    // the lib is built for the profile -march, its variants only for their own
+    EXPECT_TRUE(
+        boost::contains(content, "target_compile_options(abc_profile INTERFACE $<$<CONFIG:Release>:-march=native>)"))
+        << content;
+    EXPECT_TRUE(boost::contains(content, "target_link_libraries(abc_lib PRIVATE abc_profile)")) << content;
+    for (const auto& level : kIsaLevels) {
+        const auto variant = fmt::format("abc_lib_isa_{}", level.suffix);
+        EXPECT_TRUE(boost::contains(content,
+            fmt::format("target_compile_options({} PRIVATE $<FILTER:$<TARGET_PROPERTY:abc_profile,"
+                        "INTERFACE_COMPILE_OPTIONS>,EXCLUDE,^(-march=|/arch:)>)",
+                variant)))
+            << content;
+        EXPECT_FALSE(boost::contains(content, fmt::format("target_link_libraries({} PRIVATE abc_profile)", variant)))
+            << content;
+    }
 }
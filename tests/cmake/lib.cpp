@@ -3,6 +3,7 @@
 #include "cppship/util/repo.h"
 
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <gtest/gtest.h>
 
 using namespace cppship;
@@ -19,6 +20,7 @@ TEST(lib, Interface)
         .include_dirs = { libdir },
         .deps = { { .cmake_package = "pkg", .cmake_targets = { "pkg1", "pkg2" } } },
         .definitions = { "A", "B" },
+        .profile_target = "test_profile",
     });
 
     std::ostringstream oss;
@@ -121,4 +123,83 @@ target_link_libraries(test_lib PUBLIC pkg1 pkg2)
 target_compile_definitions(test_lib PUBLIC A B)
 )",
             file_a.generic_string(), file_b.generic_string(), incdir.generic_string()));
-}
\ No newline at end of file
+}
+TEST(lib, Imported)
+{
+    const auto dir = fs::temp_directory_path();
+    const auto libdir = dir / kIncludePath;
+    fs::create_directory(libdir);
+
+    CmakeLib lib({
+        .name = "test",
+        .include_dirs = { libdir },
+        .deps = { { .cmake_package = "pkg", .cmake_targets = { "pkg1" } } },
+        .imported_archive = dir / "libtest_lib.a",
+    });
+
+    std::ostringstream oss;
+    lib.build(oss);
+
+    EXPECT_FALSE(lib.is_interface());
+    EXPECT_TRUE(lib.is_imported());
+    EXPECT_EQ(oss.str(),
+        fmt::format(R"(
+# LIB
+add_library(test_lib STATIC IMPORTED GLOBAL)
+set_target_properties(test_lib PROPERTIES IMPORTED_LOCATION "{}")
+
+target_include_directories(test_lib INTERFACE {})
+
+target_link_libraries(test_lib INTERFACE pkg1)
+)",
+            (dir / "libtest_lib.a").generic_string(),
+            libdir.generic_string()));
+}
+
+TEST(lib, Multiversion)
+{
+    const auto dir = fs::temp_directory_path();
+    const auto incdir = dir / kIncludePath;
+    const auto file_a = dir / kLibPath / "a.cpp";
+    const auto file_simd = dir / kLibPath / "simd" / "dot.cpp";
+
+    CmakeLib lib({
+        .name = "test-simd",
+        .include_dirs = { incdir },
+        .sources = { file_a, file_simd },
+        .deps = { { .cmake_package = "pkg", .cmake_targets = { "pkg1" } } },
+        .profile_target = "test-simd_profile",
+        .multiversion_sources = { file_simd },
+    });
+
+    std::ostringstream oss;
+    lib.build(oss);
+    const auto content = oss.str();
+
+    const auto lib_sources = fmt::format("${{CMAKE_BINARY_DIR}}/isa/test_simd_isa.cpp\n{}", file_a.generic_string());
+    EXPECT_TRUE(boost::contains(content, fmt::format("add_library(test-simd_lib {})\n", lib_sources))) << content;
+    EXPECT_TRUE(boost::contains(content, "#define TEST_SIMD_ISA_DISPATCH(fn) ::test_simd_isa::select(")) << content;
+    EXPECT_TRUE(boost::contains(content, "int test_simd_isa::level() noexcept")) << content;
+    EXPECT_TRUE(boost::contains(content, "target_include_directories(test-simd_lib PUBLIC ${CMAKE_BINARY_DIR}/isa)"))
+        << content;
+    EXPECT_TRUE(boost::contains(content, "target_link_libraries(test-simd_lib PRIVATE test-simd_profile)")) << content;
+
+    for (const auto& level : kIsaLevels) {
+        const auto variant = fmt::format("test-simd_lib_isa_{}", level.suffix);
+        const auto sources = fmt::format("add_library({} OBJECT {})", variant, file_simd.generic_string());
+        const auto definitions = fmt::format(
+            "target_compile_definitions({} PRIVATE CPPSHIP_ISA_NS=test_simd_isa_{}", variant, level.suffix);
+        const auto objects = fmt::format("target_sources(test-simd_lib PRIVATE $<TARGET_OBJECTS:{}>)", variant);
+
+        EXPECT_TRUE(boost::contains(content, sources)) << content;
+        EXPECT_TRUE(boost::contains(content, definitions)) << content;
+        EXPECT_TRUE(boost::contains(content, fmt::format("-march={}>", level.march))) << content;
+        EXPECT_TRUE(boost::contains(content, objects)) << content;
+        const auto profile = fmt::format("target_compile_options({} PRIVATE $<FILTER:$<TARGET_PROPERTY:"
+                                         "test-simd_profile,INTERFACE_COMPILE_OPTIONS>,EXCLUDE,^(-march=|/arch:)>)",
+            variant);
+        EXPECT_TRUE(boost::contains(content, profile)) << content;
+        const auto linked = fmt::format("target_link_libraries({} PRIVATE test-simd_profile)", variant);
+        EXPECT_FALSE(boost::contains(content, linked)) << content;
+    }
+}
@@ -164,7 +164,99 @@ ${CMAKE_BINARY_DIR}/deps/test_pack/lib/b.cpp)
 target_include_directories(test_pack_lib PUBLIC ${CMAKE_BINARY_DIR}/deps/test_pack/include)
 
 target_link_libraries(test_pack_lib PUBLIC fmt::fmt)
+target_link_libraries(test_pack_lib PRIVATE cppship_deps_profile)
 
 add_library(cppship::test_pack ALIAS test_pack_lib)
 )");
 }
+
+TEST(package_configurer, Prebuilt)
+{
+    const auto package = "test_pack"s;
+    const auto tmpdir = fs::temp_directory_path();
+    const auto deps_dir = tmpdir / "deps";
+    const auto cache_dir = tmpdir / "cppship.prebuilt.test";
+    const auto package_dir = deps_dir / package;
+    fs::remove_all(deps_dir);
+    fs::remove_all(cache_dir);
+
+    fs::create_directories(package_dir / kLibPath);
+    write(package_dir / kRepoConfigFile, R"([package]
+name = "test_pack"
+version = "0.1.0"
+
+[dependencies]
+fmt = "9.1.0"
+)");
+    touch(package_dir / kLibPath / "a.cpp");
+
+    cppship::ResolvedDependencies deps { {
+        Dependency {
+            .package = package,
+            .cmake_package = package,
+            .cmake_target = fmt::format("cppship::{}", package),
+        },
+    } };
+    cppship::ResolvedDependencies all_deps = deps;
+    all_deps.insert(Dependency {
+        .package = "fmt",
+        .cmake_package = "fmt",
+        .cmake_target = "fmt::fmt",
+    });
+
+    cmake::PrebuiltOptions prebuilt {
+        .cache_dir = cache_dir,
+        .toolchain = "gcc-12",
+        .locked = { { package, "git@abc" }, { "fmt", "9.1.0" } },
+    };
+    const auto package_config_file = deps_dir / fmt::format("{}-config.cmake", package);
+    cmake::ConfigResult result;
+    auto config = [&] {
+        result = cmake::config_packages(deps, all_deps, { .deps_dir = deps_dir, .prebuilt = prebuilt });
+        return read_as_string(package_config_file);
+    };
+
+    // miss, built from sources and exported to cache
+    const auto miss = config();
+    EXPECT_EQ(result.prebuilt_hits, 0);
+    ASSERT_EQ(result.missed_archives.size(), 1);
+    EXPECT_NE(miss.find("a.cpp"), std::string::npos);
+    EXPECT_NE(miss.find("POST_BUILD"), std::string::npos);
+
+    const auto archive_prefix = (cache_dir / package).generic_string() + "/";
+    const auto pos = miss.find(archive_prefix);
+    ASSERT_NE(pos, std::string::npos);
+    const auto key = miss.substr(pos + archive_prefix.size(), 16);
+    const auto archive = cache_dir / package / key / cmake::package_internals::prebuilt_archive_name("test_pack_lib");
+    fs::create_directories(archive.parent_path());
+    touch(archive);
+
+    // hit, import the archive
+    const auto hit = config();
+    EXPECT_EQ(result.prebuilt_hits, 1);
+    EXPECT_TRUE(result.missed_archives.empty());
+    EXPECT_EQ(hit.find("a.cpp"), std::string::npos);
+    EXPECT_NE(hit.find("STATIC IMPORTED"), std::string::npos);
+    EXPECT_NE(hit.find("target_link_libraries(test_pack_lib INTERFACE fmt::fmt)"), std::string::npos);
+
+    // the build links a copy in the build dir, which outlives a clean of the cache
+    EXPECT_EQ(hit.find(archive.generic_string()), std::string::npos);
+    const auto imported = deps_dir / "prebuilt" / package / archive.filename();
+    EXPECT_NE(hit.find(imported.generic_string()), std::string::npos);
+    fs::remove(archive);
+    EXPECT_TRUE(fs::exists(imported));
+
+    // any change of the key misses
+    prebuilt.locked["fmt"] = "10.0.0";
+    EXPECT_EQ(config().find("STATIC IMPORTED"), std::string::npos);
+
+    prebuilt.locked["fmt"] = "9.1.0";
+    prebuilt.toolchain = "clang-16";
+    EXPECT_EQ(config().find("STATIC IMPORTED"), std::string::npos);
+
+    // unlocked deps are always built from sources
+    prebuilt.locked.erase("fmt");
+    EXPECT_EQ(config().find("POST_BUILD"), std::string::npos);
+
+    fs::remove_all(cache_dir);
+}
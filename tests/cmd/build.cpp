@@ -1,5 +1,13 @@
 #include "cppship/cmd/build.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "cppship/cmake/group.h"
@@ -203,4 +211,126 @@ name = "p3")");
     ASSERT_TRUE(util::contains(cmd, fmt::format("--target p2_{}", cmake::kCppshipGroupExamples)));
 }
 
+TEST(build, shared_context)
+{
+    DirTree tree({ "cppship.toml", "src/main.cpp" });
+    write(tree.root() / "cppship.toml", R"(
+[package]
+version = "1.0.0"
+name = "p1")");
+
+    cmd::BuildContext debug(Profile::debug);
+    cmd::BuildContext release(Profile::release, debug);
+
+    EXPECT_EQ(release.profile, kProfileRelease);
+    EXPECT_EQ(release.root, debug.root);
+    EXPECT_NE(release.profile_dir, debug.profile_dir);
+    EXPECT_NE(release.inventory_file, debug.inventory_file);
+    ASSERT_NE(release.manifest.get_if_package(), nullptr);
+    EXPECT_EQ(release.manifest.get_if_package()->name(), "p1");
+    EXPECT_EQ(release.get_active_package(), "p1");
+}
+
+TEST(build, memoized_results)
+{
+    DirTree tree({ "cppship.toml", "src/main.cpp" });
+    write(tree.root() / "cppship.toml", R"(
+[package]
+version = "1.0.0"
+name = "p1")");
+
+    cmd::BuildContext ctx(Profile::debug);
+    create_if_not_exist(ctx.profile_dir);
+    EXPECT_TRUE(ctx.inventory().is_table());
+    EXPECT_FALSE(ctx.inventory().contains("libs"));
+
+    toml::value inventory;
+    inventory["launcher"] = "distcc";
+    ctx.save_inventory(inventory);
+    EXPECT_EQ(toml::find<std::string>(toml::parse(ctx.inventory_file), "launcher"), "distcc");
+    EXPECT_EQ(toml::find<std::string>(ctx.inventory(), "launcher"), "distcc");
+
+    write(ctx.git_dep_file, "");
+    EXPECT_TRUE(ctx.git_dependencies().empty());
+    // loaded once per invocation
+    fs::remove(ctx.git_dep_file);
+    EXPECT_TRUE(ctx.git_dependencies().empty());
+
+    ctx.save_dependencies({});
+    EXPECT_TRUE(fs::exists(ctx.dependency_file));
+    fs::remove(ctx.dependency_file);
+    EXPECT_TRUE(ctx.dependencies().empty());
+}
+
+TEST(build, custom_profile)
+{
+    DirTree tree({ "cppship.toml", "src/main.cpp" });
+    write(tree.root() / "cppship.toml", R"(
+[package]
+version = "1.0.0"
+name = "p1"
+
+[profile.fast]
+inherits = "bench")");
+
+    cmd::BuildContext fast(Profile { "fast" });
+    EXPECT_EQ(fast.profile, "fast");
+    EXPECT_EQ(fast.build_type, kProfileRelease);
+    EXPECT_EQ(fast.profile_dir, fast.build_dir / "fast");
+    EXPECT_EQ(cmd::BuildContext(Profile::debug, fast).build_type, kProfileDebug);
+
+    EXPECT_THROW(cmd::BuildContext(Profile { "slow" }, fast), InvalidProfile);
+}
+
+TEST(build, build_profiles)
+{
+    DirTree tree({ "cppship.toml", "src/main.cpp" });
+    write(tree.root() / "cppship.toml", R"(
+[package]
+version = "1.0.0"
+name = "p1")");
+
+    std::vector<std::unique_ptr<cmd::BuildContext>> contexts;
+    contexts.push_back(std::make_unique<cmd::BuildContext>(Profile::debug));
+    contexts.push_back(std::make_unique<cmd::BuildContext>(Profile::release, *contexts.front()));
+    for (const auto& ctx : contexts) {
+        create_if_not_exist(ctx->profile_dir);
+    }
+    contexts.front()->save_dependencies({});
+
+    // each stage waits for the other profile, it only passes if profiles run concurrently
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<std::string, int> arrived;
+    std::vector<std::string> cmds;
+    util::CmdRunner runner([&](std::string_view cmd) {
+        std::unique_lock lock(mutex);
+        cmds.emplace_back(cmd);
+        const auto stage = cmd.starts_with("cmake --build") ? "build" : "setup";
+        ++arrived[stage];
+        cv.notify_all();
+        return cv.wait_for(lock, std::chrono::seconds(10), [&] { return arrived[stage] == 2; }) ? 0 : 1;
+    });
+
+    const cmd::BuildOptions options {
+        .max_concurrency = 9,
+        .profiles = { Profile::debug, Profile::release },
+    };
+    EXPECT_EQ(cmd::cmd_internals::build_profiles(contexts, options, runner), (std::vector { 0, 0 }));
+
+    ASSERT_EQ(cmds.size(), 4);
+    for (const auto& cmd : cmds) {
+        if (cmd.starts_with("cmake --build")) {
+            // profiles share the job budget
+            EXPECT_TRUE(util::contains(cmd, " -j 4 ")) << cmd;
+        }
+    }
+    for (const auto& ctx : contexts) {
+        EXPECT_TRUE(fs::exists(ctx->inventory_file));
+    }
+
+    // resolution is shared by profiles
+    EXPECT_EQ(&contexts.front()->dependency_graph(), &contexts.back()->dependency_graph());
+}
+
 }
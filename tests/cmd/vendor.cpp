@@ -0,0 +1,77 @@
+#include "cppship/cmd/vendor.h"
+
+#include <gtest/gtest.h>
+
+#include "cppship/exception.h"
+#include "cppship/util/io.h"
+
+using namespace cppship;
+using namespace cppship::cmd::vendor_internals;
+
+namespace {
+
+class TempDir {
+public:
+    TempDir() { fs::create_directories(mRoot); }
+
+    ~TempDir() { fs::remove_all(mRoot); }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const fs::path& path() const { return mRoot; }
+
+private:
+    fs::path mRoot = fs::temp_directory_path() / "cppship.vendor.test";
+};
+
+void put(const fs::path& file, std::string_view content)
+{
+    fs::create_directories(file.parent_path());
+    write(file, content);
+}
+
+}
+
+TEST(vendor, CopyTree)
+{
+    TempDir tmp;
+    const auto from = tmp.path() / "deps" / "a";
+    put(from / ".git" / "objects" / "info" / "alternates", "/mirror/objects\n");
+    put(from / "include" / "a.h", "a");
+    put(from / "lib" / "a.cpp", "a");
+    put(from / "cppship.abc", "");
+
+    const auto to = tmp.path() / "staging" / "a";
+    copy_tree(from, to);
+
+    EXPECT_FALSE(fs::exists(to / ".git"));
+    EXPECT_EQ(read_as_string(to / "include" / "a.h"), "a");
+    EXPECT_TRUE(fs::exists(to / "lib" / "a.cpp"));
+    EXPECT_TRUE(fs::exists(to / "cppship.abc"));
+}
+
+TEST(vendor, ArchivePath)
+{
+    EXPECT_EQ(archive_path("build", "abc"), fs::path { "build" } / "cppship-vendor-abc.tar.gz");
+    EXPECT_EQ(archive_path("build", "abc"), archive_path("build", "abc"));
+    EXPECT_NE(archive_path("build", "abc"), archive_path("build", "abd"));
+}
+
+TEST(vendor, PackAndUnpack)
+{
+    TempDir tmp;
+    const auto staging = tmp.path() / "staging";
+    put(staging / "deps" / "a" / "include" / "a.h", "a");
+
+    const auto archive = archive_path(tmp.path(), "abc");
+    pack(staging, "abc", archive);
+    ASSERT_TRUE(fs::exists(archive));
+
+    const auto restored = tmp.path() / "restored";
+    unpack(archive, "abc", restored);
+    EXPECT_EQ(read_as_string(restored / "deps" / "a" / "include" / "a.h"), "a");
+
+    // deps changed since the archive is created
+    EXPECT_THROW(unpack(archive, "abd", restored), Error);
+}
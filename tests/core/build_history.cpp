@@ -0,0 +1,125 @@
+#include "cppship/core/build_history.h"
+
+#include <gtest/gtest.h>
+
+#include "cppship/util/io.h"
+
+using namespace cppship;
+
+TEST(build_history, ParseNinjaLog)
+{
+    BuildRecord record;
+    history_internals::parse_ninja_log("# ninja log v5\n"
+                                       "0\t1200\t1\tCMakeFiles/p_lib.dir/lib/a.cpp.o\tabc\n"
+                                       "5\t805\t1\tCMakeFiles/p_bin.dir/src/main.cpp.obj\tdef\n"
+                                       "1200\t1500\t1\tlibp_lib.a\t123\n"
+                                       "broken line\n",
+        record);
+
+    ASSERT_EQ(record.units.size(), 2);
+    EXPECT_EQ(record.units[0].target, "p_lib");
+    EXPECT_EQ(record.units[0].source, "lib/a.cpp");
+    EXPECT_EQ(record.units[0].ms, 1200);
+    EXPECT_EQ(record.units[1].target, "p_bin");
+    EXPECT_EQ(record.units[1].source, "src/main.cpp");
+    EXPECT_EQ(record.units[1].ms, 800);
+
+    ASSERT_EQ(record.links.size(), 1);
+    EXPECT_EQ(record.links[0].output, "libp_lib.a");
+    EXPECT_EQ(record.links[0].ms, 300);
+}
+
+TEST(build_history, AppendAndLoad)
+{
+    const auto file = fs::temp_directory_path() / "cppship.history.toml";
+    fs::remove(file);
+    EXPECT_TRUE(load_build_history(file).empty());
+
+    BuildRecord record {
+        .time = 100,
+        .commit = "abc",
+        .profile = "debug",
+        .stages = { { .name = "cmake_setup", .ms = 10 }, { .name = "cmake_build", .ms = 90 } },
+        .prebuilt_hits = 2,
+        .prebuilt_misses = 1,
+        .units = { { .target = "p_lib", .source = "lib/\"quoted\".cpp", .ms = 50 } },
+    };
+    append_build_record(file, record);
+
+    record.time = 200;
+    record.result = 1;
+    record.units.clear();
+    record.links = { { .output = "p_bin", .ms = 20 } };
+    append_build_record(file, record);
+
+    const auto history = load_build_history(file);
+    ASSERT_EQ(history.size(), 2);
+    EXPECT_EQ(history[0].time, 100);
+    EXPECT_EQ(history[0].commit, "abc");
+    EXPECT_EQ(history[0].total_ms(), 100);
+    EXPECT_EQ(history[0].prebuilt_hits, 2);
+    ASSERT_EQ(history[0].units.size(), 1);
+    EXPECT_EQ(history[0].units[0].source, "lib/\"quoted\".cpp");
+    EXPECT_EQ(history[1].result, 1);
+    EXPECT_TRUE(history[1].units.empty());
+    ASSERT_EQ(history[1].links.size(), 1);
+    EXPECT_EQ(history[1].stages[1].name, "cmake_build");
+
+    fs::remove(file);
+}
+
+TEST(build_history, FindRegressions)
+{
+    const auto build = [](std::int64_t time, std::int64_t a_ms, std::int64_t b_ms) {
+        return BuildRecord {
+            .time = time,
+            .units = {
+                { .target = "p_lib", .source = "lib/a.cpp", .ms = a_ms },
+                { .target = "p_lib", .source = "lib/b.cpp", .ms = b_ms },
+            },
+        };
+    };
+
+    const std::vector<BuildRecord> history {
+        build(1, 100, 1000),
+        build(2, 100, 1000),
+        build(3, 300, 1005),
+        build(4, 300, 1005),
+    };
+
+    const auto regressions = find_regressions(history, 3);
+    ASSERT_EQ(regressions.units.size(), 1);
+    EXPECT_EQ(regressions.units[0].name, "lib/a.cpp (p_lib)");
+    EXPECT_EQ(regressions.units[0].before_ms, 100);
+    EXPECT_EQ(regressions.units[0].after_ms, 300);
+
+    // 1100ms to 1305ms
+    ASSERT_EQ(regressions.targets.size(), 1);
+    EXPECT_EQ(regressions.targets[0].name, "p_lib");
+
+    EXPECT_TRUE(find_regressions(history, 0).units.empty());
+}
+
+TEST(build_history, FindRegressionsSinceCommit)
+{
+    const auto build = [](std::int64_t time, std::string commit, std::int64_t ms) {
+        return BuildRecord {
+            .time = time,
+            .commit = std::move(commit),
+            .units = { { .target = "p_lib", .source = "lib/a.cpp", .ms = ms } },
+        };
+    };
+
+    // a branch with the commit built before one without it
+    const std::vector<BuildRecord> history {
+        build(1, "c1", 300),
+        build(2, "c0", 100),
+        build(3, "c1", 300),
+        build(4, "c0", 100),
+    };
+
+    const auto regressions = find_regressions(history, [](const BuildRecord& record) { return record.commit == "c1"; });
+    ASSERT_EQ(regressions.units.size(), 1);
+    EXPECT_EQ(regressions.units[0].before_ms, 100);
+    EXPECT_EQ(regressions.units[0].after_ms, 300);
+}
@@ -33,6 +33,37 @@ TEST(cfg, basic)
     expect_cfg(R"(cfg(any(compiler="msvc", os = "linux")))", CfgAny { { cfg::Compiler::msvc, cfg::Os::linux } });
 }
 
+TEST(cfg, Target)
+{
+    expect_cfg(R"(cfg(target_arch = "x86_64"))", cfg::Arch::x86_64);
+    expect_cfg(R"(cfg(target_arch = "aarch64"))", cfg::Arch::aarch64);
+    expect_cfg(R"(cfg(target_feature = "sse4.2"))", cfg::Feature::sse4_2);
+    expect_cfg(R"(cfg(target_feature = "avx512f"))", cfg::Feature::avx512f);
+    expect_cfg(R"(cfg(all(target_arch = "aarch64", target_feature = "neon")))",
+        CfgAll { { cfg::Arch::aarch64, cfg::Feature::neon } });
+
+    expect_parse_error(R"(cfg(target_arch = "riscv"))", "<target_arch>");
+    expect_parse_error(R"(cfg(target_feature = "avx3"))", "<target_feature>");
+}
+
+TEST(cfg, Eval)
+{
+    const cfg::Platform platform {
+        .os = cfg::Os::linux,
+        .compiler = cfg::Compiler::gcc,
+        .arch = cfg::Arch::x86_64,
+        .features = { cfg::Feature::sse4_2, cfg::Feature::avx2 },
+    };
+
+    EXPECT_TRUE(eval_cfg(parse_cfg(R"(cfg(not(compiler = "msvc")))"), platform));
+    EXPECT_TRUE(eval_cfg(parse_cfg(R"(cfg(all(os = "linux", target_feature = "avx2")))"), platform));
+    EXPECT_FALSE(eval_cfg(parse_cfg(R"(cfg(target_feature = "avx512f"))"), platform));
+    EXPECT_FALSE(eval_cfg(parse_cfg(R"(cfg(any(target_arch = "aarch64", compiler = "clang")))"), platform));
+
+    EXPECT_TRUE(uses_target_features(parse_cfg(R"(cfg(not(target_feature = "avx2")))")));
+    EXPECT_FALSE(uses_target_features(parse_cfg(R"(cfg(target_arch = "x86_64"))")));
+}
+
 TEST(cfg, error)
 {
     expect_parse_error(R"(compiler = "msvc")", "cfg");
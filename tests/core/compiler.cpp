@@ -24,4 +24,14 @@ TEST(compiler, detect)
     ASSERT_NE(info.libcxx(), "");
     ASSERT_NE(info.version(), 0);
 }
-#endif
\ No newline at end of file
+#endif
+#ifndef _WINDOWS
+TEST(compiler, fingerprint)
+{
+    const CompilerInfo info;
+    const CompilerInfo same(std::string { info.command() });
+
+    ASSERT_FALSE(info.fingerprint().empty());
+    ASSERT_EQ(info.fingerprint(), same.fingerprint());
+}
+#endif
@@ -0,0 +1,110 @@
+#include "cppship/core/dependency_graph.h"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "cppship/util/io.h"
+#include "cppship/util/repo.h"
+
+using namespace cppship;
+
+namespace {
+
+// p1 and p2 depend on d0, d0 on d1 and fmt, d1 is header only. all of them fetched already
+fs::path make_workspace()
+{
+    const auto root = fs::temp_directory_path() / "cppship.dependency_graph";
+    const auto deps_dir = root / "deps";
+    fs::remove_all(root);
+    create_if_not_exist(deps_dir / "d0");
+    create_if_not_exist(deps_dir / "d1" / kIncludePath);
+    touch(deps_dir / "d0" / "cppship.c0");
+    touch(deps_dir / "d1" / "cppship.c1");
+
+    write(deps_dir / "d0" / kRepoConfigFile, R"([package]
+name = "d0"
+version = "0.1.0"
+
+[dependencies]
+d1 = { git = "https://example.com/d1.git", commit = "c1" }
+fmt = "10.0.0"
+)");
+
+    write(root / kRepoConfigFile, R"([workspace]
+members = ["p1", "p2"]
+)");
+    for (const std::string_view package : { "p1", "p2" }) {
+        write(root / package / kRepoConfigFile, fmt::format(R"([package]
+name = "{}"
+version = "0.1.0"
+
+[dependencies]
+d0 = {{ git = "https://example.com/d0.git", commit = "c0" }}
+)",
+                                                    package));
+    }
+
+    return root;
+}
+
+}
+
+TEST(dependency_graph, Resolve)
+{
+    const auto root = make_workspace();
+    const Manifest manifest { root / kRepoConfigFile };
+    DependencyGraph graph(root / "deps");
+
+    const auto& result = graph.resolve(*manifest.get("p1"));
+    ASSERT_EQ(result.dependencies.size(), 3);
+    EXPECT_EQ(result.dependencies[0].package, "fmt");
+    EXPECT_EQ(result.dependencies[1].package, "d1");
+    EXPECT_EQ(result.dependencies[2].package, "d0");
+    EXPECT_EQ(result.resolved_dependencies.get_or_die("d1").cmake_target, "cppship::d1");
+    EXPECT_EQ(graph.resolve(*manifest.get("p2")).dependencies.size(), 3);
+
+    // memoized by package
+    EXPECT_EQ(&graph.resolve(*manifest.get("p1")), &result);
+
+    fs::remove_all(root);
+}
+
+TEST(dependency_graph, ManifestsLoadedOnce)
+{
+    const auto root = make_workspace();
+    const Manifest manifest { root / kRepoConfigFile };
+    DependencyGraph graph(root / "deps");
+
+    const auto& d0 = manifest.get("p1")->dependencies().front();
+    const auto* d0_manifest = graph.manifest(d0);
+    ASSERT_NE(d0_manifest, nullptr);
+    EXPECT_EQ(d0_manifest->dependencies().size(), 2);
+
+    const auto& d1 = d0_manifest->dependencies().front();
+    EXPECT_EQ(graph.manifest(d1), nullptr);
+
+    // the manifest of p2's d0 comes from the cache
+    fs::remove(root / "deps" / "d0" / kRepoConfigFile);
+    EXPECT_EQ(graph.manifest(manifest.get("p2")->dependencies().front()), d0_manifest);
+    EXPECT_EQ(graph.resolve(*manifest.get("p2")).dependencies.size(), 3);
+
+    fs::remove_all(root);
+}
+
+TEST(dependency_graph, FootprintsUntouched)
+{
+    const auto root = make_workspace();
+    const Manifest manifest { root / kRepoConfigFile };
+    const auto footprint = root / "deps" / "d0" / "cppship.c0";
+    const auto before = fs::last_write_time(footprint) - std::chrono::seconds(10);
+    fs::last_write_time(footprint, before);
+
+    DependencyGraph graph(root / "deps");
+    graph.resolve(*manifest.get("p1"));
+    EXPECT_EQ(fs::last_write_time(footprint), before);
+
+    fs::remove_all(root);
+}
@@ -0,0 +1,218 @@
+#include "cppship/core/dist.h"
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+
+#include "cppship/core/compiler.h"
+#include "cppship/exception.h"
+#include "cppship/util/http.h"
+#include "cppship/util/io.h"
+
+using namespace cppship;
+using namespace cppship::dist;
+using namespace cppship::dist::dist_internals;
+
+TEST(dist, ParseWorkers)
+{
+    const auto workers = parse_workers("a:1, b ,c:3");
+    ASSERT_EQ(workers.size(), 3);
+    EXPECT_EQ(workers[0].host, "a");
+    EXPECT_EQ(workers[0].port, "1");
+    EXPECT_EQ(workers[1].host, "b");
+    EXPECT_EQ(workers[1].port, "3633");
+    EXPECT_EQ(workers[2].host, "c");
+    EXPECT_EQ(workers[2].port, "3");
+
+    EXPECT_TRUE(parse_workers("").empty());
+    EXPECT_THROW(parse_workers(":1"), Error);
+    EXPECT_THROW(parse_workers("a:"), Error);
+}
+
+TEST(dist, UserConfig)
+{
+    const auto config = fs::temp_directory_path() / "cppship.dist.config.toml";
+    write(config, "[dist]\nworkers = [\"a:1\", \"b\"]\ntoken = \"secret\"\n");
+
+    // NOLINTBEGIN(concurrency-mt-unsafe)
+    ::setenv("CPPSHIP_CONFIG", config.c_str(), 1);
+    auto workers = get_workers();
+    ASSERT_EQ(workers.size(), 2);
+    EXPECT_EQ(workers[0].host, "a");
+    EXPECT_EQ(workers[1].port, "3633");
+    EXPECT_EQ(get_token(), "secret");
+
+    // the environment overrides the config
+    ::setenv("CPPSHIP_DIST_WORKERS", "c:2", 1);
+    ::setenv("CPPSHIP_DIST_TOKEN", "other", 1);
+    workers = get_workers();
+    ASSERT_EQ(workers.size(), 1);
+    EXPECT_EQ(workers[0].host, "c");
+    EXPECT_EQ(get_token(), "other");
+
+    ::unsetenv("CPPSHIP_DIST_WORKERS");
+    ::unsetenv("CPPSHIP_DIST_TOKEN");
+    ::unsetenv("CPPSHIP_CONFIG");
+    // NOLINTEND(concurrency-mt-unsafe)
+    fs::remove(config);
+}
+
+TEST(dist, ParseCompileArgs)
+{
+    const auto job = parse_compile_args({ "-DNDEBUG", "-I", "include", "-isystem/usr/inc", "-O2", "-std=c++20", "-MD",
+        "-MT", "a.o", "-MF", "a.o.d", "-o", "a.o", "-c", "src/a.cpp" });
+    ASSERT_TRUE(job);
+    EXPECT_EQ(job->source, "src/a.cpp");
+    EXPECT_EQ(job->output, "a.o");
+    EXPECT_EQ(job->preprocess_args,
+        (std::vector<std::string> {
+            "-DNDEBUG",
+            "-I",
+            "include",
+            "-isystem/usr/inc",
+            "-O2",
+            "-std=c++20",
+            "-MD",
+            "-MT",
+            "a.o",
+            "-MF",
+            "a.o.d",
+        }));
+    EXPECT_EQ(job->compile_args, (std::vector<std::string> { "-O2", "-std=c++20" }));
+
+    // not a single compilation
+    EXPECT_FALSE(parse_compile_args({ "-o", "a", "a.cpp" }));
+    EXPECT_FALSE(parse_compile_args({ "-c", "a.cpp" }));
+    EXPECT_FALSE(parse_compile_args({ "-c", "a.cpp", "b.cpp", "-o", "a.o" }));
+    EXPECT_FALSE(parse_compile_args({ "-c", "a.o", "-o", "b.o" }));
+    EXPECT_FALSE(parse_compile_args({ "-E", "-c", "a.cpp", "-o", "a.o" }));
+    EXPECT_FALSE(parse_compile_args({ "@args.rsp", "-c", "a.cpp", "-o", "a.o" }));
+
+    // depending on the local machine
+    EXPECT_FALSE(parse_compile_args({ "-march=native", "-c", "a.cpp", "-o", "a.o" }));
+    EXPECT_FALSE(parse_compile_args({ "-fprofile-use=a.profdata", "-c", "a.cpp", "-o", "a.o" }));
+
+    // rejected by workers
+    EXPECT_FALSE(parse_compile_args({ "-Wa,-adhln", "-c", "a.cpp", "-o", "a.o" }));
+    EXPECT_FALSE(parse_compile_args({ "--coverage", "-c", "a.cpp", "-o", "a.o" }));
+}
+
+TEST(dist, IsSafeCompileArgs)
+{
+    EXPECT_TRUE(is_safe_compile_args({ "-O2", "-g", "-std=c++20" }));
+    EXPECT_TRUE(is_safe_compile_args({ "-Ofast", "-ggdb3", "-gdwarf-4", "-pthread", "-pedantic-errors", "-w" }));
+    EXPECT_TRUE(is_safe_compile_args({ "-Wall", "-Wextra", "-Werror=return-type", "-Wno-unused" }));
+    EXPECT_TRUE(is_safe_compile_args({ "-fPIC", "-fno-exceptions", "-fsanitize=address,undefined", "-flto=thin" }));
+    EXPECT_TRUE(is_safe_compile_args({ "-march=x86-64-v3", "-mavx2", "-target", "x86_64-linux-gnu" }));
+
+    EXPECT_FALSE(is_safe_compile_args({ "-o", "/etc/passwd" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-o/etc/passwd" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-fplugin=evil.so" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-B/tmp" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-Xclang", "-load" }));
+    EXPECT_FALSE(is_safe_compile_args({ "@args" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-target" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-target", "../x" }));
+
+    // arbitrary file writes
+    EXPECT_FALSE(is_safe_compile_args({ "-Wa,-a=/tmp/listing" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-Xassembler", "-a=/tmp/listing" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-dumpdir", "/tmp", "-fdump-tree-all" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-fdump-tree-all" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-save-temps=obj" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-foptimization-record-file=/tmp/x" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-mllvm", "-info-output-file=/tmp/x" }));
+
+    // loading files or code
+    EXPECT_FALSE(is_safe_compile_args({ "--specs=/tmp/evil.specs" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-fpass-plugin=evil.so" }));
+    EXPECT_FALSE(is_safe_compile_args({ "-Wl,-x" }));
+}
+
+TEST(dist, Pack)
+{
+    const std::vector<std::string> parts { "", "a", std::string("b\0c", 3), std::string(300, 'x') };
+    EXPECT_EQ(unpack(pack(parts)), parts);
+    EXPECT_TRUE(unpack("").empty());
+
+    const auto data = pack({ "abc" });
+    EXPECT_THROW(unpack(data.substr(0, 4)), Error);
+    EXPECT_THROW(unpack(data.substr(0, 10)), Error);
+}
+
+namespace {
+
+class LocalWorker {
+public:
+    explicit LocalWorker(std::string token = "")
+        : mServer(std::string { compiler::CompilerInfo {}.command() }, "127.0.0.1", 0, 2, std::move(token))
+        , mThread([this] { mServer.run(); })
+    {
+    }
+
+    ~LocalWorker()
+    {
+        mServer.stop();
+        mThread.join();
+    }
+
+    LocalWorker(const LocalWorker&) = delete;
+    LocalWorker& operator=(const LocalWorker&) = delete;
+
+    std::string spec() const { return fmt::format("127.0.0.1:{}", mServer.port()); }
+
+    std::string port() const { return std::to_string(mServer.port()); }
+
+private:
+    WorkerServer mServer;
+    std::thread mThread;
+};
+
+}
+
+TEST(dist, Token)
+{
+    const std::string compiler { compiler::CompilerInfo {}.command() };
+    EXPECT_THROW(WorkerServer(compiler, "0.0.0.0", 0, 1, ""), Error);
+
+    LocalWorker worker("secret");
+    EXPECT_EQ(util::http_request("127.0.0.1", worker.port(), { .target = "/status" }).status, util::kHttpUnauthorized);
+    EXPECT_EQ(util::http_request("127.0.0.1", worker.port(), { .target = "/status", .token = "guess" }).status,
+        util::kHttpUnauthorized);
+    EXPECT_TRUE(util::http_request("127.0.0.1", worker.port(), { .target = "/status", .token = "secret" }).ok());
+}
+
+TEST(dist, Compile)
+{
+    LocalWorker worker("secret");
+
+    const auto tmpdir = fs::temp_directory_path() / "cppship.dist.test";
+    fs::remove_all(tmpdir);
+    fs::create_directories(tmpdir);
+    write(tmpdir / "a.cpp", "#define ANSWER 42\nint answer() { return ANSWER; }\n");
+    write(tmpdir / "bad.cpp", "int answer() { return }\n");
+
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    ::setenv("CPPSHIP_DIST_WORKERS", worker.spec().c_str(), 1);
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    ::setenv("CPPSHIP_DIST_TOKEN", "secret", 1);
+    const std::string compiler { compiler::CompilerInfo {}.command() };
+    const auto obj = tmpdir / "a.o";
+    EXPECT_EQ(compile({ compiler, "-O2", "-c", (tmpdir / "a.cpp").string(), "-o", obj.string() }), 0);
+    EXPECT_TRUE(fs::exists(obj));
+    EXPECT_FALSE(fs::exists(tmpdir / "a.o.cppship.ii"));
+
+    EXPECT_NE(compile({ compiler, "-c", (tmpdir / "bad.cpp").string(), "-o", (tmpdir / "bad.o").string() }), 0);
+    EXPECT_FALSE(fs::exists(tmpdir / "bad.o"));
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    ::unsetenv("CPPSHIP_DIST_WORKERS");
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    ::unsetenv("CPPSHIP_DIST_TOKEN");
+
+    fs::remove_all(tmpdir);
+}
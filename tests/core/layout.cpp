@@ -5,6 +5,7 @@
 #include <fstream>
 #include <gtest/gtest.h>
 #include <set>
+#include <sstream>
 #include <string>
 
 #include <range/v3/range/conversion.hpp>
@@ -498,4 +499,57 @@ TEST(layout, full)
     EXPECT_TRUE(layout.test("d"));
     EXPECT_TRUE(layout.test("e"));
     EXPECT_TRUE(layout.test("sub_f"));
-}
\ No newline at end of file
+}
+
+TEST(layout, save_load)
+{
+    DirTree tree({
+        "include/",
+        "lib/a.cpp",
+        "lib/a_test.cpp",
+        "src/main.cpp",
+        "src/bin/b.cpp",
+        "tests/c.cpp",
+        "examples/d.cpp",
+        "benches/e.cpp",
+    });
+
+    const Layout layout(tree.root(), kApp);
+    std::stringstream ss;
+    layout.save(ss);
+
+    const auto loaded = Layout::load(ss);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->root(), layout.root());
+    EXPECT_EQ(loaded->package(), layout.package());
+    EXPECT_EQ(loaded->all_files(), layout.all_files());
+    ASSERT_TRUE(loaded->lib());
+    EXPECT_EQ(loaded->lib()->includes, layout.lib()->includes);
+    EXPECT_EQ(loaded->lib()->sources, layout.lib()->sources);
+    EXPECT_EQ(loaded->binaries().size(), 2);
+    EXPECT_EQ(loaded->binary("b")->sources, layout.binary("b")->sources);
+    EXPECT_EQ(loaded->binary(kApp)->includes, layout.binary(kApp)->includes);
+    EXPECT_EQ(loaded->test("a")->sources, layout.test("a")->sources);
+    EXPECT_EQ(loaded->test("c")->sources, layout.test("c")->sources);
+    EXPECT_EQ(loaded->example("d")->sources, layout.example("d")->sources);
+    EXPECT_EQ(loaded->bench("e")->sources, layout.bench("e")->sources);
+
+    // truncated
+    const auto data = ss.str();
+    std::stringstream truncated(data.substr(0, data.size() / 2));
+    EXPECT_FALSE(Layout::load(truncated));
+}
+
+TEST(layout, load_header_only_lib)
+{
+    DirTree tree({
+        "include/",
+    });
+
+    std::stringstream ss;
+    Layout(tree.root(), kApp).save(ss);
+
+    // the include dir is not listed by the source index
+    fs::remove(tree.root() / "include");
+    EXPECT_FALSE(Layout::load(ss));
+}
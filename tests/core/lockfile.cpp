@@ -0,0 +1,146 @@
+#include "cppship/core/lockfile.h"
+
+#include <algorithm>
+#include <ranges>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "cppship/util/io.h"
+
+using namespace cppship;
+
+namespace {
+
+Manifest mock_manifest(const fs::path& file, const std::string_view content)
+{
+    write(file, content);
+    return Manifest { file };
+}
+
+constexpr std::string_view kManifest = R"([package]
+name = "abc"
+version = "0.1.0"
+
+[dependencies]
+boost = { version = "1.81.0", components = ["headers"], options = { header_only = true } }
+fmt = "10.0.0"
+scope_guard = { git = "https://github.com/Neargye/scope_guard.git", commit = "fa60305", sparse = true }
+
+[dev-dependencies]
+gtest = "1.16.0"
+)";
+
+}
+
+TEST(lockfile, Fingerprint)
+{
+    const auto file = fs::temp_directory_path() / "cppship.lockfile.toml";
+    const auto fingerprint = dependency_fingerprint(mock_manifest(file, kManifest));
+
+    EXPECT_EQ(dependency_fingerprint(mock_manifest(file, kManifest)), fingerprint);
+    EXPECT_NE(dependency_fingerprint(mock_manifest(file, R"([package]
+name = "abc"
+version = "0.1.0"
+
+[dependencies]
+fmt = "10.0.0"
+)")),
+        fingerprint);
+
+    fs::remove(file);
+}
+
+TEST(lockfile, SaveAndLoad)
+{
+    const auto file = fs::temp_directory_path() / "cppship.lockfile.toml";
+    const auto lock = fs::temp_directory_path() / "cppship.lock.test";
+    const auto manifest = mock_manifest(file, kManifest);
+
+    ResolveResult result {
+        .conan_dependencies = { manifest.dependencies()[0], manifest.dependencies()[1] },
+        .conan_dev_dependencies = manifest.dev_dependencies(),
+        .resolved_dependencies = ResolvedDependencies { Dependency {
+            .package = "scope_guard",
+            .cmake_package = "scope_guard",
+            .cmake_target = "cppship::scope_guard",
+        } },
+        .dependencies = manifest.dependencies(),
+        .dev_dependencies = manifest.dev_dependencies(),
+    };
+
+    save_lockfile(lock, "abc", result);
+    EXPECT_FALSE(load_lockfile(lock, "def"));
+    EXPECT_FALSE(load_lockfile(file.parent_path() / "not-exist.lock", "abc"));
+
+    const auto loaded = load_lockfile(lock, "abc");
+    ASSERT_TRUE(loaded);
+    ASSERT_EQ(loaded->dependencies.size(), 3);
+    EXPECT_EQ(loaded->conan_dependencies.size(), 2);
+    EXPECT_EQ(loaded->dev_dependencies.size(), 1);
+    EXPECT_EQ(loaded->resolved_dependencies.get_or_die("scope_guard").cmake_target, "cppship::scope_guard");
+
+    for (const auto& dep : loaded->dependencies) {
+        if (dep.package == "boost") {
+            const auto& desc = std::get<ConanDep>(dep.desc);
+            EXPECT_EQ(desc.version, "1.81.0");
+            EXPECT_EQ(desc.options.at("header_only"), "True");
+            EXPECT_EQ(dep.components, std::vector<std::string> { "headers" });
+        } else if (dep.package == "scope_guard") {
+            const auto& desc = std::get<GitDep>(dep.desc);
+            EXPECT_EQ(desc.commit, "fa60305");
+            EXPECT_TRUE(desc.sparse);
+        }
+    }
+
+    fs::remove(file);
+    fs::remove(lock);
+}
+
+TEST(lockfile, EmptyCommit)
+{
+    const auto file = fs::temp_directory_path() / "cppship.lockfile.toml";
+    const auto lock = fs::temp_directory_path() / "cppship.lock.test";
+    const auto manifest = mock_manifest(file, kManifest);
+
+    auto dep = *std::ranges::find(manifest.dependencies(), "scope_guard", &DeclaredDependency::package);
+    std::get<GitDep>(dep.desc).commit.clear();
+    save_lockfile(lock, "abc", { .dependencies = { dep } });
+
+    // it would reach git as an empty argument, resolve again instead
+    EXPECT_FALSE(load_lockfile(lock, "abc"));
+
+    fs::remove(file);
+    fs::remove(lock);
+}
+
+TEST(lockfile, ChangedConanPackages)
+{
+    const auto file = fs::temp_directory_path() / "cppship.lockfile.toml";
+    const auto lock = fs::temp_directory_path() / "cppship.lock.test";
+    const auto manifest = mock_manifest(file, kManifest);
+    auto conan_deps = manifest.dependencies() | std::views::filter(&DeclaredDependency::is_conan);
+
+    ResolveResult result {
+        .conan_dependencies = { conan_deps.begin(), conan_deps.end() },
+        .conan_dev_dependencies = manifest.dev_dependencies(),
+    };
+    EXPECT_FALSE(changed_conan_packages(lock, result));
+
+    save_lockfile(lock, "abc", result);
+    EXPECT_EQ(changed_conan_packages(lock, result), std::set<std::string> {});
+
+    // fmt bumped, gtest removed and zlib added, boost stays locked
+    for (auto& dep : result.conan_dependencies) {
+        if (dep.package == "fmt") {
+            std::get<ConanDep>(dep.desc).version = "10.1.0";
+        }
+    }
+    result.conan_dev_dependencies = { { .package = "zlib", .desc = ConanDep { .version = "1.3" } } };
+    EXPECT_EQ(changed_conan_packages(lock, result), (std::set<std::string> { "fmt", "gtest", "zlib" }));
+
+    fs::remove(file);
+    fs::remove(lock);
+}
@@ -53,6 +53,23 @@ TEST(manifest, PackageBasicFields)
     EXPECT_TRUE(meta.dependencies().empty());
 }
 
+TEST(manifest, Multiversion)
+{
+    const auto meta = mock_manifest(R"([package]
+    name = "abc"
+    version = "0.1.0"
+
+    [lib]
+    multiversion = ["lib/simd", "lib/dot.cpp"]
+    )");
+
+    EXPECT_EQ(meta.multiversion_sources(), (std::vector<fs::path> { "lib/simd", "lib/dot.cpp" }));
+    EXPECT_TRUE(meta.is_multiversion_source("/abc", "/abc/lib/simd/a.cpp"));
+    EXPECT_TRUE(meta.is_multiversion_source("/abc", "/abc/lib/dot.cpp"));
+    EXPECT_FALSE(meta.is_multiversion_source("/abc", "/abc/lib/simd.cpp"));
+    EXPECT_FALSE(meta.is_multiversion_source("/abc", "/abc/lib/a.cpp"));
+}
+
 TEST(manifest, PackageStd)
 {
     auto meta = mock_manifest(R"([package]
@@ -227,6 +244,17 @@ scope_guard = { git = "https://github.com/Neargye/scope_guard.git", commit = "fa
     const auto& desc = get<GitDep>(dep.desc);
     EXPECT_EQ(desc.git, "https://github.com/Neargye/scope_guard.git");
     EXPECT_EQ(desc.commit, "fa60305b5805dcd872b3c60d0bc517c505f99502");
+    EXPECT_FALSE(desc.sparse);
+
+    const auto sparse = mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[dependencies]
+scope_guard = { git = "https://github.com/Neargye/scope_guard.git", commit = "fa60305", sparse = true }
+)");
+    ASSERT_EQ(sparse.dependencies().size(), 1);
+    EXPECT_TRUE(get<GitDep>(sparse.dependencies()[0].desc).sparse);
 
     ASSERT_THROW(mock_manifest(R"([package]
 name = "abc"
@@ -409,3 +437,92 @@ definitions = ["A"]
 
     ASSERT_TRUE(meta.profile(Profile::release).conditional_configs.empty());
 }
+
+TEST(manifest, CustomProfile)
+{
+    auto meta = mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[profile.bench]
+definitions = ["BENCH"]
+
+[profile.fast]
+inherits = "Profiling"
+cxxflags = ["-ffast-math"]
+
+[target.'cfg(compiler = "msvc")'.profile.fast]
+cxxflags = ["/fp:fast"]
+    )");
+
+    const Profile fast { "fast" };
+    EXPECT_EQ(
+        meta.profile_chain(fast), (std::vector<Profile> { Profile::release, Profile { kProfileProfiling }, fast }));
+    EXPECT_EQ(meta.profile_chain(Profile::debug), std::vector<Profile> { Profile::debug });
+    EXPECT_EQ(meta.list_profiles().size(), 6);
+
+    EXPECT_EQ(meta.profile(fast).config.cxxflags, std::vector<std::string> { "-ffast-math" });
+    ASSERT_EQ(meta.profile(fast).conditional_configs.size(), 1);
+    EXPECT_EQ(meta.profile(fast).conditional_configs[0].condition, cfg::Compiler::msvc);
+
+    // appended to the predefined one
+    const auto& bench = meta.profile(Profile { kProfileBench });
+    EXPECT_EQ(bench.config.definitions, std::vector<std::string> { "BENCH" });
+    EXPECT_FALSE(bench.conditional_configs.empty());
+
+    EXPECT_THROW(meta.profile_chain(Profile { "unknown" }), InvalidProfile);
+    EXPECT_TRUE(meta.profile(Profile { "unknown" }).config.cxxflags.empty());
+}
+
+TEST(manifest, CustomProfileInvalid)
+{
+    EXPECT_THROW(mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[profile.fast]
+cxxflags = ["-ffast-math"]
+    )"),
+        Error);
+
+    EXPECT_THROW(mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[profile.a]
+inherits = "b"
+
+[profile.b]
+inherits = "a"
+    )"),
+        Error);
+
+    EXPECT_THROW(mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[profile.a]
+inherits = "c"
+    )"),
+        Error);
+
+    EXPECT_THROW(mock_manifest(R"([package]
+name = "abc"
+version = "0.1.0"
+
+[profile.debug]
+inherits = "release"
+    )"),
+        Error);
+}
+
+TEST(profile, Parse)
+{
+    EXPECT_EQ(parse_profile("Debug"), Profile::debug);
+    EXPECT_EQ(parse_profile("RELEASE"), Profile::release);
+    EXPECT_EQ(parse_profile("my_bench-2").name(), "my_bench-2");
+    EXPECT_EQ(to_string(Profile::debug), kProfileDebug);
+    EXPECT_EQ(to_string(Profile { "Profiling" }), kProfileProfiling);
+    EXPECT_THROW(parse_profile(""), InvalidProfile);
+    EXPECT_THROW(parse_profile("a/b"), InvalidProfile);
+}
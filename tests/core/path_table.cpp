@@ -0,0 +1,67 @@
+#include "cppship/core/path_table.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+
+using namespace cppship;
+
+TEST(path_table, Intern)
+{
+    PathTable table;
+    const auto a = table.intern("lib/a.cpp");
+    const auto b = table.intern("lib/b.cpp");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(table.intern("lib/a.cpp"), a);
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_EQ(table[a], "lib/a.cpp");
+    EXPECT_EQ(table.find("lib/b.cpp"), b);
+    EXPECT_FALSE(table.find("lib/c.cpp"));
+    EXPECT_FALSE(PathTable {}.find("lib/a.cpp"));
+}
+
+TEST(path_table, IdsStableAcrossGrowth)
+{
+    PathTable table;
+    std::vector<PathId> ids;
+    for (int i = 0; i < 10000; ++i) {
+        ids.push_back(table.intern(fmt::format("src/{}.cpp", i)));
+    }
+
+    ASSERT_EQ(table.size(), 10000);
+    for (int i = 0; i < 10000; ++i) {
+        const auto path = fmt::format("src/{}.cpp", i);
+        EXPECT_EQ(table[ids[i]], path);
+        EXPECT_EQ(table.intern(path), ids[i]);
+    }
+}
+
+TEST(path_table, PathSet)
+{
+    auto table = std::make_shared<PathTable>();
+    const auto c = table->intern("c.cpp");
+    const auto a = table->intern("a.cpp");
+    const auto b = table->intern("b.cpp");
+
+    const PathSet set(table, { c, a, b, a });
+    ASSERT_EQ(set.size(), 3);
+    EXPECT_EQ(std::vector<fs::path>(set.begin(), set.end()), (std::vector<fs::path> { "a.cpp", "b.cpp", "c.cpp" }));
+    EXPECT_TRUE(set.contains("b.cpp"));
+    EXPECT_FALSE(set.contains("d.cpp"));
+    EXPECT_TRUE(PathSet {}.empty());
+    EXPECT_FALSE(PathSet {}.contains("a.cpp"));
+
+    // compared by paths
+    const PathSet same { "b.cpp", "c.cpp", "a.cpp", "b.cpp" };
+    EXPECT_EQ(set, same);
+    EXPECT_NE(set, PathSet(table, { a, b }));
+    EXPECT_EQ(set.filter([](const fs::path& path) { return path != "b.cpp"; }), PathSet(table, { a, c }));
+
+    // the set keeps the table alive
+    const auto copy = set;
+    table.reset();
+    EXPECT_EQ(copy, same);
+}
@@ -0,0 +1,134 @@
+#include "cppship/core/remote_cache.h"
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+
+#include "cppship/core/cache_server.h"
+#include "cppship/exception.h"
+#include "cppship/util/io.h"
+
+using namespace cppship;
+
+namespace {
+
+class LocalServer {
+public:
+    explicit LocalServer(std::uint64_t max_blob_size = kRemoteCacheMaxBlobSize)
+        : mServer(mRoot, "127.0.0.1", 0, max_blob_size)
+        , mThread([this] { mServer.run(); })
+    {
+    }
+
+    ~LocalServer()
+    {
+        mServer.stop();
+        mThread.join();
+        fs::remove_all(mRoot);
+    }
+
+    LocalServer(const LocalServer&) = delete;
+    LocalServer& operator=(const LocalServer&) = delete;
+
+    std::string url() const { return fmt::format("http://127.0.0.1:{}/cache", mServer.port()); }
+
+    const fs::path& root() const { return mRoot; }
+
+private:
+    fs::path mRoot = fs::temp_directory_path() / "cppship.cache-server.test";
+    CacheServer mServer;
+    std::thread mThread;
+};
+
+}
+
+TEST(remote_cache, InvalidUrl)
+{
+    EXPECT_THROW(RemoteCache("https://localhost"), Error);
+    EXPECT_THROW(RemoteCache("http://"), Error);
+    EXPECT_NO_THROW(RemoteCache("http://localhost"));
+}
+
+TEST(remote_cache, GetPut)
+{
+    LocalServer server;
+    RemoteCache cache(server.url());
+
+    EXPECT_FALSE(cache.get("prebuilt", "abc").has_value());
+
+    const std::string blob("a\0b\r\nc", 6);
+    EXPECT_TRUE(cache.put("prebuilt", "abc", blob));
+    EXPECT_EQ(cache.get("prebuilt", "abc"), blob);
+    EXPECT_TRUE(fs::exists(server.root() / "prebuilt" / "abc"));
+
+    // never escape the root
+    EXPECT_FALSE(cache.put("..", "abc", blob));
+    EXPECT_FALSE(cache.get("prebuilt", "..").has_value());
+}
+
+TEST(remote_cache, Files)
+{
+    LocalServer server;
+    RemoteCache cache(server.url());
+
+    const auto tmpdir = fs::temp_directory_path() / "cppship.remote-cache.test";
+    fs::remove_all(tmpdir);
+    fs::create_directories(tmpdir);
+    write(tmpdir / "lib.a", "archive");
+
+    cache.put_file_async("prebuilt", "key", tmpdir / "lib.a");
+    cache.wait();
+
+    EXPECT_TRUE(cache.get_file("prebuilt", "key", tmpdir / "fetched" / "lib.a"));
+    EXPECT_EQ(read_as_string(tmpdir / "fetched" / "lib.a"), "archive");
+    EXPECT_FALSE(cache.get_file("prebuilt", "missing", tmpdir / "missing"));
+    EXPECT_FALSE(fs::exists(tmpdir / "missing"));
+
+    fs::remove_all(tmpdir);
+}
+
+TEST(remote_cache, MaxBlobSize)
+{
+    constexpr std::uint64_t kMaxBlobSize = 1024;
+    LocalServer server(kMaxBlobSize);
+
+    const auto tmpdir = fs::temp_directory_path() / "cppship.remote-cache.size";
+    fs::remove_all(tmpdir);
+    fs::create_directories(tmpdir);
+    write(tmpdir / "small", std::string(kMaxBlobSize, 's'));
+    write(tmpdir / "large", std::string(kMaxBlobSize + 1, 'l'));
+
+    RemoteCache cache(server.url());
+    EXPECT_TRUE(cache.put_file("prebuilt", "small", tmpdir / "small"));
+    EXPECT_FALSE(cache.put_file("prebuilt", "large", tmpdir / "large"));
+    EXPECT_FALSE(fs::exists(server.root() / "prebuilt" / "large"));
+    // uploads are moved in place or removed
+    EXPECT_TRUE(fs::is_empty(server.root() / ".uploads"));
+
+    // the client limit is checked while streaming, a partial file is never left
+    fs::copy_file(tmpdir / "large", server.root() / "prebuilt" / "large");
+    RemoteCache small_cache(server.url(), kMaxBlobSize);
+    EXPECT_TRUE(small_cache.get_file("prebuilt", "small", tmpdir / "fetched" / "small"));
+    EXPECT_EQ(read_as_string(tmpdir / "fetched" / "small"), read_as_string(tmpdir / "small"));
+    EXPECT_FALSE(small_cache.get_file("prebuilt", "large", tmpdir / "fetched" / "large"));
+    EXPECT_EQ(std::distance(fs::directory_iterator(tmpdir / "fetched"), fs::directory_iterator {}), 1);
+
+    fs::remove_all(tmpdir);
+}
+
+TEST(remote_cache, Unreachable)
+{
+    // nothing listens on the port, errors are misses
+    const auto port = [] {
+        CacheServer server(fs::temp_directory_path() / "cppship.cache-server.port", "127.0.0.1", 0);
+        return server.port();
+    }();
+
+    RemoteCache cache(fmt::format("http://127.0.0.1:{}", port));
+    EXPECT_FALSE(cache.get("prebuilt", "abc").has_value());
+    EXPECT_FALSE(cache.put("prebuilt", "abc", "x"));
+}
@@ -0,0 +1,184 @@
+#include "cppship/core/source_index.h"
+
+#include <fstream>
+#include <set>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "cppship/core/layout.h"
+#include "cppship/util/repo.h"
+
+using namespace cppship;
+
+namespace {
+
+class DirTree {
+public:
+    explicit DirTree(const std::set<std::string_view>& trees)
+    {
+        fs::create_directory(mRoot);
+
+        for (const auto& path : trees) {
+            add(path);
+        }
+    }
+
+    ~DirTree() { fs::remove_all(mRoot); }
+
+    DirTree(const DirTree&) = delete;
+    DirTree& operator=(const DirTree&) = delete;
+
+    void add(std::string_view path)
+    {
+        const auto fs_path = mRoot / path;
+        fs::create_directories(fs_path.parent_path());
+        std::ofstream ofs(fs_path);
+    }
+
+    const fs::path& root() const { return mRoot; }
+
+    fs::path index_file() const { return mRoot / "source.index"; }
+
+    std::vector<fs::path> dirs() const { return { mRoot / "src", mRoot / "lib", mRoot / "tests" }; }
+
+private:
+    fs::path mRoot = fs::temp_directory_path() / "cppship.index.test";
+};
+
+}
+
+TEST(source_index, Refresh)
+{
+    DirTree tree({ "src/main.cpp", "src/bin/a.cpp", "lib/a.cpp", "lib/a.h", "tests/x/b.cpp" });
+
+    SourceIndex index(tree.index_file());
+    index.refresh(tree.dirs());
+    EXPECT_TRUE(index.changed());
+    EXPECT_EQ(index.list_files(),
+        (std::set<fs::path> {
+            tree.root() / "src/main.cpp",
+            tree.root() / "src/bin/a.cpp",
+            tree.root() / "lib/a.cpp",
+            tree.root() / "tests/x/b.cpp",
+        }));
+    EXPECT_EQ(index.list_sources(tree.root() / "src"), list_sources(tree.root() / "src"));
+    EXPECT_EQ(index.list_cpp_files(tree.root() / "src"), list_cpp_files(tree.root() / "src"));
+    EXPECT_TRUE(index.list_sources(tree.root() / "benches").empty());
+
+    index.save();
+    SourceIndex reloaded(tree.index_file());
+    reloaded.refresh(tree.dirs());
+    EXPECT_FALSE(reloaded.changed());
+    EXPECT_EQ(reloaded.list_files(), index.list_files());
+}
+
+TEST(source_index, NestedRoots)
+{
+    DirTree tree({ "src/main.cpp", "src/bin/a.cpp", "lib/a.cpp" });
+
+    SourceIndex index;
+    index.refresh({ tree.root() / "src", tree.root() / "src/bin", tree.root() / "lib", tree.root() / "src" });
+    EXPECT_EQ(index.list_files(),
+        (std::set<fs::path> {
+            tree.root() / "src/main.cpp",
+            tree.root() / "src/bin/a.cpp",
+            tree.root() / "lib/a.cpp",
+        }));
+}
+
+TEST(source_index, AddAndRemove)
+{
+    DirTree tree({ "src/main.cpp", "lib/a.cpp" });
+
+    {
+        SourceIndex index(tree.index_file());
+        index.refresh(tree.dirs());
+        index.save();
+    }
+
+    tree.add("lib/sub/b.cpp");
+    {
+        SourceIndex index(tree.index_file());
+        index.refresh(tree.dirs());
+        EXPECT_TRUE(index.changed());
+        EXPECT_TRUE(index.list_files().contains(tree.root() / "lib/sub/b.cpp"));
+        index.save();
+    }
+
+    fs::remove_all(tree.root() / "lib");
+    {
+        SourceIndex index(tree.index_file());
+        index.refresh(tree.dirs());
+        EXPECT_TRUE(index.changed());
+        EXPECT_EQ(index.list_files(), (std::set<fs::path> { tree.root() / "src/main.cpp" }));
+    }
+}
+
+TEST(source_index, CorruptedIndex)
+{
+    DirTree tree({ "src/main.cpp" });
+    {
+        std::ofstream ofs(tree.index_file());
+        ofs << "garbage";
+    }
+
+    SourceIndex index(tree.index_file());
+    index.refresh(tree.dirs());
+    EXPECT_TRUE(index.changed());
+    EXPECT_EQ(index.list_files(), (std::set<fs::path> { tree.root() / "src/main.cpp" }));
+}
+
+TEST(source_index, RacilyClean)
+{
+    DirTree tree({ "src/main.cpp" });
+    const auto src = tree.root() / "src";
+    {
+        SourceIndex index(tree.index_file());
+        index.refresh(tree.dirs());
+        index.save();
+    }
+
+    // a file added in the same tick as the index was written leaves every stamp unchanged
+    const auto mtime = fs::last_write_time(src);
+    tree.add("src/new.cpp");
+    fs::last_write_time(src, mtime);
+    fs::last_write_time(tree.index_file(), mtime);
+
+    SourceIndex index(tree.index_file());
+    index.refresh(tree.dirs());
+    EXPECT_TRUE(index.changed());
+    EXPECT_EQ(index.list_files(), (std::set<fs::path> { src / "main.cpp", src / "new.cpp" }));
+}
+
+TEST(source_index, TruncatedIndex)
+{
+    DirTree tree({ "src/main.cpp" });
+    {
+        SourceIndex index(tree.index_file());
+        index.refresh(tree.dirs());
+        index.save();
+    }
+
+    // a length read from the cut tail must not be trusted
+    fs::resize_file(tree.index_file(), fs::file_size(tree.index_file()) - 1);
+
+    SourceIndex index(tree.index_file());
+    index.refresh(tree.dirs());
+    EXPECT_TRUE(index.changed());
+    EXPECT_EQ(index.list_files(), (std::set<fs::path> { tree.root() / "src/main.cpp" }));
+}
+
+TEST(source_index, Layout)
+{
+    DirTree tree({ "src/main.cpp", "src/bin/a.cpp", "lib/a.cpp", "lib/a_test.cpp", "tests/b.cpp" });
+
+    SourceIndex index;
+    index.refresh(tree.dirs());
+
+    const Layout indexed(tree.root(), "app", &index);
+    const Layout walked(tree.root(), "app");
+    EXPECT_EQ(indexed.all_files(), walked.all_files());
+    EXPECT_EQ(indexed.binaries().size(), 2);
+    EXPECT_EQ(indexed.tests().size(), 2);
+}
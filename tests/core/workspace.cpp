@@ -1,6 +1,7 @@
 #include "cppship/core/workspace.h"
 
 #include <atomic>
+#include <chrono>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -9,6 +10,7 @@
 #include <range/v3/algorithm/sort.hpp>
 
 #include "cppship/core/manifest.h"
+#include "cppship/core/source_index.h"
 #include "cppship/exception.h"
 #include "cppship/util/io.h"
 
@@ -109,7 +111,7 @@ name = "app_2")");
     Manifest manifest(tree.root() / "cppship.toml");
     Workspace workspace(tree.root(), manifest);
     for (const auto& layout : workspace.layouts()) {
-        ASSERT_TRUE(layout.example("app_1").has_value());
+        ASSERT_NE(layout.example("app_1"), nullptr);
     }
 }
 
@@ -136,7 +138,7 @@ name = "app_2")");
     Workspace workspace(tree.root(), manifest);
 
     for (const auto& layout : workspace.layouts()) {
-        ASSERT_TRUE(layout.bench("app_1").has_value());
+        ASSERT_NE(layout.bench("app_1"), nullptr);
     }
 }
 
@@ -163,7 +165,7 @@ name = "app_2")");
     Workspace workspace(tree.root(), manifest);
 
     for (const auto& layout : workspace.layouts()) {
-        ASSERT_TRUE(layout.test("app_1").has_value());
+        ASSERT_NE(layout.test("app_1"), nullptr);
     }
 }
 
@@ -195,3 +197,89 @@ name = "app_2")");
     Manifest manifest(tree.root() / "cppship.toml");
     Workspace workspace(tree.root(), manifest);
 }
+
+TEST(workspace, AffectedPackages)
+{
+    DirTree tree({
+        "cppship.toml",
+        "README.md",
+        "app_1/cppship.toml",
+        "app_1/src/main.cpp",
+        "libs/app_2/cppship.toml",
+        "libs/app_2/lib/lib.cpp",
+        "app_3/cppship.toml",
+    });
+
+    write("cppship.toml", R"([workspace]
+members = ["app_1", "libs/app_2", "app_3"])");
+    write("app_1/cppship.toml", R"([package]
+version = "1.0.0"
+name = "app_1")");
+    write("libs/app_2/cppship.toml", R"([package]
+version = "1.0.0"
+name = "app_2")");
+    write("app_3/cppship.toml", R"([package]
+version = "1.0.0"
+name = "app_3"
+
+[dependencies]
+app_2 = { git = "https://github.com/example/app_2.git", commit = "fa60305" })");
+
+    Manifest manifest(tree.root() / "cppship.toml");
+    Workspace workspace(tree.root(), manifest);
+
+    ASSERT_NE(workspace.owner(tree.root() / "libs/app_2/lib/lib.cpp"), nullptr);
+    EXPECT_EQ(workspace.owner(tree.root() / "libs/app_2/lib/lib.cpp")->package(), "app_2");
+    EXPECT_EQ(workspace.owner(tree.root() / "README.md"), nullptr);
+    EXPECT_EQ(workspace.owner(tree.root() / "libs/other.cpp"), nullptr);
+
+    using Packages = std::set<std::string>;
+    EXPECT_EQ(affected_packages(workspace, manifest, {}), Packages {});
+    EXPECT_EQ(affected_packages(workspace, manifest, { tree.root() / "README.md" }), Packages {});
+    EXPECT_EQ(affected_packages(workspace, manifest, { tree.root() / "app_1/src/main.cpp" }), Packages { "app_1" });
+    EXPECT_EQ(affected_packages(workspace, manifest, { tree.root() / "libs/app_2/lib/removed.cpp" }),
+        (Packages { "app_2", "app_3" }));
+    EXPECT_EQ(affected_packages(workspace, manifest, { tree.root() / "cppship.toml" }),
+        (Packages { "app_1", "app_2", "app_3" }));
+}
+
+TEST(workspace, Snapshot)
+{
+    DirTree tree({
+        "cppship.toml",
+        "app_1/cppship.toml",
+        "app_1/src/main.cpp",
+        "app_2/cppship.toml",
+        "app_2/lib/a.cpp",
+    });
+
+    write("cppship.toml", R"([workspace]
+members = ["app_1", "app_2"])");
+    write("app_1/cppship.toml", R"([package]
+version = "1.0.0"
+name = "app_1")");
+    write("app_2/cppship.toml", R"([package]
+version = "1.0.0"
+name = "app_2")");
+
+    const Manifest manifest(tree.root() / "cppship.toml");
+    const auto snapshot = tree.root() / "build" / "workspace.snapshot";
+    const auto lib_sources = [&] {
+        SourceIndex index;
+        const Workspace workspace(tree.root(), manifest, index, snapshot);
+        return workspace.layout("app_2")->lib()->sources.size();
+    };
+
+    EXPECT_EQ(lib_sources(), 1);
+    ASSERT_TRUE(fs::exists(snapshot));
+
+    // loaded rather than saved again while the sources are the same
+    const auto saved_at = fs::last_write_time(snapshot) - std::chrono::seconds(10);
+    fs::last_write_time(snapshot, saved_at);
+    EXPECT_EQ(lib_sources(), 1);
+    EXPECT_EQ(fs::last_write_time(snapshot), saved_at);
+
+    touch(tree.root() / "app_2" / "lib" / "b.cpp");
+    EXPECT_EQ(lib_sources(), 2);
+    EXPECT_NE(fs::last_write_time(snapshot), saved_at);
+}
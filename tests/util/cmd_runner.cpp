@@ -0,0 +1,131 @@
+#include "cppship/util/cmd_runner.h"
+
+#include <chrono>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+
+#include "cppship/util/io.h"
+
+using namespace cppship;
+using namespace cppship::util;
+using namespace std::chrono_literals;
+
+TEST(cmd_runner, Hook)
+{
+    std::vector<std::string> cmds;
+    CmdRunner runner([&cmds](std::string_view cmd) {
+        cmds.emplace_back(cmd);
+        return 1;
+    });
+
+    const auto results = runner.run_all({ { .args = { "a", "b" } }, { .args = { "c" } } }, 2);
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(results[0].exit_code, 1);
+    EXPECT_EQ(cmds, (std::vector<std::string> { "a b", "c" }));
+}
+
+#ifndef _WINDOWS
+
+TEST(cmd_runner, RunAll)
+{
+    std::vector<Task> tasks;
+    for (int i = 0; i < 8; ++i) {
+        tasks.push_back({ .args = { "sh", "-c", fmt::format("echo out-{0}; echo err-{0} >&2; exit {0}", i) } });
+    }
+    tasks.push_back({ .args = { "sh", "-c", "echo out; echo err >&2" }, .capture_stderr = false });
+
+    std::vector<std::size_t> done;
+    const auto results
+        = CmdRunner {}.run_all(tasks, 3, [&done](std::size_t i, const TaskResult&) { done.push_back(i); });
+
+    ASSERT_EQ(results.size(), tasks.size());
+    EXPECT_EQ(done.size(), tasks.size());
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(results[i].exit_code, i);
+        EXPECT_EQ(results[i].output, fmt::format("out-{}\n", i));
+        EXPECT_EQ(results[i].error_output, fmt::format("err-{}\n", i));
+    }
+    EXPECT_TRUE(results[8].ok());
+    EXPECT_EQ(results[8].output, "out\n");
+    EXPECT_TRUE(results[8].error_output.empty());
+}
+
+TEST(cmd_runner, LogFile)
+{
+    const auto log = fs::temp_directory_path() / "cppship.cmd_runner.log";
+    const auto results = CmdRunner {}.run_all(
+        { { .args = { "sh", "-c", "pwd; echo err >&2" }, .cwd = fs::temp_directory_path(), .log_file = log } }, 1);
+
+    ASSERT_TRUE(results[0].ok());
+    EXPECT_TRUE(results[0].output.empty());
+    EXPECT_TRUE(results[0].error_output.empty());
+    EXPECT_EQ(read_as_string(log), fmt::format("{}\nerr\n", fs::canonical(fs::temp_directory_path()).string()));
+    fs::remove(log);
+}
+
+TEST(cmd_runner, LargeOutput)
+{
+    // both pipes are drained while the child runs, neither blocks it when full
+    const auto results = CmdRunner {}.run_all(
+        { { .args = { "sh", "-c", "head -c 1000000 /dev/zero; head -c 1000000 /dev/zero >&2; echo done >&2" } } }, 1);
+
+    ASSERT_TRUE(results[0].ok());
+    EXPECT_EQ(results[0].output.size(), 1000000);
+    EXPECT_EQ(results[0].error_output.size(), 1000005);
+}
+
+TEST(cmd_runner, ExitBeforeOutputClosed)
+{
+    // the exit code is taken when the child exits, output is read until the background writer closes it
+    const auto results
+        = CmdRunner {}.run_all({ { .args = { "sh", "-c", "(sleep 0.2; echo late) & echo early; exit 3" } } }, 1);
+
+    EXPECT_EQ(results[0].exit_code, 3);
+    EXPECT_EQ(results[0].output, "early\nlate\n");
+}
+
+TEST(cmd_runner, Timeout)
+{
+    // the background sleep holds the pipe open, so the whole group must be killed
+    const auto start = std::chrono::steady_clock::now();
+    const auto results = CmdRunner {}.run_all(
+        { { .args = { "sh", "-c", "sleep 10 & sleep 10; wait" }, .timeout = 100ms }, { .args = { "true" } } }, 2);
+
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+    EXPECT_TRUE(results[0].timed_out);
+    EXPECT_FALSE(results[0].ok());
+    EXPECT_TRUE(results[1].ok());
+}
+
+TEST(cmd_runner, Cancel)
+{
+    std::stop_source stop;
+    const std::vector<Task> tasks { { .args = { "true" } }, { .args = { "sleep", "10" } }, { .args = { "true" } } };
+    const auto results = CmdRunner {}.run_all(tasks,
+        2,
+        [&stop](std::size_t i, const TaskResult&) {
+            if (i == 0) {
+                stop.request_stop();
+            }
+        },
+        stop.get_token());
+
+    EXPECT_TRUE(results[0].ok());
+    EXPECT_TRUE(results[1].cancelled);
+    EXPECT_TRUE(results[2].cancelled);
+}
+
+TEST(cmd_runner, NotFound)
+{
+    const auto results = CmdRunner {}.run_all({ { .args = { "something-not-exist" } }, { .args = { "true" } } }, 1);
+
+    EXPECT_FALSE(results[0].ok());
+    EXPECT_FALSE(results[0].error_output.empty());
+    EXPECT_TRUE(results[1].ok());
+}
+
+#endif
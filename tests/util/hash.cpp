@@ -0,0 +1,18 @@
+#include <gtest/gtest.h>
+
+#include "cppship/util/hash.h"
+
+using namespace cppship::util;
+
+TEST(hash, fnv1a)
+{
+    EXPECT_EQ(hash_hex(""), "cbf29ce484222325");
+    EXPECT_EQ(hash_hex("a"), "af63dc4c8601ec8c");
+    EXPECT_EQ(hash_hex("foobar"), "85944171f73967e8");
+}
+
+TEST(hash, update)
+{
+    EXPECT_EQ(Hasher {}.update("foo").update("bar").hex(), hash_hex("foobar"));
+    EXPECT_NE(hash_hex("https://github.com/a/b.git"), hash_hex("https://github.com/a/c.git"));
+}
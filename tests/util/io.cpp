@@ -50,4 +50,22 @@ TEST(io, read_as_string_by_path)
     fs::remove(tmpfile);
 
     EXPECT_THROW(read_as_string(tmpfile), IOError);
-}
\ No newline at end of file
+}
+TEST(io, write_atomic)
+{
+    const auto tmpdir = fs::temp_directory_path() / "cppship.write_atomic";
+    fs::remove_all(tmpdir);
+    fs::create_directories(tmpdir);
+
+    const std::string binary("a\r\n\0b", 5);
+    write_atomic(tmpdir / "blob", binary);
+    EXPECT_EQ(read_binary(tmpdir / "blob"), binary);
+
+    write_atomic(tmpdir / "blob", "new");
+    EXPECT_EQ(read_binary(tmpdir / "blob"), "new");
+
+    // no temp files left
+    EXPECT_EQ(std::distance(fs::directory_iterator(tmpdir), fs::directory_iterator {}), 1);
+
+    fs::remove_all(tmpdir);
+}
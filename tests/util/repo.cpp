@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "cppship/exception.h"
+#include "cppship/util/repo.h"
+
+using namespace cppship;
+using namespace cppship::repo_internals;
+
+TEST(repo, ParseDiffHunksModified)
+{
+    const auto res = parse_diff_hunks(R"(diff --git a/lib/a.cpp b/lib/a.cpp
+index 1111111..2222222 100644
+--- a/lib/a.cpp
++++ b/lib/a.cpp
+@@ -3 +3 @@ int a()
+-    return 1;
++    return 2;
+@@ -10,0 +11,3 @@ int b()
++int c()
++{
++}
+)");
+
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_TRUE(res.contains("lib/a.cpp"));
+    EXPECT_EQ(res.at("lib/a.cpp"), (std::vector<LineRange> { { 3, 3 }, { 11, 13 } }));
+}
+
+TEST(repo, ParseDiffHunksNewAndDeletedFile)
+{
+    const auto res = parse_diff_hunks(R"(diff --git a/include/a.h b/include/a.h
+new file mode 100644
+index 0000000..1111111
+--- /dev/null
++++ b/include/a.h
+@@ -0,0 +1,2 @@
++#pragma once
++
+diff --git a/include/b.h b/include/b.h
+deleted file mode 100644
+index 1111111..0000000
+--- a/include/b.h
++++ /dev/null
+@@ -1,2 +0,0 @@
+-#pragma once
+-
+)");
+
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_TRUE(res.contains("include/a.h"));
+    EXPECT_EQ(res.at("include/a.h"), (std::vector<LineRange> { { 1, 2 } }));
+}
+
+TEST(repo, ParseDiffHunksPureDeletion)
+{
+    const auto res = parse_diff_hunks(R"(diff --git a/lib/a.cpp b/lib/a.cpp
+index 1111111..2222222 100644
+--- a/lib/a.cpp
++++ b/lib/a.cpp
+@@ -5,2 +4,0 @@ int a()
+-    int x = 0;
+-    int y = 0;
+)");
+
+    EXPECT_TRUE(res.empty());
+}
+
+TEST(repo, ParseDiffHunksContentLooksLikeHeader)
+{
+    const auto res = parse_diff_hunks(R"(diff --git a/lib/a.cpp b/lib/a.cpp
+index 1111111..2222222 100644
+--- a/lib/a.cpp
++++ b/lib/a.cpp
+@@ -1,0 +2,2 @@
++++ b/lib/b.cpp
++-- a/lib/b.cpp
+)");
+
+    ASSERT_EQ(res.size(), 1);
+    ASSERT_TRUE(res.contains("lib/a.cpp"));
+    EXPECT_EQ(res.at("lib/a.cpp"), (std::vector<LineRange> { { 2, 3 } }));
+}
+
+TEST(repo, ParseDiffHunksInvalid)
+{
+    EXPECT_THROW(parse_diff_hunks(R"(diff --git a/lib/a.cpp b/lib/a.cpp
+--- a/lib/a.cpp
++++ b/lib/a.cpp
+@@ -1 +x @@
+)"),
+        Error);
+}
+
+TEST(repo, ParseDiffHunksQuotedPaths)
+{
+    const auto res = parse_diff_hunks("diff --git \"a/lib/\\303\\244 \\\"b\\\".cpp\" \"b/lib/\\303\\244 \\\"b\\\".cpp\"\n"
+                                      "--- \"a/lib/\\303\\244 \\\"b\\\".cpp\"\t\n"
+                                      "+++ \"b/lib/\\303\\244 \\\"b\\\".cpp\"\t\n"
+                                      "@@ -1 +1 @@\n"
+                                      "-a\n"
+                                      "+b\n"
+                                      "diff --git a/lib/c d.cpp b/lib/c d.cpp\n"
+                                      "--- a/lib/c d.cpp\t\n"
+                                      "+++ b/lib/c d.cpp\t\n"
+                                      "@@ -2 +2 @@\n"
+                                      "-a\n"
+                                      "+b\n");
+
+    ASSERT_EQ(res.size(), 2);
+    EXPECT_EQ(res.at("lib/\xc3\xa4 \"b\".cpp"), (std::vector<LineRange> { { 1, 1 } }));
+    EXPECT_EQ(res.at("lib/c d.cpp"), (std::vector<LineRange> { { 2, 2 } }));
+
+    EXPECT_THROW(parse_diff_hunks("diff --git a/a b/a\n--- a/a\n+++ \"b/a\\9\"\n@@ -1 +1 @@\n"), Error);
+}
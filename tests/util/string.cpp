@@ -47,4 +47,12 @@ TEST(string, split_to)
     ASSERT_TRUE(res.contains("a"));
     ASSERT_TRUE(res.contains("b"));
     ASSERT_TRUE(res.contains("c"));
-}
\ No newline at end of file
+}
+
+TEST(string, escape_regex)
+{
+    EXPECT_EQ(escape_regex("app_1"), "app_1");
+    EXPECT_EQ(escape_regex("a.b+c"), R"(a\.b\+c)");
+    EXPECT_EQ(escape_regex("x|y(z)"), R"(x\|y\(z\))");
+    EXPECT_EQ(escape_regex(R"([a]\$)"), R"(\[a\]\\\$)");
+}
@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+#include <toml/get.hpp>
+
+#include "cppship/util/io.h"
+#include "cppship/util/toml.h"
+
+using namespace cppship;
+
+TEST(toml, load_toml)
+{
+    const auto tmpfile = fs::temp_directory_path() / "cppship.load_toml.toml";
+
+    write(tmpfile, "a = 1\n");
+    const auto first = load_toml(tmpfile);
+    EXPECT_EQ(toml::find<int>(*first, "a"), 1);
+    EXPECT_EQ(load_toml(tmpfile), first);
+
+    // same size, only content differs
+    write(tmpfile, "a = 2\n");
+    const auto second = load_toml(tmpfile);
+    EXPECT_NE(second, first);
+    EXPECT_EQ(toml::find<int>(*second, "a"), 2);
+    EXPECT_EQ(toml::find<int>(*first, "a"), 1);
+
+    fs::remove(tmpfile);
+}
@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+"""Scalability harness of cppship.
+
+Generates synthetic workspaces of many members, each depending on a deep chain of git deps served from local
+file:// repos, then times cppship commands over them:
+
+    build -d (cold)     resolve and clone the git chain, write compile_commands.json
+    build -d (warm)     the same with nothing changed
+    build               full build, only to prepare the steps below, it needs conan packages in the local cache
+    build (no-op)       nothing changed since the full build
+    test --changed-since HEAD
+                        select and run tests of the member owning one changed source
+    lint                one changed source, compile_commands.json regenerated, needs clang-tidy
+
+Everything runs offline, caches of cppship are redirected to the scratch dir. Results of all sizes go to one json
+report, which can be compared with a report of a previous release:
+
+    tools/scale_harness.py run --members 10,100,1000 --sources 100 --depth 16 --report report.json
+    tools/scale_harness.py compare old.json report.json
+    tools/scale_harness.py generate --members 1000 --sources 100 --depth 16 /tmp/ws
+"""
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+FILES_PER_DIR = 100
+REPORT_VERSION = 1
+
+GIT_ENV = {
+    "GIT_AUTHOR_NAME": "cppship",
+    "GIT_AUTHOR_EMAIL": "cppship@localhost",
+    "GIT_COMMITTER_NAME": "cppship",
+    "GIT_COMMITTER_EMAIL": "cppship@localhost",
+}
+
+
+def git(cwd, *args):
+    env = dict(os.environ, **GIT_ENV)
+    return subprocess.run(["git", *args], cwd=cwd, env=env, check=True, capture_output=True, text=True).stdout.strip()
+
+
+def git_commit_all(repo, message):
+    git(repo, "add", "-A")
+    git(repo, "commit", "-q", "-m", message)
+    return git(repo, "rev-parse", "HEAD")
+
+
+def write(path, content):
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(content)
+
+
+def package_manifest(name, deps):
+    return f'[package]\nname = "{name}"\nversion = "0.1.0"\nstd = 17\n\n[dependencies]\n{deps}'
+
+
+def git_dependency(name, repo, commit):
+    return f'{name} = {{ git = "{repo.resolve().as_uri()}", commit = "{commit}" }}\n'
+
+
+def generate_dependency_chain(git_dir, depth):
+    """header only cppship packages d0 -> d1 -> ... -> d<depth-1>, each one a local git repo"""
+    head = None
+    for i in reversed(range(depth)):
+        name = f"d{i}"
+        repo = git_dir / name
+        deps = git_dependency(*head) if head else ""
+        include = f'#include "d{i + 1}/d{i + 1}.h"\n' if head else ""
+
+        write(repo / "cppship.toml", package_manifest(name, deps))
+        write(repo / "include" / name / f"{name}.h",
+              f"#pragma once\n{include}\ninline int {name}() {{ return {i}; }}\n")
+
+        git(repo.parent, "init", "-q", name)
+        head = (name, repo, git_commit_all(repo, name))
+
+    return head
+
+
+def generate_member(dir, name, sources, chain_head):
+    deps = git_dependency(*chain_head) if chain_head else ""
+    write(dir / "cppship.toml", package_manifest(name, deps))
+    write(dir / "include" / name / f"{name}.h", f"#pragma once\n\nint {name}_sum();\n")
+
+    calls = []
+    for i in range(sources):
+        func = f"{name}_f{i}"
+        write(dir / "lib" / f"m{i // FILES_PER_DIR}" / f"f{i}.cpp", f"int {func}() {{ return {i}; }}\n")
+        calls.append(func)
+
+    # only the first few sources are called, the sum is not the point
+    decls = "".join(f"int {func}();\n" for func in calls[:8])
+    body = " + ".join(f"{func}()" for func in calls[:8]) or "0"
+    write(dir / "lib" / "sum.cpp", f'#include "{name}/{name}.h"\n\n{decls}\nint {name}_sum() {{ return {body}; }}\n')
+    write(dir / "tests" / "sum_test.cpp", f'#include <gtest/gtest.h>\n\n#include "{name}/{name}.h"\n\n'
+          f"TEST({name}, sum) {{ EXPECT_GE({name}_sum(), 0); }}\n")
+
+
+def generate(root, members, sources, depth):
+    """a git repo of a workspace, its git deps live in root/git"""
+    root.mkdir(parents=True, exist_ok=True)
+    chain_head = generate_dependency_chain(root / "git", depth) if depth > 0 else None
+
+    workspace = root / "workspace"
+    names = [f"p{i}" for i in range(members)]
+    for name in names:
+        generate_member(workspace / "packages" / name, name, sources, chain_head)
+
+    member_list = ", ".join(f'"packages/{name}"' for name in names)
+    write(workspace / "cppship.toml", f"[workspace]\nmembers = [{member_list}]\n")
+    write(workspace / ".gitignore", "build/\n")
+
+    git(root, "init", "-q", "workspace")
+    git_commit_all(workspace, "init")
+    return workspace
+
+
+class Runner:
+    def __init__(self, cppship, workspace, cache_dir, timeout):
+        self.cppship = cppship
+        self.workspace = workspace
+        self.env = dict(os.environ, CPPSHIP_CACHE_DIR=str(cache_dir))
+        self.timeout = timeout
+
+    def run(self, step, *args):
+        start = time.perf_counter()
+        try:
+            proc = subprocess.run([self.cppship, *args], cwd=self.workspace, env=self.env, capture_output=True,
+                                  text=True, timeout=self.timeout)
+        except subprocess.TimeoutExpired:
+            return {"step": step, "status": "timeout", "seconds": time.perf_counter() - start}
+
+        result = {"step": step, "status": "ok" if proc.returncode == 0 else "failed",
+                  "seconds": time.perf_counter() - start}
+        if proc.returncode != 0:
+            result["output"] = (proc.stdout + proc.stderr)[-2000:]
+
+        return result
+
+
+def touch_source(workspace):
+    source = workspace / "packages" / "p0" / "lib" / "sum.cpp"
+    source.write_text(source.read_text() + "\n")
+
+
+def run_size(args, members, scratch):
+    root = scratch / f"m{members}-s{args.sources}-d{args.depth}"
+    shutil.rmtree(root, ignore_errors=True)
+
+    start = time.perf_counter()
+    workspace = generate(root, members, args.sources, args.depth)
+    generate_seconds = time.perf_counter() - start
+
+    runner = Runner(args.cppship, workspace, root / "cache", args.timeout)
+    steps = [runner.run("build -d (cold)", "build", "-d"), runner.run("build -d (warm)", "build", "-d")]
+
+    full_build = runner.run("build", "build", "--tests")
+    steps.append(full_build)
+    if full_build["status"] == "ok":
+        steps.append(runner.run("build (no-op)", "build", "--tests"))
+        touch_source(workspace)
+        steps.append(runner.run("test --changed-since", "test", "--changed-since", "HEAD"))
+    else:
+        for step in ("build (no-op)", "test --changed-since"):
+            steps.append({"step": step, "status": "skipped", "reason": "full build failed"})
+
+    if shutil.which("clang-tidy"):
+        touch_source(workspace)
+        (workspace / "build" / "compile_commands.json").unlink(missing_ok=True)
+        steps.append(runner.run("lint", "lint"))
+    else:
+        steps.append({"step": "lint", "status": "skipped", "reason": "clang-tidy not found"})
+
+    if not args.keep:
+        shutil.rmtree(root, ignore_errors=True)
+
+    return {
+        "members": members,
+        "sources_per_member": args.sources,
+        "files": members * (args.sources + 2),
+        "depth": args.depth,
+        "generate_seconds": generate_seconds,
+        "steps": steps,
+    }
+
+
+def cppship_version(cppship):
+    try:
+        return subprocess.run([cppship, "--version"], capture_output=True, text=True).stdout.strip().split("\n")[0]
+    except OSError:
+        return "unknown"
+
+
+def print_table(report, out=sys.stdout):
+    steps = []
+    for result in report["results"]:
+        for step in result["steps"]:
+            if step["step"] not in steps:
+                steps.append(step["step"])
+
+    out.write("| members | files | " + " | ".join(steps) + " |\n")
+    out.write("|---:|---:|" + "---:|" * len(steps) + "\n")
+    for result in report["results"]:
+        by_step = {step["step"]: step for step in result["steps"]}
+        cells = []
+        for name in steps:
+            step = by_step.get(name)
+            if step is None:
+                cells.append("")
+            elif step["status"] == "ok":
+                cells.append(f"{step['seconds']:.2f}s")
+            else:
+                cells.append(step["status"])
+        out.write(f"| {result['members']} | {result['files']} | " + " | ".join(cells) + " |\n")
+
+
+def cmd_run(args):
+    cppship = shutil.which(args.cppship) or args.cppship
+    if not Path(cppship).exists():
+        sys.exit(f"cppship not found: {args.cppship}")
+    args.cppship = cppship
+
+    scratch = Path(args.scratch) if args.scratch else Path(tempfile.mkdtemp(prefix="cppship-scale-"))
+    report = {
+        "version": REPORT_VERSION,
+        "cppship": cppship_version(cppship),
+        "date": datetime.datetime.now(datetime.timezone.utc).isoformat(timespec="seconds"),
+        "host": {"system": platform.system(), "machine": platform.machine(), "cpus": os.cpu_count()},
+        "results": [],
+    }
+
+    for members in args.members:
+        print(f"scale: {members} members x {args.sources} sources, git chain of {args.depth}", file=sys.stderr)
+        report["results"].append(run_size(args, members, scratch))
+        # written after each size so a long run still leaves a report
+        Path(args.report).write_text(json.dumps(report, indent=2) + "\n")
+
+    print_table(report)
+
+
+def cmd_generate(args):
+    workspace = generate(Path(args.dir), args.members[0], args.sources, args.depth)
+    print(workspace)
+
+
+def cmd_compare(args):
+    old = json.loads(Path(args.old).read_text())
+    new = json.loads(Path(args.new).read_text())
+    print(f"{old['cppship']} -> {new['cppship']}")
+
+    def seconds(report):
+        return {(r["members"], r["sources_per_member"], r["depth"], s["step"]): s["seconds"]
+                for r in report["results"] for s in r["steps"] if s["status"] == "ok"}
+
+    before, after = seconds(old), seconds(new)
+    print("| members | step | before | after | change |\n|---:|---|---:|---:|---:|")
+    for key in sorted(before.keys() & after.keys()):
+        change = (after[key] - before[key]) / before[key] * 100 if before[key] > 0 else 0.0
+        print(f"| {key[0]} | {key[3]} | {before[key]:.2f}s | {after[key]:.2f}s | {change:+.1f}% |")
+
+
+def sizes(value):
+    return [int(v) for v in value.split(",") if v]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    def add_shape(sub, default_members):
+        sub.add_argument("--members", type=sizes, default=default_members, help="member counts, eg. 10,100,1000")
+        sub.add_argument("--sources", type=int, default=100, help="lib sources of each member")
+        sub.add_argument("--depth", type=int, default=16, help="length of the git dependency chain")
+
+    run = commands.add_parser("run", help="generate workspaces of each size and time cppship over them")
+    add_shape(run, [10, 100, 1000])
+    run.add_argument("--cppship", default="cppship", help="cppship binary to measure")
+    run.add_argument("--report", default="scale_report.json")
+    run.add_argument("--scratch", help="where workspaces are generated, a temp dir by default")
+    run.add_argument("--timeout", type=float, default=3600, help="seconds allowed for each step")
+    run.add_argument("--keep", action="store_true", help="keep generated workspaces")
+    run.set_defaults(func=cmd_run)
+
+    gen = commands.add_parser("generate", help="generate one workspace under dir/workspace")
+    add_shape(gen, [1000])
+    gen.add_argument("dir")
+    gen.set_defaults(func=cmd_generate)
+
+    compare = commands.add_parser("compare", help="compare two reports")
+    compare.add_argument("old")
+    compare.add_argument("new")
+    compare.set_defaults(func=cmd_compare)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()